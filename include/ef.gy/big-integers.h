@@ -16,21 +16,672 @@
 #if !defined(EF_GY_BIG_INTEGERS_H)
 #define EF_GY_BIG_INTEGERS_H
 
+#include <ef.gy/exponential.h>
 #include <ef.gy/numeric.h>
 #include <ef.gy/traits.h>
 
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_addcll) && __has_builtin(__builtin_subcll)
+#define EF_GY_HAVE_BUILTIN_ADDC
+#endif
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <ostream>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace efgy {
 namespace math {
 namespace numeric {
-template <typename N>
+class eagerReduction;
+
+template <typename N, typename reduction = eagerReduction>
 class fractional;
 
 template <typename N>
 class factorial;
 
+/**\brief Number-theoretic transform
+ *
+ * Implements the discrete Fourier transform over the integers modulo a prime
+ * of the form k*2^n+1, which allows for exact convolutions of sequences of
+ * small integers. Big integer multiplication uses this with several primes
+ * and reconstructs the actual products with the Chinese remainder theorem.
+ *
+ * \tparam modulus   The prime to use as the modulus.
+ * \tparam generator A primitive root modulo the modulus.
+ */
+template <std::uint32_t modulus, std::uint32_t generator>
+class numberTheoreticTransform {
+ public:
+  /**\brief Modular multiplication
+   *
+   * \param[in] a First factor; should be less than the modulus.
+   * \param[in] b Second factor; should be less than the modulus.
+   *
+   * \returns a*b modulo the modulus.
+   */
+  static constexpr std::uint32_t multiply(std::uint32_t a, std::uint32_t b) {
+    return std::uint32_t((std::uint64_t(a) * b) % modulus);
+  }
+
+  /**\brief Modular multiplication with a precomputed quotient
+   *
+   * Shoup's variant of the modular multiplication, for factors that are
+   * used many times, like the roots of unity in the transform.
+   *
+   * \param[in] a  First factor; should be less than the modulus.
+   * \param[in] b  Second factor; should be less than the modulus.
+   * \param[in] bs floor(b*2^32/modulus).
+   *
+   * \returns a*b modulo the modulus.
+   */
+  static std::uint32_t multiplyShoup(std::uint32_t a, std::uint32_t b,
+                                     std::uint32_t bs) {
+    const std::uint32_t q = std::uint32_t((std::uint64_t(a) * bs) >> 32);
+    const std::uint32_t r = a * b - q * modulus;
+    return r >= modulus ? r - modulus : r;
+  }
+
+  /**\brief Modular exponentiation
+   *
+   * \param[in] b The base to raise.
+   * \param[in] e The exponent.
+   *
+   * \returns b^e modulo the modulus.
+   */
+  static constexpr std::uint32_t raise(std::uint32_t b, std::uint64_t e) {
+    return e == 0 ? 1
+                  : (e % 2 == 0) ? raise(multiply(b, b), e >> 1)
+                                 : multiply(b, raise(multiply(b, b), e >> 1));
+  }
+
+  /**\brief Modular inverse
+   *
+   * \param[in] a The number to invert; must not be zero.
+   *
+   * \returns The multiplicative inverse of a modulo the modulus.
+   */
+  static constexpr std::uint32_t inverse(std::uint32_t a) {
+    return raise(a, modulus - 2);
+  }
+
+  /**\brief Maximum transform length
+   *
+   * The largest power of two that divides modulus-1, which is the
+   * longest sequence that can be transformed.
+   */
+  static constexpr std::size_t maximumLength =
+      std::size_t((modulus - 1) & ~(modulus - 2));
+
+  /**\brief Transform in place
+   *
+   * Applies the iterative Cooley-Tukey transform to a, whose size must be
+   * a power of two no larger than maximumLength. The inverse transform
+   * includes the division by the sequence length.
+   *
+   * \param[in,out] a      The sequence to transform.
+   * \param[in]     invert Whether to apply the inverse transform.
+   */
+  static void transform(std::vector<std::uint32_t> &a, bool invert) {
+    const std::size_t n = a.size();
+
+    for (std::size_t i = 1, j = 0; i < n; i++) {
+      std::size_t bit = n >> 1;
+      for (; j & bit; bit >>= 1) {
+        j ^= bit;
+      }
+      j ^= bit;
+      if (i < j) {
+        std::swap(a[i], a[j]);
+      }
+    }
+
+    /* the roots of unity for the stage with half-length h are stored
+     * contiguously at w[h] to w[2h-1] */
+    std::vector<std::uint32_t> w(n), ws(n);
+
+    for (std::size_t half = 1; half < n; half <<= 1) {
+      const std::uint32_t root = raise(invert ? inverse(generator) : generator,
+                                       (modulus - 1) / (2 * half));
+      w[half] = 1;
+      for (std::size_t k = half; k < 2 * half; k++) {
+        if (k > half) {
+          w[k] = multiply(w[(k - 1)], root);
+        }
+        ws[k] = std::uint32_t((std::uint64_t(w[k]) << 32) / modulus);
+      }
+    }
+
+    for (std::size_t half = 1; half < n; half <<= 1) {
+      const std::uint32_t *wh = w.data() + half;
+      const std::uint32_t *wsh = ws.data() + half;
+
+      for (std::size_t i = 0; i < n; i += 2 * half) {
+        for (std::size_t k = 0; k < half; k++) {
+          const std::uint32_t u = a[(i + k)];
+          const std::uint32_t v =
+              multiplyShoup(a[(i + k + half)], wh[k], wsh[k]);
+          a[(i + k)] = (u + v < modulus) ? (u + v) : (u + v - modulus);
+          a[(i + k + half)] = (u >= v) ? (u - v) : (u + modulus - v);
+        }
+      }
+    }
+
+    if (invert) {
+      const std::uint32_t f = inverse(std::uint32_t(n % modulus));
+      for (auto &x : a) {
+        x = multiply(x, f);
+      }
+    }
+  }
+
+  /**\brief Cyclic convolution
+   *
+   * Computes the cyclic convolution of a and b modulo the modulus. Both
+   * sequences must already be padded to the same power-of-two length.
+   *
+   * \param[in] a First sequence.
+   * \param[in] b Second sequence.
+   *
+   * \returns The convolution of a and b, reduced modulo the modulus.
+   */
+  static std::vector<std::uint32_t> convolve(std::vector<std::uint32_t> a,
+                                             std::vector<std::uint32_t> b) {
+    transform(a, false);
+    transform(b, false);
+
+    for (std::size_t i = 0; i < a.size(); i++) {
+      a[i] = multiply(a[i], b[i]);
+    }
+
+    transform(a, true);
+
+    return a;
+  }
+};
+
+/**\brief Cell arithmetic
+ *
+ * Implements the innermost loops of the bigIntegers template, which operate on
+ * arrays of cells with the least significant cell first. This generic version
+ * only relies on Tu being twice as wide as cellType; the specialisations below
+ * replace it for specific cell types where the compiler offers something
+ * better.
+ *
+ * \tparam cellType     Integer type used for the individual memory cells.
+ * \tparam Tu           Unsigned integer type with twice the bits of cellType.
+ * \tparam cellBitCount The number of bits in a single cellType variable.
+ */
+template <typename cellType, typename Tu, unsigned int cellBitCount>
+class cellArithmetic {
+ public:
+  /**\brief Add cells in place
+   *
+   * Adds the bn cells in b to the an cells in a, propagating the carry
+   * through a. bn must not be larger than an.
+   *
+   * \param[in,out] a  The cells to add to.
+   * \param[in]     an Number of cells in a.
+   * \param[in]     b  The cells to add.
+   * \param[in]     bn Number of cells in b.
+   *
+   * \returns The carry out of the most significant cell of a.
+   */
+  static cellType add(cellType *a, std::size_t an, const cellType *b,
+                      std::size_t bn) {
+    Tu carry = 0;
+    std::size_t i = 0;
+
+    for (; i < bn; i++) {
+      carry += Tu(a[i]) + Tu(b[i]);
+      a[i] = cellType(carry);
+      carry >>= cellBitCount;
+    }
+
+    for (; (carry != 0) && (i < an); i++) {
+      carry += Tu(a[i]);
+      a[i] = cellType(carry);
+      carry >>= cellBitCount;
+    }
+
+    return cellType(carry);
+  }
+
+  /**\brief Subtract cells in place
+   *
+   * Subtracts the bn cells in b from the an cells in a, propagating the
+   * borrow through a. bn must not be larger than an.
+   *
+   * \param[in,out] a  The cells to subtract from.
+   * \param[in]     an Number of cells in a.
+   * \param[in]     b  The cells to subtract.
+   * \param[in]     bn Number of cells in b.
+   *
+   * \returns The borrow out of the most significant cell of a.
+   */
+  static cellType subtract(cellType *a, std::size_t an, const cellType *b,
+                           std::size_t bn) {
+    Tu borrow = 0;
+    std::size_t i = 0;
+
+    for (; i < bn; i++) {
+      const Tu t = Tu(a[i]) - Tu(b[i]) - borrow;
+      a[i] = cellType(t);
+      borrow = (t >> cellBitCount) & 1;
+    }
+
+    for (; (borrow != 0) && (i < an); i++) {
+      const Tu t = Tu(a[i]) - borrow;
+      a[i] = cellType(t);
+      borrow = (t >> cellBitCount) & 1;
+    }
+
+    return cellType(borrow);
+  }
+
+  /**\brief Multiply by a single cell and accumulate
+   *
+   * Adds the product of the n cells in a and m to the n cells in r.
+   *
+   * \param[in,out] r The cells to add the product to.
+   * \param[in]     a The cells to multiply.
+   * \param[in]     n Number of cells in r and a.
+   * \param[in]     m The factor.
+   *
+   * \returns The carry out of the most significant cell of r.
+   */
+  static cellType multiplyAdd(cellType *r, const cellType *a, std::size_t n,
+                              const cellType &m) {
+    Tu carry = 0;
+
+    for (std::size_t i = 0; i < n; i++) {
+      carry += Tu(a[i]) * Tu(m) + Tu(r[i]);
+      r[i] = cellType(carry);
+      carry >>= cellBitCount;
+    }
+
+    return cellType(carry);
+  }
+
+  /**\brief Divide cells by a single cell in place
+   *
+   * Divides the n cells in a by d, replacing a with the quotient.
+   *
+   * \param[in,out] a The cells to divide.
+   * \param[in]     n Number of cells in a.
+   * \param[in]     d The divisor; must not be zero.
+   *
+   * \returns The remainder of the division.
+   */
+  static cellType divide(cellType *a, std::size_t n, const cellType &d) {
+    Tu r = 0;
+
+    for (std::size_t i = n; i > 0; i--) {
+      r = (r << cellBitCount) | Tu(a[(i - 1)]);
+      a[(i - 1)] = cellType(r / d);
+      r %= d;
+    }
+
+    return cellType(r);
+  }
+};
+
+#if defined(__SIZEOF_INT128__)
+/**\brief Cell arithmetic with 64-bit cells
+ *
+ * Uses the x86-64 carry flag intrinsics for the carry chains, mulx if the
+ * compiler targets BMI2 and a plain divq for single-cell divisors. Other
+ * targets use the generic clang carry builtins if available, or fall back to
+ * unsigned __int128 arithmetic.
+ */
+template <>
+class cellArithmetic<unsigned long long, unsigned __int128, 64> {
+ public:
+  typedef unsigned long long cellType;
+
+  /**\copydoc cellArithmetic::add */
+  static cellType add(cellType *a, std::size_t an, const cellType *b,
+                      std::size_t bn) {
+    unsigned char carry = 0;
+    std::size_t i = 0;
+
+    for (; i < bn; i++) {
+      carry = addCarry(carry, a[i], b[i], a[i]);
+    }
+
+    for (; (carry != 0) && (i < an); i++) {
+      carry = addCarry(carry, a[i], 0, a[i]);
+    }
+
+    return carry;
+  }
+
+  /**\copydoc cellArithmetic::subtract */
+  static cellType subtract(cellType *a, std::size_t an, const cellType *b,
+                           std::size_t bn) {
+    unsigned char borrow = 0;
+    std::size_t i = 0;
+
+    for (; i < bn; i++) {
+      borrow = subtractBorrow(borrow, a[i], b[i], a[i]);
+    }
+
+    for (; (borrow != 0) && (i < an); i++) {
+      borrow = subtractBorrow(borrow, a[i], 0, a[i]);
+    }
+
+    return borrow;
+  }
+
+  /**\copydoc cellArithmetic::multiplyAdd */
+  static cellType multiplyAdd(cellType *r, const cellType *a, std::size_t n,
+                              const cellType &m) {
+    cellType carry = 0;
+
+    for (std::size_t i = 0; i < n; i++) {
+      cellType high;
+      cellType low = multiply(a[i], m, high);
+
+      high += addCarry(0, low, carry, low);
+      high += addCarry(0, r[i], low, r[i]);
+      carry = high;
+    }
+
+    return carry;
+  }
+
+  /**\copydoc cellArithmetic::divide */
+  static cellType divide(cellType *a, std::size_t n, const cellType &d) {
+    cellType r = 0;
+
+    for (std::size_t i = n; i > 0; i--) {
+#if defined(__x86_64__) && defined(__GNUC__)
+      cellType q = a[(i - 1)];
+      __asm__("divq %2" : "+a"(q), "+d"(r) : "rm"(d));
+      a[(i - 1)] = q;
+#else
+      const unsigned __int128 t =
+          ((unsigned __int128)(r) << 64) | a[(i - 1)];
+      a[(i - 1)] = cellType(t / d);
+      r = cellType(t % d);
+#endif
+    }
+
+    return r;
+  }
+
+ protected:
+  /**\brief Add with carry
+   *
+   * \param[in]  carry Incoming carry; zero or one.
+   * \param[in]  a     First summand.
+   * \param[in]  b     Second summand.
+   * \param[out] r     The low 64 bits of a+b+carry.
+   *
+   * \returns The outgoing carry.
+   */
+  static unsigned char addCarry(unsigned char carry, cellType a, cellType b,
+                                cellType &r) {
+#if defined(__x86_64__)
+    return _addcarry_u64(carry, a, b, &r);
+#elif defined(EF_GY_HAVE_BUILTIN_ADDC)
+    cellType c;
+    r = __builtin_addcll(a, b, carry, &c);
+    return (unsigned char)(c);
+#else
+    const unsigned __int128 t = (unsigned __int128)(a) + b + carry;
+    r = cellType(t);
+    return (unsigned char)(t >> 64);
+#endif
+  }
+
+  /**\brief Subtract with borrow
+   *
+   * \param[in]  borrow Incoming borrow; zero or one.
+   * \param[in]  a      Minuend.
+   * \param[in]  b      Subtrahend.
+   * \param[out] r      The low 64 bits of a-b-borrow.
+   *
+   * \returns The outgoing borrow.
+   */
+  static unsigned char subtractBorrow(unsigned char borrow, cellType a,
+                                      cellType b, cellType &r) {
+#if defined(__x86_64__)
+    return _subborrow_u64(borrow, a, b, &r);
+#elif defined(EF_GY_HAVE_BUILTIN_ADDC)
+    cellType c;
+    r = __builtin_subcll(a, b, borrow, &c);
+    return (unsigned char)(c);
+#else
+    const unsigned __int128 t = (unsigned __int128)(a)-b - borrow;
+    r = cellType(t);
+    return (unsigned char)(t >> 127);
+#endif
+  }
+
+  /**\brief Full multiplication
+   *
+   * \param[in]  a    First factor.
+   * \param[in]  b    Second factor.
+   * \param[out] high The high 64 bits of a*b.
+   *
+   * \returns The low 64 bits of a*b.
+   */
+  static cellType multiply(cellType a, cellType b, cellType &high) {
+#if defined(__BMI2__)
+    return _mulx_u64(a, b, &high);
+#else
+    const unsigned __int128 t = (unsigned __int128)(a)*b;
+    high = cellType(t >> 64);
+    return cellType(t);
+#endif
+  }
+};
+#endif
+
+/**\brief Cell storage with a small inline buffer
+ *
+ * A minimal, vector-like container for the cells of a big integer. The
+ * first N cells are kept inline in the object itself, so the many small
+ * numbers that show up in practice - loop counters, numerators and
+ * denominators of reduced fractions, factorial terms - can be created,
+ * copied, moved and assigned without touching the heap. Longer numbers
+ * spill over into a heap buffer that grows geometrically.
+ *
+ * Iterators are plain pointers; they are invalidated by anything that
+ * changes the size of the container, as with std::vector.
+ *
+ * \tparam T Type of the individual cells; must be trivially copyable.
+ * \tparam N Number of cells to store inline.
+ */
+template <typename T, std::size_t N>
+class cellStorage {
+ public:
+  typedef T value_type;
+  typedef T *iterator;
+  typedef const T *const_iterator;
+  typedef std::size_t size_type;
+
+  cellStorage() : pointer(local), count(0), capacity(N) {}
+  explicit cellStorage(std::size_t n, const T &v = T()) : cellStorage() {
+    assign(n, v);
+  }
+  cellStorage(const T *first, const T *last) : cellStorage() {
+    assign(first, last);
+  }
+  cellStorage(const cellStorage &s) : cellStorage() {
+    assign(s.begin(), s.end());
+  }
+  cellStorage(cellStorage &&s) noexcept : cellStorage() { take(s); }
+  ~cellStorage() { release(); }
+
+  /**\brief Copy assignment
+   *
+   * Reuses the current buffer whenever it is large enough, so assigning
+   * between small numbers or into an already grown number never
+   * allocates.
+   */
+  cellStorage &operator=(const cellStorage &s) {
+    if (this != &s) {
+      assign(s.begin(), s.end());
+    }
+    return *this;
+  }
+
+  cellStorage &operator=(cellStorage &&s) noexcept {
+    if (this != &s) {
+      release();
+      take(s);
+    }
+    return *this;
+  }
+
+  std::size_t size(void) const { return count; }
+  bool empty(void) const { return count == 0; }
+  T *data(void) { return pointer; }
+  const T *data(void) const { return pointer; }
+  T *begin(void) { return pointer; }
+  const T *begin(void) const { return pointer; }
+  T *end(void) { return pointer + count; }
+  const T *end(void) const { return pointer + count; }
+  T &operator[](std::size_t i) { return pointer[i]; }
+  const T &operator[](std::size_t i) const { return pointer[i]; }
+  T &back(void) { return pointer[count - 1]; }
+  const T &back(void) const { return pointer[count - 1]; }
+
+  /**\brief Is the inline buffer in use?
+   *
+   * \returns 'true' if the cells currently live inside the object
+   *          itself rather than on the heap.
+   */
+  bool isInline(void) const { return pointer == local; }
+
+  void reserve(std::size_t n) {
+    if (n <= capacity) {
+      return;
+    }
+
+    const std::size_t c = std::max(n, 2 * capacity);
+    const std::size_t s = count;
+    T *p = new T[c];
+    std::copy(pointer, pointer + s, p);
+    release();
+    pointer = p;
+    count = s;
+    capacity = c;
+  }
+
+  void resize(std::size_t n) {
+    reserve(n);
+    if (n > count) {
+      std::fill(pointer + count, pointer + n, T(0));
+    }
+    count = n;
+  }
+
+  void clear(void) { count = 0; }
+
+  void push_back(const T &v) {
+    if (count == capacity) {
+      const T t = v;
+      reserve(count + 1);
+      pointer[count++] = t;
+    } else {
+      pointer[count++] = v;
+    }
+  }
+
+  void assign(std::size_t n, const T &v) {
+    const T t = v;
+    count = 0;
+    reserve(n);
+    std::fill(pointer, pointer + n, t);
+    count = n;
+  }
+
+  /**\brief Replace contents with a range
+   *
+   * The range may lie within this container's own buffer.
+   */
+  void assign(const T *first, const T *last) {
+    const std::size_t n = last - first;
+
+    if (n > capacity) {
+      T *p = new T[n];
+      std::copy(first, last, p);
+      release();
+      pointer = p;
+      capacity = n;
+    } else {
+      std::copy(first, last, pointer);
+    }
+    count = n;
+  }
+
+  T *insert(T *position, std::size_t n, const T &v) {
+    const std::size_t o = position - pointer;
+    const T t = v;
+    reserve(count + n);
+    std::copy_backward(pointer + o, pointer + count, pointer + count + n);
+    std::fill(pointer + o, pointer + o + n, t);
+    count += n;
+    return pointer + o;
+  }
+
+  void swap(cellStorage &s) {
+    if (this == &s) {
+      return;
+    }
+    cellStorage t(std::move(s));
+    s = std::move(*this);
+    *this = std::move(t);
+  }
+
+ protected:
+  T *pointer;
+  std::size_t count;
+  std::size_t capacity;
+  T local[N > 0 ? N : 1];
+
+  void release(void) {
+    if (pointer != local) {
+      delete[] pointer;
+    }
+    pointer = local;
+    count = 0;
+    capacity = N;
+  }
+
+  /**\brief Take over another container's contents
+   *
+   * Steals the heap buffer if there is one and copies the inline cells
+   * otherwise; the source is left empty. Expects this container to be
+   * empty and inline.
+   */
+  void take(cellStorage &s) {
+    if (s.pointer == s.local) {
+      std::copy(s.local, s.local + s.count, local);
+      count = s.count;
+    } else {
+      pointer = s.pointer;
+      count = s.count;
+      capacity = s.capacity;
+      s.pointer = s.local;
+      s.capacity = N;
+    }
+    s.count = 0;
+  }
+};
+
 /**\brief Big integers
  *
  * This template implements big integers, which allow arbitrarily
@@ -43,11 +694,17 @@ class factorial;
  *                      cells.
  * \tparam cellBitCount The number of bits in a single cellType
  *                      variable.
+ * \tparam inlineCells  Number of cells stored inline in the object,
+ *                      before spilling over to the heap.
  */
 template <typename Ts = signed long long, typename Tu = unsigned long long,
-          typename cellType = unsigned int, unsigned int cellBitCount = 32>
+          typename cellType = unsigned int, unsigned int cellBitCount = 32,
+          std::size_t inlineCells = 4>
 class bigIntegers : public numeric {
  public:
+  /**\brief Container type for the memory cells */
+  typedef cellStorage<cellType, inlineCells> storage;
+
   bigIntegers() : cell(0), negative(false) {}
   bigIntegers(Ts pInteger) : negative(pInteger < Ts(0)), cell(0) {
     if (pInteger == Ts(0)) {
@@ -112,78 +769,100 @@ class bigIntegers : public numeric {
     return *this;
   }
 
-  bigIntegers operator+(const bigIntegers &b) const {
-    if (*this == zero()) {
-      return b;
-    } else if (b == zero()) {
-      return *this;
+  bigIntegers(bigIntegers &&pB) noexcept
+      : negative(pB.negative), cell(std::move(pB.cell)) {
+    if (cell.size() == 0) {
+      negative = false;
     }
+    pB.negative = false;
+  }
 
-    bigIntegers r;
-
-    if (negative == b.negative) {
-      r.negative = negative;
-
-      r.doAdd(*this, b);
-    } else {
-      const bigIntegers &p = negative ? -*this : *this;
-      const bigIntegers &q = b.negative ? -b : b;
-
-      if (p > q) {
-        r.doSubtract(p, q);
-        r.negative = negative && (r.cell.size() > 0);
-      } else {
-        r.doSubtract(q, p);
-        r.negative = !negative && (r.cell.size() > 0);
-      }
+  bigIntegers &operator=(bigIntegers &&b) noexcept {
+    if (this != &b) {
+      negative = b.negative;
+      cell = std::move(b.cell);
+      b.negative = false;
     }
 
+    return *this;
+  }
+
+  bigIntegers operator+(const bigIntegers &b) const & {
+    bigIntegers r = *this;
+    r += b;
     return r;
   }
 
+  bigIntegers operator+(const bigIntegers &b) && {
+    *this += b;
+    return std::move(*this);
+  }
+
   bigIntegers &operator+=(const bigIntegers &b) {
-    return ((*this) = (*this + b));
+    addSigned(b.cell.data(), b.cell.size(), b.negative);
+    return *this;
   }
 
-  bigIntegers &operator++(void) { return ((*this) = (*this + one())); }
+  bigIntegers &operator++(void) {
+    const cellType unit = 1;
+    addSigned(&unit, 1, false);
+    return *this;
+  }
 
   bigIntegers operator++(int) {
     bigIntegers r = (*this);
 
-    (*this) += one();
+    ++(*this);
+
+    return r;
+  }
 
+  bigIntegers operator-(const bigIntegers &b) const & {
+    bigIntegers r = *this;
+    r -= b;
     return r;
   }
 
-  bigIntegers operator-(const bigIntegers &b) const { return *this + -b; }
+  bigIntegers operator-(const bigIntegers &b) && {
+    *this -= b;
+    return std::move(*this);
+  }
 
   bigIntegers &operator-=(const bigIntegers &b) {
-    return ((*this) = (*this - b));
+    addSigned(b.cell.data(), b.cell.size(), !b.negative);
+    return *this;
   }
 
-  bigIntegers &operator--(void) { return ((*this) = (*this - one())); }
+  bigIntegers &operator--(void) {
+    const cellType unit = 1;
+    addSigned(&unit, 1, true);
+    return *this;
+  }
 
   bigIntegers operator--(int) {
     bigIntegers r = (*this);
 
-    (*this) -= one();
+    --(*this);
 
     return r;
   }
 
-  bigIntegers operator-(void) const {
+  bigIntegers operator-(void) const & {
     bigIntegers r = *this;
 
-    r.negative = !r.negative;
+    r.negative = !r.negative && (r.cell.size() > 0);
 
     return r;
   }
 
-  bigIntegers operator*(const bigIntegers &b) const {
-    if (*this == zero()) {
-      return zero();
-    } else if (b == zero()) {
-      return zero();
+  bigIntegers operator-(void) && {
+    negative = !negative && (cell.size() > 0);
+    return std::move(*this);
+  }
+
+  bigIntegers operator*(const bigIntegers &b) const & {
+    if ((*this == zero()) || (b == zero())) {
+      return bigIntegers();
     } else if (*this == one()) {
       return b;
     } else if (b == one()) {
@@ -192,30 +871,60 @@ class bigIntegers : public numeric {
       return -b;
     } else if (b == negativeOne()) {
       return -*this;
+    } else if (b.cell.size() == 1) {
+      bigIntegers r = *this;
+      r *= b;
+      return r;
     }
 
     bigIntegers r;
-    bigIntegers a = *this;
-    bigIntegers c = b;
-
-    a.negative = false;
-    c.negative = false;
 
-    r.doMultiply(a, c);
+    r.doMultiply(*this, b);
     r.negative = (r.cell.size() > 0) && (negative != b.negative);
 
     return r;
   }
 
+  bigIntegers operator*(const bigIntegers &b) && {
+    *this *= b;
+    return std::move(*this);
+  }
   fractional<bigIntegers> operator*(const fractional<bigIntegers> &b) const {
     return b * (*this);
   }
 
+  /**\brief Multiply in place
+   *
+   * Multiplications by a single cell - as in factorials or when scaling
+   * by small constants - are done in the existing cells, which only ever
+   * need to grow by one cell. Larger products need a separate buffer,
+   * which then replaces this number's cells.
+   */
   bigIntegers &operator*=(const bigIntegers &b) {
-    return ((*this) = (*this * b));
+    const bool rnegative = (negative != b.negative);
+
+    if ((*this == zero()) || (b == zero())) {
+      cell.clear();
+      negative = false;
+      return *this;
+    } else if (b.cell.size() == 1) {
+      const cellType m = b.cell[0];
+      const cellType carry =
+          multiplyAddCells(cell.data(), cell.size(), m, cellType(0));
+
+      if (carry != 0) {
+        cell.push_back(carry);
+      }
+    } else {
+      doMultiply(*this, b);
+    }
+
+    negative = rnegative && (cell.size() > 0);
+
+    return *this;
   }
 
-  bigIntegers operator%(const bigIntegers &b) const {
+  bigIntegers operator%(const bigIntegers &b) const & {
     if (*this == zero()) {
       return zero();
     } else if (b == zero()) {
@@ -229,28 +938,185 @@ class bigIntegers : public numeric {
     }
 
     bigIntegers r;
-    const bigIntegers &ap = negative ? -*this : *this;
-    const bigIntegers &bp = b.negative ? -b : b;
 
     if (b.cell.size() == 1) {
-      r.doModuloHorner(ap, b.cell[0]);
-    } /*
-                              else if (b.cell.size() < (cellsPerLong - 1))
-                              {
-                                  r.doModuloHorner(ap, bp);
-                              }
-      */
-    else {
-      r.doModulo(ap, bp);
+      r.doModuloHorner(*this, b.cell[0]);
+    } else {
+      r.doModulo(*this, b);
+    }
+
+    r.negative = negative && (r.cell.size() > 0);
+
+    return r;
+  }
+
+  /**\brief Divide with remainder
+   *
+   * Calculates the quotient and the remainder of a division by b in one
+   * go, rounding the quotient towards zero like the built-in integer
+   * types do. The remainder thus has the same sign as this number.
+   * Division by zero results in zero for both.
+   *
+   * \param[in] b The divisor.
+   *
+   * \returns A pair with the quotient and the remainder.
+   */
+  std::pair<bigIntegers, bigIntegers> divmod(const bigIntegers &b) const {
+    std::pair<bigIntegers, bigIntegers> r;
+
+    if (b.cell.size() == 0) {
+      return r;
+    }
+
+    divideMagnitude(*this, b, r.first, r.second);
+
+    r.first.negative = (negative != b.negative) && (r.first.cell.size() > 0);
+    r.second.negative = negative && (r.second.cell.size() > 0);
+
+    return r;
+  }
+
+  /**\brief Greatest common divisor
+   *
+   * Calculates the greatest common divisor of the absolute values of a
+   * and b. Very large numbers are first reduced with a recursive
+   * half-GCD, which uses the fast multiplication algorithms to apply
+   * many quotients at once. Lehmer's algorithm then takes over, applying
+   * the quotients found in the leading two cells of both numbers with
+   * one linear combination of single-cell multiples each. Once the
+   * numbers fit into Tu, the binary GCD finishes the job.
+   *
+   * \param[in] a The first number.
+   * \param[in] b The second number.
+   *
+   * \returns The greatest common divisor of a and b, which is zero if
+   *          both are zero.
+   */
+  static bigIntegers gcd(const bigIntegers &a, const bigIntegers &b) {
+    bigIntegers x = a;
+    bigIntegers y = b;
+
+    x.negative = false;
+    y.negative = false;
+
+    if (compareMagnitude(x, y) < 0) {
+      std::swap(x, y);
+    }
+
+    while (y.cell.size() >= 6 * halfGCDThreshold) {
+      if (x.cell.size() - y.cell.size() > y.cell.size() / 4) {
+        x %= y;
+        std::swap(x, y);
+      } else {
+        halfGCD(x, y, 0);
+      }
+    }
+
+    return gcdLehmer(x, y);
+  }
+
+  /**\brief Modular power
+   *
+   * Calculates base^exponent mod modulus with sliding window
+   * exponentiation. Odd moduli use Montgomery multiplication, which
+   * replaces the division after every multiplication with a reduction
+   * that only multiplies by single cells; even moduli use the remainder
+   * operator instead.
+   *
+   * \param[in] base     The number to raise.
+   * \param[in] exponent What to raise the number to; negative exponents
+   *                     are treated as zero.
+   * \param[in] modulus  The modulus; must be positive.
+   *
+   * \returns base^exponent mod modulus, which is in [0, modulus), or zero
+   *          if the modulus is not positive.
+   */
+  static bigIntegers powmod(const bigIntegers &base,
+                            const bigIntegers &exponent,
+                            const bigIntegers &modulus) {
+    if ((modulus.cell.size() == 0) || modulus.negative ||
+        (modulus == one())) {
+      return bigIntegers();
+    }
+
+    const std::size_t n = exponent.negative ? 0 : exponent.bitLength();
+    bigIntegers b = base % modulus;
+
+    if (b.negative) {
+      b += modulus;
+    }
+
+    if (n == 0) {
+      return bigIntegers(1);
+    }
+
+    const auto bit = [&exponent](std::size_t i) -> bool {
+      return ((exponent.cell[i / cellBitCount] >> (i % cellBitCount)) & 1) !=
+             0;
+    };
+
+    if (modulus.cell[0] % 2 == 0) {
+      return exponentiate::slidingWindow(
+          b, n, bit, [&modulus](const bigIntegers &x, const bigIntegers &y) {
+            return x * y % modulus;
+          });
+    }
+
+    const montgomery m(modulus);
+
+    return m.reduce(exponentiate::slidingWindow(
+        m.convert(b), n, bit,
+        [&m](const bigIntegers &x, const bigIntegers &y) {
+          return m.reduce(x * y);
+        }));
+  }
+
+  /**\brief Number of significant bits
+   *
+   * \returns The position of the most significant set bit plus one, or
+   *          zero for zero.
+   */
+  std::size_t bitLength(void) const {
+    if (cell.size() == 0) {
+      return 0;
     }
 
-    r.negative = negative;
+    std::size_t r = (cell.size() - 1) * cellBitCount;
+
+    for (cellType v = cell.back(); v != 0; v >>= 1) {
+      r++;
+    }
 
     return r;
   }
 
+  bigIntegers operator%(const bigIntegers &b) && {
+    *this %= b;
+    return std::move(*this);
+  }
+
   bigIntegers &operator%=(const bigIntegers &b) {
-    return ((*this) = (*this % b));
+    if (*this == zero()) {
+      return *this;
+    } else if ((b == zero()) || (b == one())) {
+      cell.clear();
+      negative = false;
+      return *this;
+    }
+
+    if ((cell.size() <= cellsPerLong) && (b.cell.size() <= cellsPerLong)) {
+      return (*this = bigIntegers(toInteger() % b.toInteger(), negative));
+    }
+
+    if (b.cell.size() == 1) {
+      doModuloHorner(*this, b.cell[0]);
+    } else {
+      doModulo(*this, b);
+    }
+
+    negative = negative && (cell.size() > 0);
+
+    return *this;
   }
 
   fractional<bigIntegers> operator/(const bigIntegers &b) const {
@@ -279,9 +1145,7 @@ class bigIntegers : public numeric {
     }
 
     bool rnegative = (negative != b.negative);
-    const bigIntegers &aa = negative ? -*this : *this;
-    const bigIntegers &ba = b.negative ? -b : b;
-    doDivide(aa, ba);
+    doDivide(*this, b);
     negative = rnegative && (cell.size() > 0);
     return *this;
   }
@@ -435,7 +1299,7 @@ class bigIntegers : public numeric {
     cellType nukeCells = 0;
     cellType q = b;
 
-    while (q > cellBitCount) {
+    while (q >= cellBitCount) {
       nukeCells++;
       q -= cellBitCount;
     }
@@ -479,14 +1343,14 @@ class bigIntegers : public numeric {
     cellType pushCells = 0;
     cellType q = b;
 
-    while (q > cellBitCount) {
+    while (q >= cellBitCount) {
       pushCells++;
       q -= cellBitCount;
     }
 
     if ((pushCells == 0) && (q > 0)) {
       const cellType negQ = (cellBitCount - q);
-      const cellType mask = ((1 << q) - 1) << negQ;
+      const cellType mask = ((cellType(1) << q) - 1) << negQ;
 
       if ((cell[(cell.size() - 1)] & mask) == 0) {
         /* no additional cells needed */
@@ -548,7 +1412,7 @@ class bigIntegers : public numeric {
     if (b < cellBitCount) {
       const cellType &q = b;
       const cellType negQ = (cellBitCount - q);
-      const cellType mask = ((1 << q) - 1) << negQ;
+      const cellType mask = ((cellType(1) << q) - 1) << negQ;
 
       if ((cell[(cell.size() - 1)] & mask) == 0) {
         /* no additional cells needed */
@@ -560,425 +1424,1706 @@ class bigIntegers : public numeric {
           cell[i] = newContent;
         }
 
-        return *this;
-      }
+        return *this;
+      }
+    }
+
+    return (*this = (*this << b));
+  }
+
+  /**\brief Convert to string
+   *
+   * Writes the number in the given base, using the digits 0-9 and a-z and
+   * a leading '-' for negative numbers. Power-of-two bases are converted
+   * by extracting the bits of each digit directly. Other bases use chunks
+   * of as many digits as fit into a single cell, e.g. 10^9 for base 10,
+   * and numbers with at least radixThreshold cells are split recursively
+   * by powers of that chunk, which makes the conversion about as fast as
+   * the division.
+   *
+   * \param[in] base The base to use; must be between 2 and 36.
+   *
+   * \returns The digits of the number, or an empty string if the base is
+   *          not supported.
+   */
+  std::string toChars(unsigned int base = 10) const {
+    if ((base < 2) || (base > 36)) {
+      return "";
+    }
+
+    if (cell.size() == 0) {
+      return "0";
+    }
+
+    std::string s = negative ? "-" : "";
+
+    if ((base & (base - 1)) == 0) {
+      writeBits(s, base);
+    } else {
+      std::vector<bigIntegers> powers(1, bigIntegers(Tu(chunkOf(base)), false));
+
+      while (powers.back().cell.size() * 2 <= cell.size() + 1) {
+        powers.push_back(powers.back() * powers.back());
+      }
+
+      std::vector<bigIntegers> reciprocals(powers.size());
+      writeDigits(s, *this, base, powers, reciprocals, 0);
+    }
+
+    return s;
+  }
+
+  /**\brief Parse string
+   *
+   * Parses a number in the given base, in the format written by toChars();
+   * like std::from_chars(), parsing stops at the first character that is
+   * not a valid digit. Upper and lower case letters are accepted. Long
+   * strings of digits are combined recursively in the same way toChars()
+   * splits them.
+   *
+   * \param[in]  first Start of the string to parse.
+   * \param[in]  last  End of the string to parse.
+   * \param[out] value Where to store the result; only modified if a
+   *                   number was parsed.
+   * \param[in]  base  The base to use; must be between 2 and 36.
+   *
+   * \returns A pointer to the first character that was not parsed, which
+   *          is first if there were no digits or the base is not supported.
+   */
+  static const char *fromChars(const char *first, const char *last,
+                               bigIntegers &value, unsigned int base = 10) {
+    if ((base < 2) || (base > 36)) {
+      return first;
+    }
+
+    const bool isNegative = (first != last) && (*first == '-');
+    const char *begin = isNegative ? first + 1 : first;
+    const char *end = begin;
+
+    while ((end != last) && (digitValue(*end) < base)) {
+      end++;
+    }
+
+    if (end == begin) {
+      return first;
+    }
+
+    if ((base & (base - 1)) == 0) {
+      value = readBits(begin, end, base);
+    } else {
+      const unsigned int d = digitsPerChunk(base);
+      std::vector<cellType> chunks;
+
+      for (const char *p = end; p > begin;) {
+        const char *q = (p - begin) > std::ptrdiff_t(d) ? p - d : begin;
+        cellType c = 0;
+
+        for (const char *i = q; i < p; i++) {
+          c = c * base + digitValue(*i);
+        }
+
+        chunks.push_back(c);
+        p = q;
+      }
+
+      std::vector<bigIntegers> powers(1, bigIntegers(Tu(chunkOf(base)), false));
+
+      while ((std::size_t(1) << powers.size()) < chunks.size()) {
+        powers.push_back(powers.back() * powers.back());
+      }
+
+      value = readChunks(chunks.data(), chunks.size(), base, powers);
+    }
+
+    value.negative = isNegative && (value.cell.size() > 0);
+
+    return end;
+  }
+
+  /**\brief Karatsuba multiplication threshold
+   *
+   * Operands with fewer cells than this are multiplied with the
+   * schoolbook algorithm, larger ones with Karatsuba's algorithm.
+   */
+  static constexpr std::size_t karatsubaThreshold = 32;
+
+  /**\brief Toom-3 multiplication threshold
+   *
+   * Balanced operands with at least this many cells are multiplied
+   * with the Toom-3 algorithm instead of Karatsuba's.
+   */
+  static constexpr std::size_t toomCookThreshold = 2048;
+
+  /**\brief Number-theoretic transform multiplication threshold
+   *
+   * Operands with at least this many cells are multiplied with an exact
+   * number-theoretic transform, provided that the product fits into
+   * numberTheoreticLength 16-bit digits.
+   */
+  static constexpr std::size_t numberTheoreticThreshold = 32768;
+
+  /**\brief Maximum number-theoretic transform length
+   *
+   * The longest transform supported by all three primes used for the
+   * number-theoretic transform multiplication, in 16-bit digits.
+   */
+  static constexpr std::size_t numberTheoreticLength = std::size_t(1) << 23;
+
+  /**\brief Newton division threshold
+   *
+   * Divisors with at least this many cells are divided with a Newton
+   * reciprocal instead of Knuth's Algorithm D, provided the quotient
+   * has at least this many cells as well.
+   */
+  static constexpr std::size_t newtonThreshold = 1536;
+
+  /**\brief Radix conversion threshold
+   *
+   * Numbers with at least this many cells are converted to and from
+   * strings in bases that are not a power of two by recursively
+   * splitting them, instead of one chunk of digits at a time.
+   */
+  static constexpr std::size_t radixThreshold = 64;
+
+  /**\brief Half-GCD threshold
+   *
+   * The recursive half-GCD algorithm splits numbers with at least this
+   * many cells in half, and uses Lehmer's algorithm for smaller ones.
+   * Since it needs to keep track of the cofactors, gcd() only uses it
+   * for numbers with at least six times as many cells.
+   */
+  static constexpr std::size_t halfGCDThreshold = 1024;
+
+  /**\brief Is this number negative?
+   *
+   * Set to 'true' when this instance of the class contains a
+   * value that is smaller than zero, and 'false' otherwise.
+   */
+  bool negative;
+
+  /**\brief Storage memory cells
+   *
+   * The actual number is stored in this variable. cell[0], if
+   * it exists, is the least significant set of bits that make
+   * up the number, cell[1] continues this series of bits by
+   * containing the bits shifted to the left by as many bits
+   * as would fit in cellType, and so forth.
+   */
+  storage cell;
+
+ protected:
+  static const Tu overflowMask = (Tu(1) << cellBitCount);
+  static const Tu lowMask = (Tu(1) << cellBitCount) - 1;
+  static const Tu highMask = ((Tu(1) << cellBitCount) - 1) << cellBitCount;
+
+  static const Tu cellsPerLong = sizeof(Tu) / sizeof(cellType);
+  static const Tu longBitCount = cellsPerLong * cellBitCount;
+
+  void shrink(void) {
+    cellType i = cell.size();
+    cellType rem = 0;
+
+    if (i == 0) {
+      negative = false;
+      return;
+    }
+
+    while (i > 0) {
+      i--;
+
+      if (cell[i] == cellType(0)) {
+        rem++;
+      } else {
+        break;
+      }
+    }
+
+    if (rem == 0) {
+      return;
+    }
+
+    cell.resize(cell.size() - rem);
+
+    if (cell.size() == 0) {
+      negative = false;
+    }
+  }
+
+  /**\brief Add signed cells in place
+   *
+   * Adds the number with the given cells and sign to this one, working
+   * directly on this number's cells: they only grow when the result
+   * needs more cells, so repeated additions and subtractions of numbers
+   * of similar size do not allocate. When the magnitude of b is the
+   * larger one, this number's cells are replaced with b minus them
+   * using the two's complement, which is ~x + b + 1.
+   *
+   * \param[in] b         The cells to add; may be this number's cells.
+   * \param[in] bn        Number of cells in b, without leading zeros.
+   * \param[in] bNegative Whether b is to be treated as negative.
+   */
+  void addSigned(const cellType *b, std::size_t bn, bool bNegative) {
+    const std::size_t n = cell.size();
+
+    if (bn == 0) {
+      return;
+    } else if (n == 0) {
+      cell.assign(b, b + bn);
+      negative = bNegative;
+      return;
+    }
+
+    if (negative == bNegative) {
+      if (n < bn) {
+        cell.resize(bn);
+      }
+
+      const cellType carry = addCells(cell.data(), cell.size(), b, bn);
+
+      if (carry != 0) {
+        cell.push_back(carry);
+      }
+    } else if (compareCells(cell.data(), n, b, bn) >= 0) {
+      subtractCells(cell.data(), n, b, bn);
+      shrink();
+    } else {
+      const cellType unit = 1;
+
+      cell.resize(bn);
+      for (std::size_t i = 0; i < bn; i++) {
+        cell[i] = ~cell[i];
+      }
+      addCells(cell.data(), bn, b, bn);
+      addCells(cell.data(), bn, &unit, 1);
+
+      negative = bNegative;
+      shrink();
+    }
+  }
+
+  void doMultiply(const bigIntegers &a, const bigIntegers &b) {
+    if ((a == zero()) || (b == zero())) {
+      cell.resize(0);
+      return;
+    }
+
+    if ((a.cell.size() + b.cell.size()) <= cellsPerLong) {
+      *this = bigIntegers((a).toInteger() * (b).toInteger(), negative);
+      return;
+    }
+
+    storage r(a.cell.size() + b.cell.size());
+
+    multiplyCells(r.data(), a.cell.data(), a.cell.size(), b.cell.data(),
+                  b.cell.size());
+
+    cell.swap(r);
+
+    shrink();
+  }
+
+  /**\brief Cell arithmetic kernels
+   *
+   * The loops over cells that all the other algorithms are built on.
+   */
+  typedef cellArithmetic<cellType, Tu, cellBitCount> kernel;
+
+  /**\copydoc cellArithmetic::add */
+  static cellType addCells(cellType *a, std::size_t an, const cellType *b,
+                           std::size_t bn) {
+    return kernel::add(a, an, b, bn);
+  }
+
+  /**\copydoc cellArithmetic::subtract */
+  static cellType subtractCells(cellType *a, std::size_t an, const cellType *b,
+                                std::size_t bn) {
+    return kernel::subtract(a, an, b, bn);
+  }
+
+  /**\copydoc cellArithmetic::divide */
+  static cellType divideCells(cellType *a, std::size_t n, const cellType &d) {
+    return kernel::divide(a, n, d);
+  }
+
+  /**\brief Create instance from raw cells
+   *
+   * \param[in] p The cells to copy, least significant cell first.
+   * \param[in] n Number of cells in p.
+   *
+   * \returns A positive big integer with the given cells.
+   */
+  static bigIntegers fromCells(const cellType *p, std::size_t n) {
+    bigIntegers r;
+
+    r.cell.assign(p, p + n);
+    r.shrink();
+
+    return r;
+  }
+
+  /**\brief Montgomery arithmetic
+   *
+   * Works with numbers in Montgomery form, i.e. x*R mod m for the odd
+   * modulus m with n cells and R = B^n, where B is 2^cellBitCount. The
+   * product of two such numbers is brought back into that form by
+   * reduce(), which adds multiples of m that clear the low cells one at a
+   * time and then drops them, so no division is needed.
+   */
+  class montgomery {
+   public:
+    /**\brief Construct with modulus
+     *
+     * \param[in] pModulus The modulus; must be odd and positive.
+     */
+    montgomery(const bigIntegers &pModulus)
+        : modulus(pModulus),
+          size(pModulus.cell.size()),
+          inverse(negatedInverse(pModulus.cell[0])) {}
+
+    /**\brief Convert to Montgomery form
+     *
+     * \param[in] x A number in [0, m).
+     *
+     * \returns x*R mod m.
+     */
+    bigIntegers convert(const bigIntegers &x) const {
+      return shiftCellsUp(x, size) % modulus;
+    }
+
+    /**\brief Montgomery reduction
+     *
+     * Also converts numbers out of Montgomery form, since x*R/R = x.
+     *
+     * \param[in] t A number in [0, m*R), e.g. the product of two
+     *              numbers in Montgomery form.
+     *
+     * \returns t/R mod m, in [0, m).
+     */
+    bigIntegers reduce(const bigIntegers &t) const {
+      storage r(2 * size + 1, cellType(0));
+      std::copy(t.cell.data(), t.cell.data() + t.cell.size(), r.data());
+
+      for (std::size_t i = 0; i < size; i++) {
+        const cellType u = cellType(Tu(r[i]) * Tu(inverse));
+        const cellType carry =
+            kernel::multiplyAdd(r.data() + i, modulus.cell.data(), size, u);
+        kernel::add(r.data() + i + size, size + 1 - i, &carry, 1);
+      }
+
+      bigIntegers x = fromCells(r.data() + size, size + 1);
+
+      if (compareMagnitude(x, modulus) >= 0) {
+        x -= modulus;
+      }
+
+      return x;
+    }
+
+   protected:
+    /**\brief Negated inverse of a cell
+     *
+     * Newton's iteration for the inverse modulo B, which doubles the
+     * number of correct bits with every step; an odd number is its own
+     * inverse modulo 8 already.
+     *
+     * \param[in] c An odd cell.
+     *
+     * \returns -1/c mod B.
+     */
+    static cellType negatedInverse(const cellType &c) {
+      cellType x = c;
+
+      for (unsigned int bits = 3; bits < cellBitCount; bits *= 2) {
+        x = cellType(Tu(x) * Tu(cellType(cellType(2) - cellType(Tu(c) * x))));
+      }
+
+      return cellType(cellType(0) - x);
+    }
+
+    const bigIntegers &modulus;
+    const std::size_t size;
+    const cellType inverse;
+  };
+
+  /**\brief Multiply cells
+   *
+   * Multiplies the an cells in a with the bn cells in b and writes the
+   * an+bn cells of the result to r, which must not overlap either
+   * operand. The algorithm is picked based on the operand sizes:
+   * schoolbook multiplication for small operands, Karatsuba above
+   * karatsubaThreshold, Toom-3 above toomCookThreshold and a
+   * number-theoretic transform above numberTheoreticThreshold. Unbalanced
+   * operands are cut into chunks the size of the smaller one first.
+   *
+   * \param[out] r  Where to write the an+bn cells of the product.
+   * \param[in]  a  First factor.
+   * \param[in]  an Number of cells in a.
+   * \param[in]  b  Second factor.
+   * \param[in]  bn Number of cells in b.
+   */
+  static void multiplyCells(cellType *r, const cellType *a, std::size_t an,
+                            const cellType *b, std::size_t bn) {
+    if (an < bn) {
+      std::swap(a, b);
+      std::swap(an, bn);
+    }
+
+    if (bn == 0) {
+      std::fill(r, r + an, cellType(0));
+#if defined(__SIZEOF_INT128__)
+    } else if ((bn >= numberTheoreticThreshold) &&
+               ((an + bn) * (cellBitCount / 16) <= numberTheoreticLength)) {
+      multiplyNumberTheoretic(r, a, an, b, bn);
+#endif
+    } else if (bn < karatsubaThreshold) {
+      multiplySchoolbook(r, a, an, b, bn);
+    } else if (bn <= ((an + 1) / 2)) {
+      multiplyUnbalanced(r, a, an, b, bn);
+    } else if ((bn >= toomCookThreshold) && (bn > (2 * ((an + 2) / 3)))) {
+      multiplyToomCook(r, a, an, b, bn);
+    } else {
+      multiplyKaratsuba(r, a, an, b, bn);
+    }
+  }
+
+  /**\brief Schoolbook multiplication
+   *
+   * Quadratic multiplication that keeps the carry for each row in a
+   * double-width accumulator instead of adding partial products to the
+   * full result.
+   *
+   * \copydetails multiplyCells
+   */
+  static void multiplySchoolbook(cellType *r, const cellType *a,
+                                 std::size_t an, const cellType *b,
+                                 std::size_t bn) {
+    std::fill(r, r + an + bn, cellType(0));
+
+    for (std::size_t i = 0; i < an; i++) {
+      if (a[i] != 0) {
+        r[(i + bn)] = kernel::multiplyAdd(r + i, b, bn, a[i]);
+      }
+    }
+  }
+
+  /**\brief Multiplication of unbalanced operands
+   *
+   * Cuts a into chunks of bn cells and multiplies these with b, which
+   * keeps the recursive algorithms working on balanced operands.
+   *
+   * \copydetails multiplyCells
+   */
+  static void multiplyUnbalanced(cellType *r, const cellType *a,
+                                 std::size_t an, const cellType *b,
+                                 std::size_t bn) {
+    std::vector<cellType> t(2 * bn);
+
+    std::fill(r, r + an + bn, cellType(0));
+
+    for (std::size_t o = 0; o < an; o += bn) {
+      const std::size_t n = std::min(bn, an - o);
+
+      multiplyCells(t.data(), a + o, n, b, bn);
+      addCells(r + o, an + bn - o, t.data(), n + bn);
+    }
+  }
+
+  /**\brief Karatsuba multiplication
+   *
+   * Splits both operands in two halves and uses three half-size
+   * products instead of four. Requires an >= bn > (an+1)/2.
+   *
+   * \copydetails multiplyCells
+   */
+  static void multiplyKaratsuba(cellType *r, const cellType *a, std::size_t an,
+                                const cellType *b, std::size_t bn) {
+    const std::size_t m = (an + 1) / 2;
+    const std::size_t a1n = an - m;
+    const std::size_t b1n = bn - m;
+
+    std::vector<cellType> sa(a, a + m);
+    std::vector<cellType> sb(b, b + m);
+    sa.push_back(addCells(sa.data(), m, a + m, a1n));
+    sb.push_back(addCells(sb.data(), m, b + m, b1n));
+
+    std::vector<cellType> z(2 * m + 2);
+    multiplyCells(z.data(), sa.data(), m + 1, sb.data(), m + 1);
+
+    multiplyCells(r, a, m, b, m);
+    multiplyCells(r + 2 * m, a + m, a1n, b + m, b1n);
+
+    subtractCells(z.data(), z.size(), r, 2 * m);
+    subtractCells(z.data(), z.size(), r + 2 * m, a1n + b1n);
+
+    std::size_t zn = z.size();
+    while ((zn > 0) && (z[(zn - 1)] == cellType(0))) {
+      zn--;
+    }
+
+    addCells(r + m, an + bn - m, z.data(), zn);
+  }
+
+  /**\brief Toom-3 multiplication
+   *
+   * Splits both operands in three parts, evaluates the resulting
+   * polynomials at 0, 1, -1, -2 and infinity and interpolates the
+   * product from the five pointwise products, using the sequence
+   * described by Bodrato and Zanoni in 2007. Requires an >= bn and
+   * bn > 2*ceil(an/3).
+   *
+   * \copydetails multiplyCells
+   */
+  static void multiplyToomCook(cellType *r, const cellType *a, std::size_t an,
+                               const cellType *b, std::size_t bn) {
+    const std::size_t k = (an + 2) / 3;
+
+    const bigIntegers a0 = fromCells(a, k);
+    const bigIntegers a1 = fromCells(a + k, k);
+    const bigIntegers a2 = fromCells(a + 2 * k, an - 2 * k);
+    const bigIntegers b0 = fromCells(b, k);
+    const bigIntegers b1 = fromCells(b + k, k);
+    const bigIntegers b2 = fromCells(b + 2 * k, bn - 2 * k);
+
+    bigIntegers pa = a0 + a2;
+    bigIntegers pb = b0 + b2;
+    const bigIntegers ap1 = pa + a1;
+    const bigIntegers bp1 = pb + b1;
+    const bigIntegers am1 = pa - a1;
+    const bigIntegers bm1 = pb - b1;
+    pa = am1 + a2;
+    pb = bm1 + b2;
+    const bigIntegers am2 = pa + pa - a0;
+    const bigIntegers bm2 = pb + pb - b0;
+
+    const bigIntegers r0 = a0 * b0;
+    bigIntegers r1 = ap1 * bp1;
+    const bigIntegers rm1 = am1 * bm1;
+    const bigIntegers rm2 = am2 * bm2;
+    const bigIntegers r4 = a2 * b2;
+
+    bigIntegers r3 = rm2 - r1;
+    r3.divideExact(3);
+    r1 = r1 - rm1;
+    r1.divideExact(2);
+    bigIntegers r2 = rm1 - r0;
+    r3 = r2 - r3;
+    r3.divideExact(2);
+    r3 = r3 + r4 + r4;
+    r2 = r2 + r1 - r4;
+    r1 = r1 - r3;
+
+    const std::size_t n = an + bn;
+    const bigIntegers *c[5] = {&r0, &r1, &r2, &r3, &r4};
+
+    std::fill(r, r + n, cellType(0));
+
+    for (std::size_t i = 0; i < 5; i++) {
+      addCells(r + i * k, n - i * k, c[i]->cell.data(), c[i]->cell.size());
+    }
+  }
+
+#if defined(__SIZEOF_INT128__)
+  /**\brief Number-theoretic transform multiplication
+   *
+   * Cuts both operands into 16-bit digits and convolves these modulo
+   * three primes just below 2^30. Each coefficient of the convolution is
+   * less than 2^54 for the supported lengths, so it is recovered exactly
+   * from its three residues with Garner's algorithm, with no rounding
+   * involved. Requires cellBitCount to be a multiple of 16 and
+   * (an+bn)*cellBitCount/16 to be at most numberTheoreticLength.
+   *
+   * \copydetails multiplyCells
+   */
+  static void multiplyNumberTheoretic(cellType *r, const cellType *a,
+                                      std::size_t an, const cellType *b,
+                                      std::size_t bn) {
+    typedef numberTheoreticTransform<998244353, 3> p1;
+    typedef numberTheoreticTransform<167772161, 3> p2;
+    typedef numberTheoreticTransform<469762049, 3> p3;
+
+    constexpr std::uint32_t digitsPerCell = cellBitCount / 16;
+    constexpr std::uint64_t m1 = 998244353;
+    constexpr std::uint64_t m2 = 167772161;
+    constexpr std::uint64_t m3 = 469762049;
+    constexpr std::uint32_t m1inv2 = p2::inverse(std::uint32_t(m1 % m2));
+    constexpr std::uint32_t m1inv3 = p3::inverse(std::uint32_t(m1 % m3));
+    constexpr std::uint32_t m2inv3 = p3::inverse(std::uint32_t(m2 % m3));
+
+    const std::size_t n = (an + bn) * digitsPerCell;
+    std::size_t length = 1;
+    while (length < n) {
+      length <<= 1;
+    }
+
+    std::vector<std::uint32_t> da(length), db(length);
+
+    for (std::size_t i = 0; i < an; i++) {
+      for (std::uint32_t j = 0; j < digitsPerCell; j++) {
+        da[(i * digitsPerCell + j)] = (a[i] >> (16 * j)) & 0xffff;
+      }
+    }
+
+    for (std::size_t i = 0; i < bn; i++) {
+      for (std::uint32_t j = 0; j < digitsPerCell; j++) {
+        db[(i * digitsPerCell + j)] = (b[i] >> (16 * j)) & 0xffff;
+      }
+    }
+
+    const std::vector<std::uint32_t> c1 = p1::convolve(da, db);
+    const std::vector<std::uint32_t> c2 = p2::convolve(da, db);
+    const std::vector<std::uint32_t> c3 = p3::convolve(da, db);
+
+    unsigned __int128 carry = 0;
+
+    std::fill(r, r + an + bn, cellType(0));
+
+    for (std::size_t i = 0; i < n; i++) {
+      const std::uint32_t x1 = c1[i];
+      const std::uint32_t x2 =
+          p2::multiply(std::uint32_t((c2[i] + m2 - x1 % m2) % m2), m1inv2);
+      const std::uint32_t y3 =
+          p3::multiply(std::uint32_t((c3[i] + m3 - x1 % m3) % m3), m1inv3);
+      const std::uint32_t x3 =
+          p3::multiply(std::uint32_t((y3 + m3 - x2 % m3) % m3), m2inv3);
+
+      carry += x1 + m1 * (x2 + (unsigned __int128)(m2)*x3);
+
+      r[(i / digitsPerCell)] |= cellType(carry & 0xffff)
+                                << (16 * (i % digitsPerCell));
+      carry >>= 16;
+    }
+  }
+#endif
+
+  /**\brief Value of a digit
+   *
+   * \param[in] c The digit, 0-9, a-z or A-Z.
+   *
+   * \returns The value of the digit, or 36 for invalid digits.
+   */
+  static unsigned int digitValue(char c) {
+    return (c >= '0' && c <= '9')
+               ? unsigned(c - '0')
+               : (c >= 'a' && c <= 'z')
+                     ? unsigned(c - 'a' + 10)
+                     : (c >= 'A' && c <= 'Z') ? unsigned(c - 'A' + 10) : 36;
+  }
+
+  /**\brief Digits per chunk
+   *
+   * \param[in] base The base to convert to or from.
+   *
+   * \returns How many digits in the given base fit into a single cell.
+   */
+  static unsigned int digitsPerChunk(unsigned int base) {
+    unsigned int d = 0;
+
+    for (Tu c = base; c <= lowMask; c *= base) {
+      d++;
+    }
+
+    return d;
+  }
+
+  /**\brief Chunk value
+   *
+   * \param[in] base The base to convert to or from.
+   *
+   * \returns base^digitsPerChunk(base).
+   */
+  static cellType chunkOf(unsigned int base) {
+    cellType c = 1;
+
+    for (unsigned int d = digitsPerChunk(base); d > 0; d--) {
+      c *= base;
+    }
+
+    return c;
+  }
+
+  /**\brief Multiply by a single cell and add
+   *
+   * \param[in,out] a The cells to update in place.
+   * \param[in]     n Number of cells in a.
+   * \param[in]     m The factor.
+   * \param[in]     c The summand.
+   *
+   * \returns The carry out of the most significant cell of a.
+   */
+  static cellType multiplyAddCells(cellType *a, std::size_t n,
+                                   const cellType &m, const cellType &c) {
+    Tu carry = c;
+
+    for (std::size_t i = 0; i < n; i++) {
+      carry += Tu(a[i]) * m;
+      a[i] = cellType(carry);
+      carry >>= cellBitCount;
+    }
+
+    return cellType(carry);
+  }
+
+  /**\brief Write digits in a power-of-two base
+   *
+   * \param[in,out] s    Where to append the digits.
+   * \param[in]     base The base; must be a power of two.
+   */
+  void writeBits(std::string &s, unsigned int base) const {
+    unsigned int k = 0;
+    while ((1u << k) < base) {
+      k++;
+    }
+
+    std::size_t bits = cell.size() * cellBitCount;
+    while ((cell.back() >> ((bits - 1) % cellBitCount)) == 0) {
+      bits--;
+    }
+
+    for (std::size_t i = (bits + k - 1) / k; i > 0; i--) {
+      const std::size_t o = (i - 1) * k;
+      const std::size_t c = o / cellBitCount;
+      Tu v = Tu(cell[c]) >> (o % cellBitCount);
+
+      if (c + 1 < cell.size()) {
+        v |= Tu(cell[(c + 1)]) << (cellBitCount - o % cellBitCount);
+      }
+
+      s += digits[(v & (base - 1))];
+    }
+  }
+
+  /**\brief Write digits recursively
+   *
+   * Writes |x| in the given base, padded with zeroes to at least width
+   * digits. Large numbers are split by the largest power of the chunk
+   * that is not larger than the number, and both halves are written
+   * recursively.
+   *
+   * \param[in,out] s           Where to append the digits.
+   * \param[in]     x           The number to write.
+   * \param[in]     base        The base; must not be a power of two.
+   * \param[in]     powers      The chunk raised to the powers 1, 2, 4, etc.
+   * \param[in,out] reciprocals Cache for the reciprocals of the powers
+   *                            that are large enough for divideNewton().
+   * \param[in]     width       Minimum number of digits to write.
+   */
+  static void writeDigits(std::string &s, const bigIntegers &x,
+                          unsigned int base,
+                          const std::vector<bigIntegers> &powers,
+                          std::vector<bigIntegers> &reciprocals,
+                          std::size_t width) {
+    if (x.cell.size() >= radixThreshold) {
+      std::size_t k = powers.size();
+
+      while ((k > 0) && (compareMagnitude(powers[(k - 1)], x) > 0)) {
+        k--;
+      }
+
+      if (k > 0) {
+        const std::size_t w = std::size_t(digitsPerChunk(base)) << (k - 1);
+
+        const bigIntegers &p = powers[(k - 1)];
+        bigIntegers &x1 = reciprocals[(k - 1)];
+        bigIntegers q, r;
+
+        if (p.cell.size() < newtonThreshold) {
+          divideMagnitude(x, p, q, r);
+        } else {
+          if (x1.cell.size() == 0) {
+            x1 = reciprocal(p);
+          }
+          divideReciprocal(x, p, x1, q, r);
+        }
+
+        writeDigits(s, q, base, powers, reciprocals,
+                    (width > w) ? (width - w) : 0);
+        writeDigits(s, r, base, powers, reciprocals, w);
+        return;
+      }
+    }
+
+    const unsigned int d = digitsPerChunk(base);
+    const cellType chunk = chunkOf(base);
+    std::vector<cellType> c(x.cell.begin(), x.cell.end());
+    std::size_t n = c.size();
+    std::string t;
+
+    while (n > 0) {
+      cellType r = divideCells(c.data(), n, chunk);
+
+      while ((n > 0) && (c[(n - 1)] == 0)) {
+        n--;
+      }
+
+      for (unsigned int i = 0; i < d && ((n > 0) || (r > 0)); i++) {
+        t += digits[(r % base)];
+        r /= base;
+      }
+    }
+
+    if (t.size() < width) {
+      t.append(width - t.size(), '0');
+    }
+
+    s.append(t.rbegin(), t.rend());
+  }
+
+  /**\brief Read digits in a power-of-two base
+   *
+   * \param[in] first Start of the digits to read.
+   * \param[in] last  End of the digits to read.
+   * \param[in] base  The base; must be a power of two.
+   *
+   * \returns The positive number represented by the digits.
+   */
+  static bigIntegers readBits(const char *first, const char *last,
+                              unsigned int base) {
+    unsigned int k = 0;
+    while ((1u << k) < base) {
+      k++;
+    }
+
+    bigIntegers r;
+    r.cell.assign(((last - first) * k + cellBitCount - 1) / cellBitCount, 0);
+
+    std::size_t o = 0;
+    for (const char *p = last; p > first; p--, o += k) {
+      const Tu v = Tu(digitValue(*(p - 1))) << (o % cellBitCount);
+
+      r.cell[(o / cellBitCount)] |= cellType(v);
+      if ((v >> cellBitCount) != 0) {
+        r.cell[(o / cellBitCount + 1)] |= cellType(v >> cellBitCount);
+      }
+    }
+
+    r.shrink();
+
+    return r;
+  }
+
+  /**\brief Combine chunks recursively
+   *
+   * Combines chunks of digits, least significant chunk first, to the
+   * number they represent. Long sequences are split at the largest power
+   * of two that is less than the number of chunks, and the two halves
+   * combined with one multiplication by the matching power of the chunk.
+   *
+   * \param[in] chunks The chunks to combine.
+   * \param[in] n      Number of chunks.
+   * \param[in] base   The base; must not be a power of two.
+   * \param[in] powers The chunk raised to the powers 1, 2, 4, etc.
+   *
+   * \returns The positive number represented by the chunks.
+   */
+  static bigIntegers readChunks(const cellType *chunks, std::size_t n,
+                                unsigned int base,
+                                const std::vector<bigIntegers> &powers) {
+    if (n >= radixThreshold) {
+      std::size_t k = 0;
+      while ((std::size_t(2) << k) < n) {
+        k++;
+      }
+
+      return readChunks(chunks + (std::size_t(1) << k),
+                        n - (std::size_t(1) << k), base, powers) *
+                 powers[k] +
+             readChunks(chunks, std::size_t(1) << k, base, powers);
+    }
+
+    const cellType chunk = chunkOf(base);
+    bigIntegers r;
+
+    for (std::size_t i = n; i > 0; i--) {
+      const cellType carry = multiplyAddCells(r.cell.data(), r.cell.size(),
+                                              chunk, chunks[(i - 1)]);
+      if (carry != 0) {
+        r.cell.push_back(carry);
+      }
+    }
+
+    return r;
+  }
+
+  /**\brief Digits for string conversions
+   *
+   * Contains the digits used by toChars(), in ascending order.
+   */
+  static constexpr const char *digits = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+  /**\brief Exact division by a single cell
+   *
+   * Divides the magnitude of this number by d, keeping the sign. Only
+   * used where the remainder is known to be zero.
+   *
+   * \param[in] d The divisor; must not be zero.
+   */
+  void divideExact(const cellType &d) {
+    divideCells(cell.data(), cell.size(), d);
+    shrink();
+  }
+
+  void doDivide(const bigIntegers &a, const bigIntegers &b) {
+    bigIntegers q, r;
+
+    if (b.cell.size() > 0) {
+      divideMagnitude(a, b, q, r);
+    }
+
+    cell.swap(q.cell);
+  }
+
+  void doModuloHorner(const bigIntegers &a, const cellType &b) {
+    Tu modulus = Tu(b);
+    Tu result = Tu(0);
+    const Tu factor = (Tu(1) << cellBitCount) % modulus;
+
+    for (cellType i = a.cell.size(); i > 0; i--) {
+      result *= factor;
+      result %= modulus;
+      result += (Tu(a.cell[(i - 1)]) % modulus);
+      result %= modulus;
+    }
+
+    cell.resize(1);
+
+    cell[0] = result;
+
+    shrink();
+  }
+
+  void doModuloHorner(const bigIntegers &a, const bigIntegers &b) {
+    cellType q = a.cell.size() / b.cell.size();
+    cellType qm = a.cell.size() % b.cell.size();
+
+    Tu modulus = Tu(b.cell[0]);
+    Tu result = Tu(0);
+
+    for (cellType i = 1; i < b.cell.size(); i++) {
+      modulus |= (Tu(b.cell[i]) << (i * cellBitCount));
+    }
+
+    const Tu factor = (Tu(1) << (cellBitCount * b.cell.size())) % modulus;
+
+    for (cellType j = q; j > 0; j--) {
+      Tu value;
+
+      if ((j == q) && (qm > 0)) {
+        cellType i = (j - 1) * b.cell.size();
+        value = Tu(a.cell[i]);
+
+        for (cellType k = 1; k < qm; k++) {
+          value |= (Tu(a.cell[(i + k)]) << (k * cellBitCount));
+        }
+      } else {
+        cellType i = (j - 1) * b.cell.size();
+        value = Tu(a.cell[i]);
+
+        for (cellType k = 1; k < b.cell.size(); k++) {
+          value |= (Tu(a.cell[(i + k)]) << (k * cellBitCount));
+        }
+      }
+
+      result *= factor;
+      result %= modulus;
+      result += value % modulus;
+      result %= modulus;
+    }
+
+    cell.resize(b.cell.size());
+
+    for (cellType i = 0; i < cell.size(); i++) {
+      cell[i] = result & lowMask;
+      result >>= cellBitCount;
+    }
+
+    shrink();
+  }
+
+  void doModulo(const bigIntegers &a, const bigIntegers &b) {
+    bigIntegers q, r;
+
+    if (b.cell.size() > 0) {
+      divideMagnitude(a, b, q, r);
     }
 
-    return (*this = (*this << b));
+    cell.swap(r.cell);
   }
 
-  /**\brief Is this number negative?
+  /**\brief Compare magnitudes
    *
-   * Set to 'true' when this instance of the class contains a
-   * value that is smaller than zero, and 'false' otherwise.
+   * \param[in] a First operand; the sign is ignored.
+   * \param[in] b Second operand; the sign is ignored.
+   *
+   * \returns -1, 0 or 1 if |a| is less than, equal to or greater than |b|.
    */
-  bool negative;
+  static int compareMagnitude(const bigIntegers &a, const bigIntegers &b) {
+    return compareCells(a.cell.data(), a.cell.size(), b.cell.data(),
+                        b.cell.size());
+  }
 
-  /**\brief Storage memory cells
+  /**\brief Compare raw cells
    *
-   * The actual number is stored in this variable. cell[0], if
-   * it exists, is the least significant set of bits that make
-   * up the number, cell[1] continues this series of bits by
-   * containing the bits shifted to the left by as many bits
-   * as would fit in cellType, and so forth.
+   * \copydetails compareMagnitude
+   *
+   * Takes the cells directly; neither a nor b may have leading zero
+   * cells.
    */
-  std::vector<cellType> cell;
-
- protected:
-  static const Tu overflowMask = (1L << cellBitCount);
-  static const Tu lowMask = (1L << cellBitCount) - 1;
-  static const Tu highMask = ((1L << cellBitCount) - 1) << cellBitCount;
+  static int compareCells(const cellType *a, std::size_t an, const cellType *b,
+                          std::size_t bn) {
+    if (an != bn) {
+      return an < bn ? -1 : 1;
+    }
 
-  static const Tu cellsPerLong = sizeof(Tu) / sizeof(cellType);
-  static const Tu longBitCount = cellsPerLong * cellBitCount;
+    for (std::size_t i = an; i > 0; i--) {
+      if (a[(i - 1)] != b[(i - 1)]) {
+        return a[(i - 1)] < b[(i - 1)] ? -1 : 1;
+      }
+    }
 
-  void shrink(void) {
-    cellType i = cell.size();
-    cellType rem = 0;
+    return 0;
+  }
 
-    if (i == 0) {
-      negative = false;
-      return;
+  /**\brief Divide magnitudes
+   *
+   * Divides |a| by |b|, which must not be zero, and stores the quotient
+   * and remainder in q and r, which must not alias a or b. Single-cell
+   * divisors use a simple cell-wise division, divisors and quotients
+   * with at least newtonThreshold cells use divideNewton() and
+   * everything else uses Knuth's Algorithm D, whose cost is only linear
+   * when the quotient is short.
+   *
+   * \param[in]  a The dividend.
+   * \param[in]  b The divisor.
+   * \param[out] q The quotient.
+   * \param[out] r The remainder.
+   */
+  static void divideMagnitude(const bigIntegers &a, const bigIntegers &b,
+                              bigIntegers &q, bigIntegers &r) {
+    const std::size_t an = a.cell.size();
+    const std::size_t bn = b.cell.size();
+
+    q.negative = false;
+    r.negative = false;
+
+    if (compareMagnitude(a, b) < 0) {
+      q.cell.clear();
+      r.cell = a.cell;
+    } else if (bn == 1) {
+      q.cell = a.cell;
+      r.cell.assign(1, divideCells(q.cell.data(), an, b.cell[0]));
+    } else if ((bn >= newtonThreshold) && (an - bn >= newtonThreshold)) {
+      divideNewton(a, b, q, r);
+    } else {
+      q.cell.resize(an - bn + 1);
+      r.cell.resize(bn);
+      divideKnuth(q.cell.data(), r.cell.data(), a.cell.data(), an,
+                  b.cell.data(), bn);
     }
 
-    while (i > 0) {
-      i--;
+    q.shrink();
+    r.shrink();
+  }
 
-      if (cell[i] == cellType(0)) {
-        rem++;
-      } else {
-        break;
-      }
-    }
+  /**\brief Knuth's Algorithm D
+   *
+   * Long division with one cell per step, as described in section 4.3.1
+   * of The Art of Computer Programming. Both operands are normalised so
+   * that the divisor's most significant bit is set, which means the
+   * quotient cell estimated from the top two cells is off by at most two.
+   *
+   * \param[out] q  The an-bn+1 cells of the quotient.
+   * \param[out] r  The bn cells of the remainder.
+   * \param[in]  a  The dividend.
+   * \param[in]  an Number of cells in a; at least bn.
+   * \param[in]  b  The divisor; the most significant cell must not be
+   *                zero.
+   * \param[in]  bn Number of cells in b; at least two.
+   */
+  static void divideKnuth(cellType *q, cellType *r, const cellType *a,
+                          std::size_t an, const cellType *b, std::size_t bn) {
+    const Tu base = Tu(1) << cellBitCount;
+    unsigned int s = 0;
 
-    if (rem == 0) {
-      return;
+    while ((b[(bn - 1)] << s) >> (cellBitCount - 1) == 0) {
+      s++;
     }
 
-    cell.resize(cell.size() - rem);
+    std::vector<cellType> u(an + 1), v(bn);
+    cellType carry = 0;
 
-    if (cell.size() == 0) {
-      negative = false;
+    for (std::size_t i = 0; i < bn; i++) {
+      const Tu t = Tu(b[i]) << s;
+      v[i] = cellType(t) | carry;
+      carry = cellType(t >> cellBitCount);
     }
-  }
 
-  void doAdd(const bigIntegers &a, const bigIntegers &b, bool allocate = true) {
-    /*
-    if ((a.cell.size() <= cellsPerLong) && (b.cell.size() <= cellsPerLong))
-    {
-        *this = bigIntegers(Tu(a) + Tu(b), negative);
-        if ((*this >= a) && (*this >= b))
-        {
-            return;
-        }
+    carry = 0;
+
+    for (std::size_t i = 0; i < an; i++) {
+      const Tu t = Tu(a[i]) << s;
+      u[i] = cellType(t) | carry;
+      carry = cellType(t >> cellBitCount);
     }
-    */
 
-    bool overflow = false;
+    u[an] = carry;
 
-    if (allocate) {
-      cell.resize((a.cell.size() > b.cell.size()) ? a.cell.size()
-                                                  : b.cell.size());
-      if (cell.size() == 0) {
-        return;
+    for (std::size_t j = an - bn + 1; j > 0; j--) {
+      cellType *uj = u.data() + (j - 1);
+      const Tu n = (Tu(uj[bn]) << cellBitCount) | Tu(uj[(bn - 1)]);
+      Tu qhat = n / v[(bn - 1)];
+      Tu rhat = n % v[(bn - 1)];
+
+      while ((qhat >= base) ||
+             (qhat * v[(bn - 2)] > ((rhat << cellBitCount) | uj[(bn - 2)]))) {
+        qhat--;
+        rhat += v[(bn - 1)];
+        if (rhat >= base) {
+          break;
+        }
       }
-    }
 
-    if (cell.size() == 0) {
-      return;
-    }
+      Tu carry = 0;
+      Tu borrow = 0;
 
-    for (cellType i = 0; i < cell.size(); i++) {
-      cellType av = (i < a.cell.size()) ? a.cell[i] : 0;
-      cellType bv = (i < b.cell.size()) ? b.cell[i] : 0;
+      for (std::size_t i = 0; i < bn; i++) {
+        const Tu p = qhat * v[i] + carry;
+        const Tu t = Tu(uj[i]) - (p & lowMask) - borrow;
+        carry = p >> cellBitCount;
+        uj[i] = cellType(t);
+        borrow = (t >> cellBitCount) & 1;
+      }
 
-      if (overflow) {
-        bv = bv + 1;
+      const Tu t = Tu(uj[bn]) - carry - borrow;
+      uj[bn] = cellType(t);
 
-        overflow = (bv == 0);
+      if ((t >> cellBitCount) != 0) {
+        qhat--;
+        uj[bn] += addCells(uj, bn, v.data(), bn);
       }
 
-      cell[i] = (overflow ? av : (av + bv));
-
-      overflow = overflow || ((cell[i] < av) || (cell[i] < bv));
+      q[(j - 1)] = cellType(qhat);
     }
 
-    if (overflow)  // overflow in the most significant cell, add extra cell
-    {
-      cell.push_back(cellType(1));
+    for (std::size_t i = 0; i < bn; i++) {
+      r[i] = cellType(((Tu(u[(i + 1)]) << cellBitCount) | Tu(u[i])) >> s);
     }
   }
 
-  void doSubtract(const bigIntegers &a, const bigIntegers &b,
-                  bool allocate = true) {
-    if ((a.cell.size() <= cellsPerLong) && (b.cell.size() <= cellsPerLong)) {
-      *this = bigIntegers((a).toInteger() - (b).toInteger(), negative);
-      return;
+  /**\brief Shift by whole cells
+   *
+   * \param[in] x The number to shift.
+   * \param[in] k How many cells to shift by.
+   *
+   * \returns x*B^k, where B is 2^cellBitCount.
+   */
+  static bigIntegers shiftCellsUp(bigIntegers x, std::size_t k) {
+    if (x.cell.size() > 0) {
+      x.cell.insert(x.cell.begin(), k, cellType(0));
     }
 
-    bool overflow = true;
-
-    if (allocate) {
-      cell.resize(a.cell.size());
-    }
+    return x;
+  }
 
-    if (cell.size() == 0) {
-      negative = false;
-      return;
+  /**\brief Truncate whole cells
+   *
+   * \param[in] x The number to shift.
+   * \param[in] k How many cells to drop.
+   *
+   * \returns x/B^k, rounded towards zero, where B is 2^cellBitCount.
+   */
+  static bigIntegers shiftCellsDown(const bigIntegers &x, std::size_t k) {
+    if (x.cell.size() <= k) {
+      return bigIntegers();
     }
 
-    for (cellType i = 0; i < cell.size(); i++) {
-      cellType av = (i < a.cell.size()) ? a.cell[i] : 0;
-      cellType bv = ~((i < b.cell.size()) ? b.cell[i] : 0);
-
-      if (overflow) {
-        bv = bv + 1;
+    bigIntegers r = fromCells(x.cell.data() + k, x.cell.size() - k);
+    r.negative = x.negative && (r.cell.size() > 0);
 
-        overflow = (bv == 0);
-      }
+    return r;
+  }
 
-      cell[i] = (overflow ? av : (av + bv));
+  /**\brief Newton reciprocal
+   *
+   * Approximates B^(2n)/b, where b has n cells and B is 2^cellBitCount.
+   * The reciprocal of the top half of b, plus two guard cells, is
+   * calculated recursively, and a single Newton iteration
+   * x + x*(B^(2n) - b*x)/B^(2n) then doubles its precision. The guard
+   * cells keep the error within a few units, which divideReciprocal()
+   * corrects for when it checks the remainder.
+   *
+   * \param[in] b The number to calculate the reciprocal of; positive.
+   *
+   * \returns B^(2n)/b, off by at most a few units.
+   */
+  static bigIntegers reciprocal(const bigIntegers &b) {
+    const std::size_t n = b.cell.size();
+    const bigIntegers power = shiftCellsUp(bigIntegers(1), 2 * n);
 
-      overflow = overflow || ((cell[i] < av) || (cell[i] < bv));
+    if (n < newtonThreshold) {
+      bigIntegers q, r;
+      q.cell.resize(n + 2);
+      r.cell.resize(n);
+      divideKnuth(q.cell.data(), r.cell.data(), power.cell.data(), 2 * n + 1,
+                  b.cell.data(), n);
+      q.shrink();
+      return q;
     }
 
-    if (a.cell.size() > 0) {
-      cellType &l = cell[(cell.size() - 1)];
-      cellType o = a.cell[(a.cell.size() - 1)];
+    const std::size_t h = n / 2 + 2;
+    const std::size_t k = n - h;
 
-      unsigned int j = cellBitCount;
+    const bigIntegers x = shiftCellsUp(reciprocal(shiftCellsDown(b, k)), k);
 
-      do {
-        j--;
-
-        if (!(o & (1 << j))) {
-          l &= ~cellType(1 << j);
-        } else {
-          break;
-        }
-      } while (j > 0);
-    }
+    /* only the top cells of the error term affect the result */
+    const bigIntegers e = shiftCellsDown(power - b * x, n - 1);
 
-    shrink();
+    return x + shiftCellsDown(x * e, n + 1);
   }
 
-  void doMultiply(const bigIntegers &a, const bigIntegers &b,
-                  bool allocate = true) {
-    if ((a == zero()) || (b == zero())) {
-      cell.resize(0);
-      return;
-    }
-
-    if ((a.cell.size() + b.cell.size()) <= cellsPerLong) {
-      *this = bigIntegers((a).toInteger() * (b).toInteger(), negative);
-      return;
-    }
+  /**\brief Division with a Newton reciprocal
+   *
+   * Divides |a| by |b| by multiplying with the reciprocal of b, which
+   * makes the division about as fast as the multiplication. The dividend
+   * is processed in chunks of n cells from the most significant end,
+   * where n is the size of b, so that each chunk needs two n by n cell
+   * products. See divideMagnitude() for the parameters.
+   */
+  static void divideNewton(const bigIntegers &a, const bigIntegers &b,
+                           bigIntegers &q, bigIntegers &r) {
+    const bigIntegers bp = b.negative ? -b : b;
 
-    if (allocate) {
-      cell.resize(a.cell.size() + b.cell.size() + 1);
-    }
+    divideReciprocal(a, bp, reciprocal(bp), q, r);
+  }
 
-    bigIntegers c;
+  /**\brief Division with a known reciprocal
+   *
+   * The actual division in divideNewton(), for callers that divide by the
+   * same number repeatedly and want to calculate its reciprocal only once.
+   *
+   * \param[in]  a  The dividend.
+   * \param[in]  bp The divisor; positive.
+   * \param[in]  x  The approximate reciprocal of bp, as returned by
+   *                reciprocal().
+   * \param[out] q  The quotient.
+   * \param[out] r  The remainder.
+   */
+  static void divideReciprocal(const bigIntegers &a, const bigIntegers &bp,
+                               const bigIntegers &x, bigIntegers &q,
+                               bigIntegers &r) {
+    const std::size_t an = a.cell.size();
+    const std::size_t n = bp.cell.size();
+
+    q.cell.assign(an, cellType(0));
+    r = bigIntegers();
+
+    for (std::size_t c = (an + n - 1) / n; c > 0; c--) {
+      const std::size_t o = (c - 1) * n;
+      const bigIntegers t = shiftCellsUp(r, n) +
+                            fromCells(a.cell.data() + o, std::min(n, an - o));
+      bigIntegers qc = shiftCellsDown(t * x, 2 * n);
+      r = t - qc * bp;
+
+      while (r.negative) {
+        qc -= one();
+        r += bp;
+      }
 
-    c.cell.resize(cell.size());
+      while (r >= bp) {
+        qc += one();
+        r -= bp;
+      }
 
-    for (cellType k = 0; k < cell.size(); k++) {
-      cell[k] = cellType(0);
-      c.cell[k] = cellType(0);
+      std::copy(qc.cell.begin(), qc.cell.end(), q.cell.begin() + o);
     }
 
-    for (cellType i = 0; i < a.cell.size(); i++) {
-      for (cellType j = 0; j < b.cell.size(); j++) {
-        cellType t = i + j + 1;
+    q.shrink();
+  }
 
-        Tu rx = Tu(a.cell[i]) * Tu(b.cell[j]);
+  /**\brief GCD cofactor matrix
+   *
+   * The 2x2 matrix that takes a pair of numbers (x, y) to the pair
+   * (a*x + b*y, c*x + d*y). Its determinant is always 1 or -1, so both
+   * pairs have the same greatest common divisor.
+   */
+  class cofactors {
+   public:
+    cofactors() : a(1), b(), c(), d(1) {}
 
-        cellType low = cellType(rx & lowMask);
-        cellType high = cellType((rx & highMask) >> cellBitCount);
+    bigIntegers a, b, c, d;
+  };
 
-        c.cell[t] = high;
-        c.cell[(t - 1)] = low;
+  /**\brief Bits from a given position
+   *
+   * \param[in] v The number to read the bits from.
+   * \param[in] s Position of the least significant bit to read.
+   *
+   * \returns The bits of v from bit s, truncated to the width of Tu.
+   */
+  static Tu leadingBits(const bigIntegers &v, std::size_t s) {
+    const std::size_t c = s / cellBitCount;
+    const unsigned int o = s % cellBitCount;
+    Tu r = 0;
 
-        doAdd(*this, c, false);
+    for (unsigned int i = 0; (i < 3) && (c + i < v.cell.size()); i++) {
+      const Tu t = Tu(v.cell[(c + i)]);
 
-        c.cell[t] = cellType(0);
-        c.cell[(t - 1)] = cellType(0);
+      if (i == 0) {
+        r |= t >> o;
+      } else if (i * cellBitCount - o < 2 * cellBitCount) {
+        r |= t << (i * cellBitCount - o);
       }
     }
 
-    shrink();
+    return r;
   }
 
-  void doDivide(const bigIntegers &a, const bigIntegers &b,
-                bool allocate = true) {
-    if (a == zero()) {
-      cell.resize(0);
-      return;
-    }
+  /**\brief Single-cell Lehmer cofactors
+   *
+   * Runs the Euclidean algorithm on the leading 2*cellBitCount-2 bits of
+   * x and y, as in Knuth's Algorithm L: each quotient is only accepted if
+   * it is the same for both ends of the interval the leading bits could
+   * stand for, which makes it the quotient the full numbers would also
+   * produce. Stops before the cofactors stop fitting into a cell.
+   *
+   * \param[in]  x The larger number; positive.
+   * \param[in]  y The smaller number; not negative.
+   * \param[out] A Cofactor of x in the new x.
+   * \param[out] B Cofactor of y in the new x.
+   * \param[out] C Cofactor of x in the new y.
+   * \param[out] D Cofactor of y in the new y.
+   *
+   * \returns 'false' if not even the first quotient could be determined,
+   *          in which case a regular division step is needed.
+   */
+  static bool lehmerCofactors(const bigIntegers &x, const bigIntegers &y,
+                              Ts &A, Ts &B, Ts &C, Ts &D) {
+    constexpr std::size_t h = 2 * cellBitCount - 2;
+    const Ts limit = Ts(1) << (cellBitCount - 1);
+    const std::size_t l = x.bitLength();
+    const std::size_t s = (l > h) ? (l - h) : 0;
+    Ts u = Ts(leadingBits(x, s));
+    Ts v = Ts(leadingBits(y, s));
+
+    A = 1;
+    B = 0;
+    C = 0;
+    D = 1;
+
+    while ((v + C > 0) && (v + D > 0)) {
+      const Ts q = (u + A) / (v + C);
+
+      if ((q != (u + B) / (v + D)) || (q >= limit)) {
+        break;
+      }
 
-    if (b == zero()) {
-      /* ebil */
-      cell.resize(0);
-      return;
-    }
+      const Ts nC = A - q * C;
+      const Ts nD = B - q * D;
 
-    if (b == one()) {
-      *this = a;
-      return;
-    }
+      if ((nC >= limit) || (nC <= -limit) || (nD >= limit) ||
+          (nD <= -limit)) {
+        break;
+      }
 
-    if (b > a) {
-      cell.resize(0);
-      return;
+      const Ts nv = u - q * v;
+
+      A = C;
+      B = D;
+      C = nC;
+      D = nD;
+      u = v;
+      v = nv;
     }
 
-    cell.resize(0);
+    return B != 0;
+  }
 
-    bigIntegers r = bigIntegers();
+  /**\brief Difference of single-cell multiples
+   *
+   * Calculates r = p*a - q*b in n cells, which need to be at least one
+   * more than the larger of an and bn.
+   *
+   * \returns 'true' if the difference was negative, in which case r holds
+   *          its two's complement.
+   */
+  static bool multiplySubtractCells(cellType *r, std::size_t n,
+                                    const cellType *a, std::size_t an,
+                                    cellType p, const cellType *b,
+                                    std::size_t bn, cellType q) {
+    Tu ca = 0;
+    Tu cb = 0;
+    Tu borrow = 0;
+
+    for (std::size_t i = 0; i < n; i++) {
+      const Tu pa = ((i < an) ? Tu(a[i]) * p : Tu(0)) + ca;
+      const Tu pb = ((i < bn) ? Tu(b[i]) * q : Tu(0)) + cb;
+      const Tu d = Tu(cellType(pa)) - Tu(cellType(pb)) - borrow;
+
+      ca = pa >> cellBitCount;
+      cb = pb >> cellBitCount;
+      r[i] = cellType(d);
+      borrow = ((d >> cellBitCount) != 0) ? 1 : 0;
+    }
+
+    return borrow != 0;
+  }
 
-    for (cellType i = a.cell.size(); i > 0; i--) {
-      cellType ir = i - 1;
-      cellType c = a.cell[ir];
-
-      for (cellType j = cellBitCount; j > 0; j--) {
-        cellType jr = j - 1;
-        r <<= 1;
-
-        if (c & (1 << jr)) {
-          if (r.cell.size() == 0) {
-            r.cell.resize(1);
-            r.cell[0] = cellType(1);
-          } else {
-            r.cell[0] |= 1;
-          }
-        }
+  /**\brief Apply single-cell cofactors
+   *
+   * Sets r to A*x + B*y, where A and B do not have the same sign and the
+   * result is known not to be negative.
+   *
+   * \returns 'false' if the result turned out negative after all.
+   */
+  static bool combineCells(bigIntegers &r, const bigIntegers &x, Ts A,
+                           const bigIntegers &y, Ts B) {
+    const std::size_t n = std::max(x.cell.size(), y.cell.size()) + 1;
+    bool underflow;
+
+    r.cell.resize(n);
+    r.negative = false;
+
+    if (B <= 0) {
+      underflow = multiplySubtractCells(
+          r.cell.data(), n, x.cell.data(), x.cell.size(), cellType(A),
+          y.cell.data(), y.cell.size(), cellType(-B));
+    } else {
+      underflow = multiplySubtractCells(
+          r.cell.data(), n, y.cell.data(), y.cell.size(), cellType(B),
+          x.cell.data(), x.cell.size(), cellType(-A));
+    }
 
-        if (r >= b) {
-          r -= b;
+    r.shrink();
 
-          *this += (bigIntegers(1) << cellType(ir * cellBitCount + jr));
-        }
+    return !underflow;
+  }
+
+  /**\brief Lehmer's GCD algorithm
+   *
+   * \param[in,out] x The larger number; positive or zero.
+   * \param[in,out] y The smaller number; positive or zero.
+   *
+   * \returns The greatest common divisor of x and y.
+   */
+  static bigIntegers gcdLehmer(bigIntegers &x, bigIntegers &y) {
+    bigIntegers t, u;
+    Ts A, B, C, D;
+
+    while (y.cell.size() > cellsPerLong) {
+      if (lehmerCofactors(x, y, A, B, C, D) && combineCells(t, x, A, y, B) &&
+          combineCells(u, x, C, y, D)) {
+        std::swap(x, t);
+        std::swap(y, u);
+      } else {
+        x %= y;
+        std::swap(x, y);
       }
     }
+
+    if (y.cell.size() == 0) {
+      return x;
+    }
+
+    x %= y;
+
+    return bigIntegers(gcdP(x.toInteger(), y.toInteger(), binaryGCD()),
+                       false);
   }
 
-  void doModuloHorner(const bigIntegers &a, const cellType &b,
-                      bool allocate = true) {
-    Tu modulus = Tu(b);
-    Tu result = Tu(0);
-    const Tu factor = (Tu(1) << cellBitCount) % modulus;
+  /**\brief Apply a cofactor matrix
+   *
+   * Replaces x and y with the pair obtained by multiplying them with the
+   * matrix s, and accumulates s in m. The new pair is made positive and
+   * sorted by adjusting the rows of s, which keeps the determinant at 1
+   * or -1.
+   *
+   * \param[in,out] x The larger number.
+   * \param[in,out] y The smaller number.
+   * \param[in]     s The matrix to apply.
+   * \param[in,out] m Where to accumulate the matrices; may be 0.
+   */
+  static void applyCofactors(bigIntegers &x, bigIntegers &y, cofactors s,
+                             cofactors *m) {
+    bigIntegers nx = s.a * x + s.b * y;
+    bigIntegers ny = s.c * x + s.d * y;
 
-    for (cellType i = a.cell.size(); i > 0; i--) {
-      result *= factor;
-      result %= modulus;
-      result += (Tu(a.cell[(i - 1)]) % modulus);
-      result %= modulus;
+    if (nx.negative) {
+      nx.negative = false;
+      s.a = -std::move(s.a);
+      s.b = -std::move(s.b);
     }
 
-    cell.resize(1);
+    if (ny.negative) {
+      ny.negative = false;
+      s.c = -std::move(s.c);
+      s.d = -std::move(s.d);
+    }
 
-    cell[0] = result;
+    if (compareMagnitude(nx, ny) < 0) {
+      std::swap(nx, ny);
+      std::swap(s.a, s.c);
+      std::swap(s.b, s.d);
+    }
 
-    shrink();
-  }
+    x = std::move(nx);
+    y = std::move(ny);
 
-  void doModuloHorner(const bigIntegers &a, const bigIntegers &b,
-                      bool allocate = true) {
-    cellType q = a.cell.size() / b.cell.size();
-    cellType qm = a.cell.size() % b.cell.size();
+    if (m) {
+      cofactors r;
 
-    Tu modulus = Tu(b.cell[0]);
-    Tu result = Tu(0);
+      r.a = s.a * m->a + s.b * m->c;
+      r.b = s.a * m->b + s.b * m->d;
+      r.c = s.c * m->a + s.d * m->c;
+      r.d = s.c * m->b + s.d * m->d;
 
-    for (cellType i = 1; i < b.cell.size(); i++) {
-      modulus |= (Tu(b.cell[i]) << (i * cellBitCount));
+      *m = std::move(r);
     }
+  }
 
-    const Tu factor = (1 << (cellBitCount * b.cell.size())) % modulus;
+  /**\brief Half-GCD
+   *
+   * Reduces x and y, with x at least as large as y, until y has no more
+   * than half as many cells as x had initially, and accumulates the
+   * matrix that does so in m. Large numbers are handled recursively: the
+   * matrix for the upper halves of x and y takes the full numbers about
+   * a quarter of the way, and after one division step, the matrix for the
+   * upper halves of the result the rest of the way. Any remaining steps,
+   * and the steps for small numbers, use Lehmer's single-cell cofactors.
+   *
+   * \param[in,out] x The larger number; positive.
+   * \param[in,out] y The smaller number; not negative.
+   * \param[out]    m The matrix taking the old x and y to the new ones;
+   *                  may be 0 if it is not needed.
+   */
+  static void halfGCD(bigIntegers &x, bigIntegers &y, cofactors *m) {
+    const std::size_t n = x.cell.size();
+    const std::size_t stop = n / 2 + 1;
 
-    for (cellType j = q; j > 0; j--) {
-      Tu value;
+    if (m) {
+      *m = cofactors();
+    }
 
-      if ((j == q) && (qm > 0)) {
-        cellType i = (j - 1) * b.cell.size();
-        value = Tu(a.cell[i]);
+    if ((n >= halfGCDThreshold) && (y.cell.size() > stop)) {
+      const std::size_t k = n / 2;
+      bigIntegers xh = fromCells(x.cell.data() + k, n - k);
+      bigIntegers yh = fromCells(y.cell.data() + k, y.cell.size() - k);
+      cofactors s;
 
-        for (cellType k = 1; k < qm; k++) {
-          value |= (Tu(a.cell[(i + k)]) << (k * cellBitCount));
-        }
-      } else {
-        cellType i = (j - 1) * b.cell.size();
-        value = Tu(a.cell[i]);
+      halfGCD(xh, yh, &s);
+      applyCofactors(x, y, s, m);
 
-        for (cellType k = 1; k < b.cell.size(); k++) {
-          value |= (Tu(a.cell[(i + k)]) << (k * cellBitCount));
-        }
+      if (y.cell.size() > stop) {
+        euclidStep(x, y, m);
       }
 
-      result *= factor;
-      result %= modulus;
-      result += value % modulus;
-      result %= modulus;
-    }
+      const std::size_t l = x.cell.size();
 
-    cell.resize(b.cell.size());
+      if ((y.cell.size() > stop) && (l > stop) && (2 * stop >= l)) {
+        const std::size_t j = 2 * stop - l;
+        xh = fromCells(x.cell.data() + j, l - j);
+        yh = fromCells(y.cell.data() + j, y.cell.size() - j);
 
-    for (cellType i = 0; i < cell.size(); i++) {
-      cell[i] = result & lowMask;
-      result >>= cellBitCount;
+        halfGCD(xh, yh, &s);
+        applyCofactors(x, y, s, m);
+      }
     }
 
-    shrink();
-  }
-
-  void doModulo(const bigIntegers &a, const bigIntegers &b,
-                bool allocate = true) {
-    cell.resize(0);
-
-    for (cellType i = a.cell.size(); i > 0; i--) {
-      cellType ir = i - 1;
-      cellType c = a.cell[ir];
+    bigIntegers t, u;
 
-      for (cellType j = cellBitCount; j > 0; j--) {
-        cellType jr = j - 1;
+    while (y.cell.size() > stop) {
+      Ts A, B, C, D;
 
-        *this <<= 1;
+      if (lehmerCofactors(x, y, A, B, C, D) && combineCells(t, x, A, y, B) &&
+          combineCells(u, x, C, y, D)) {
+        std::swap(x, t);
+        std::swap(y, u);
 
-        if (c & (1 << jr)) {
-          if (cell.size() == 0) {
-            cell.resize(1);
-            cell[0] = cellType(1);
-          } else {
-            cell[0] |= 1;
-          }
-        }
+        if (m) {
+          const bigIntegers a = bigIntegers(A) * m->a + bigIntegers(B) * m->c;
+          const bigIntegers b = bigIntegers(A) * m->b + bigIntegers(B) * m->d;
 
-        if (*this >= b) {
-          *this -= b;
+          m->c = bigIntegers(C) * m->a + bigIntegers(D) * m->c;
+          m->d = bigIntegers(C) * m->b + bigIntegers(D) * m->d;
+          m->a = a;
+          m->b = b;
         }
+      } else {
+        euclidStep(x, y, m);
       }
     }
   }
+
+  /**\brief Euclidean division step
+   *
+   * Replaces x and y with y and x mod y, and updates the matrix m to
+   * match.
+   *
+   * \param[in,out] x The larger number; positive.
+   * \param[in,out] y The smaller number; positive.
+   * \param[in,out] m Where to accumulate the step; may be 0.
+   */
+  static void euclidStep(bigIntegers &x, bigIntegers &y, cofactors *m) {
+    if (m) {
+      std::pair<bigIntegers, bigIntegers> qr = x.divmod(y);
+      bigIntegers c = m->a - qr.first * m->c;
+      bigIntegers d = m->b - qr.first * m->d;
+
+      m->a = std::move(m->c);
+      m->b = std::move(m->d);
+      m->c = std::move(c);
+      m->d = std::move(d);
+
+      x = std::move(y);
+      y = std::move(qr.second);
+    } else {
+      x %= y;
+      std::swap(x, y);
+    }
+  }
 };
 
 template <typename Ts, typename Tu, typename cellType,
-          unsigned int cellBitCount>
-class traits<bigIntegers<Ts, Tu, cellType, cellBitCount>> {
+          unsigned int cellBitCount, std::size_t inlineCells>
+class traits<bigIntegers<Ts, Tu, cellType, cellBitCount, inlineCells>> {
  public:
-  typedef bigIntegers<Ts, Tu, cellType, cellBitCount> integral;
-  typedef fractional<bigIntegers<Ts, Tu, cellType, cellBitCount>> rational;
-  typedef bigIntegers<Ts, Tu, cellType, cellBitCount> self;
-  typedef bigIntegers<Ts, Tu, cellType, cellBitCount> derivable;
+  typedef bigIntegers<Ts, Tu, cellType, cellBitCount, inlineCells> integral;
+  typedef fractional<bigIntegers<Ts, Tu, cellType, cellBitCount, inlineCells>>
+      rational;
+  typedef bigIntegers<Ts, Tu, cellType, cellBitCount, inlineCells> self;
+  typedef bigIntegers<Ts, Tu, cellType, cellBitCount, inlineCells> derivable;
+  typedef lehmerGCD gcdAlgorithm;
 
   static const bool stable = true;
 };
 
+template <typename Ts, typename Tu, typename cellType,
+          unsigned int cellBitCount, std::size_t inlineCells>
+std::size_t bitLength(
+    const bigIntegers<Ts, Tu, cellType, cellBitCount, inlineCells> &v) {
+  return v.bitLength();
+}
+
 template <typename C, typename Ts, typename Tu, typename cellType,
-          unsigned int cellBitCount>
+          unsigned int cellBitCount, std::size_t inlineCells>
 std::basic_ostream<C> &operator<<(
     std::basic_ostream<C> &out,
-    const bigIntegers<Ts, Tu, cellType, cellBitCount> &pNumber) {
-  const unsigned int pBase = 10;
-  bool negative = pNumber < zero();
-  bool didOutput = false;
-  bigIntegers<Ts, Tu, cellType, cellBitCount> b = pNumber;
-
-  if (negative) {
-    b = -b;
-  }
-
-  std::string s = "";
-
-  while (b > zero()) {
-    const char t[2] = {
-        "0123456789abcdefghijklmnopqrstuvwxyz"
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ#,."[(b % bigIntegers<Ts, Tu, cellType,
-                                                         cellBitCount>(pBase))
-                                            .toInteger()],
-        0};
-    std::string tq(t);
-
-    s = tq + s;
-    b /= pBase;
-    if (!didOutput) {
-      if (negative) {
-        out << "-";
-      }
-      didOutput = true;
-    }
-  }
-
-  out << s;
-
-  if (!didOutput) {
-    out << "0";
-  }
-
-  return out;
+    const bigIntegers<Ts, Tu, cellType, cellBitCount, inlineCells> &pNumber) {
+  return out << pNumber.toChars(10);
 }
 };  // namespace numeric
 
 typedef numeric::bigIntegers<> Z;
+
+#if defined(__SIZEOF_INT128__)
+/**\brief Big integers with 64-bit cells
+ *
+ * Uses half as many cells as Z for the same number, with products of two
+ * cells in unsigned __int128 and the specialised cellArithmetic kernels.
+ * Only available with compilers that support 128-bit integers.
+ */
+typedef numeric::bigIntegers<__int128, unsigned __int128, unsigned long long,
+                             64>
+    Z64;
+#endif
 };  // namespace math
 };  // namespace efgy
 
@@ -120,6 +120,7 @@ class traits<complex<Q>> {
   typedef typename traits<Q>::rational rational;
   typedef complex<Q> self;
   typedef complex<Q> derivable;
+  typedef euclideanGCD gcdAlgorithm;
 
   static const bool stable = false;
 };
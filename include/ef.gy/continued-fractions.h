@@ -13,13 +13,34 @@
 #define EF_GY_CONTINUED_FRACTIONS_H
 
 #include <ef.gy/fractions.h>
+#include <ef.gy/vector.h>
 
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <ostream>
+#include <type_traits>
 #include <vector>
 
 namespace efgy {
 namespace math {
 namespace numeric {
+/**\brief Quotient rounded towards zero
+ *
+ * \param[in] a Dividend.
+ * \param[in] b Divisor.
+ *
+ * \returns a / b, as an integer; dividing N by N is not guaranteed to
+ *          produce one, but dividing in place is.
+ */
+template <typename N>
+N quotient(N a, const N &b) {
+  a /= b;
+  return a;
+}
+
 template <typename N>
 class continuedFractional : public numeric {
  public:
@@ -78,7 +99,7 @@ class continuedFractional : public numeric {
   }
 
   continuedFractional operator+(const continuedFractional &b) const {
-    binaryOperator op = binaryOperator::addition();
+    binaryOperator<> op = binaryOperator<>::addition();
     return op(*this, b);
   }
   continuedFractional &operator+=(const continuedFractional &b) {
@@ -86,7 +107,7 @@ class continuedFractional : public numeric {
   }
 
   continuedFractional operator-(const continuedFractional &b) const {
-    binaryOperator op = binaryOperator::subtraction();
+    binaryOperator<> op = binaryOperator<>::subtraction();
     return op(*this, b);
   }
   continuedFractional &operator-=(const continuedFractional &b) {
@@ -94,7 +115,7 @@ class continuedFractional : public numeric {
   }
 
   continuedFractional operator*(const continuedFractional &b) const {
-    binaryOperator op = binaryOperator::multiplication();
+    binaryOperator<> op = binaryOperator<>::multiplication();
     return op(*this, b);
   }
   continuedFractional &operator*=(const continuedFractional &b) {
@@ -104,7 +125,7 @@ class continuedFractional : public numeric {
   // missing: %, ^
 
   continuedFractional operator/(const continuedFractional &b) const {
-    binaryOperator op = binaryOperator::division();
+    binaryOperator<> op = binaryOperator<>::division();
     return op(*this, b);
   }
   continuedFractional &operator/=(const continuedFractional &b) {
@@ -158,8 +179,8 @@ class continuedFractional : public numeric {
 
   operator fractional<N>(void) const {
     fractional<N> rv;
-    N j = coefficient.size() - N(1);
-    for (N i = j; i >= N(0); i--) {
+    const std::size_t j = coefficient.size() - 1;
+    for (std::size_t i = coefficient.size(); i-- > 0;) {
       if (i == j) {
         rv = fractional<N>(N(coefficient[i]));
       } else {
@@ -176,161 +197,897 @@ class continuedFractional : public numeric {
   bool negative;
 
  protected:
+  /**\brief Position in the operands of a binaryOperator
+   *
+   * How many coefficients of x and y have been used, and whether the end
+   * of x and y has been reached and taken into account.
+   */
+  class cursor {
+   public:
+    std::size_t x, y;
+    bool xInf, yInf;
+  };
+
+  /**\brief Gosper's algorithm
+   *
+   * Calculates (axy + bx + cy + d) / (exy + fx + gy + h) for two continued
+   * fractions x and y.
+   *
+   * \tparam I       Integer type for the eight coefficients.
+   * \tparam checked Whether I is a machine word that may overflow. If so,
+   *                 products and sums are calculated with __int128, and
+   *                 steps whose results do not fit into I fail and leave
+   *                 the coefficients as they were. Only available where
+   *                 the compiler has __int128; elsewhere, operators use N
+   *                 right away.
+   */
+  template <typename I = N, bool checked = false>
   class binaryOperator {
    public:
     binaryOperator(void)
-        : a(N(0)),
-          b(N(0)),
-          c(N(0)),
-          d(N(0)),
-          e(N(0)),
-          f(N(0)),
-          g(N(0)),
-          h(N(0)) {}
-
-    binaryOperator(N pA, N pB, N pC, N pD, N pE, N pF, N pG, N pH)
+        : a(I(0)),
+          b(I(0)),
+          c(I(0)),
+          d(I(0)),
+          e(I(0)),
+          f(I(0)),
+          g(I(0)),
+          h(I(0)) {}
+
+    binaryOperator(I pA, I pB, I pC, I pD, I pE, I pF, I pG, I pH)
         : a(pA), b(pB), c(pC), d(pD), e(pE), f(pF), g(pG), h(pH) {}
 
+    /**\brief Apply to two continued fractions
+     *
+     * Starts out with the coefficients in a long long, which suffices for
+     * most of the run with most operands, and only continues with N once
+     * they would overflow. Without __int128, runs with N throughout.
+     *
+     * \param[in] x The first operand.
+     * \param[in] y The second operand.
+     *
+     * \returns The result of the operation.
+     */
     continuedFractional operator()(const continuedFractional &x,
                                    const continuedFractional &y) const {
       binaryOperator op = *this;
       continuedFractional rv;
-      N px = N(0), py = N(0);
-      bool xInf = false, yInf = false;
-      while (1) {
-        fractional<N> ae = fractional<N>(op.a, op.e),
-                      bf = fractional<N>(op.b, op.f),
-                      cg = fractional<N>(op.c, op.g),
-                      dh = fractional<N>(op.d, op.h);
+      cursor at = {0, 0, false, false};
 
-        N rae, rbf, rcg, rdh;
+#if defined(__SIZEOF_INT128__)
+      binaryOperator<long long, true> word;
 
-        if (op.e != zero()) {
-          rae = N(ae);
-        }
-        if (op.f != zero()) {
-          rbf = N(bf);
+      if (word.load(op)) {
+        if (word.run(x, y, rv, at)) {
+          return rv;
         }
-        if (op.g != zero()) {
-          rcg = N(cg);
+        op.load(word);
+      }
+#endif
+
+      op.run(x, y, rv, at);
+      return rv;
+    }
+
+    /**\brief Copy coefficients of a different type
+     *
+     * \param[in] op The operator to copy the coefficients of.
+     *
+     * \returns 'true' if all of the coefficients fit into I, in which case
+     *          they were copied; 'false' otherwise.
+     */
+    template <typename J, bool c>
+    bool load(const binaryOperator<J, c> &op) {
+      I t[8];
+
+      if (!convert(op.a, t[0]) || !convert(op.b, t[1]) ||
+          !convert(op.c, t[2]) || !convert(op.d, t[3]) ||
+          !convert(op.e, t[4]) || !convert(op.f, t[5]) ||
+          !convert(op.g, t[6]) || !convert(op.h, t[7])) {
+        return false;
+      }
+
+      set(t[0], t[1], t[2], t[3], t[4], t[5], t[6], t[7]);
+      return true;
+    }
+
+    /**\brief Run the algorithm
+     *
+     * \param[in]     x  The first operand.
+     * \param[in]     y  The second operand.
+     * \param[in,out] rv The coefficients of the result so far.
+     * \param[in,out] at How far along x and y the algorithm is.
+     *
+     * \returns 'true' once the result is complete, 'false' if a step would
+     *          overflow; rv, at and the coefficients then reflect the
+     *          steps before that one.
+     */
+    bool run(const continuedFractional &x, const continuedFractional &y,
+             continuedFractional &rv, cursor &at) {
+      while (1) {
+        I r;
+
+        if (integral(r)) {
+          const bool negative =
+              (a < I(0)) && (b < I(0)) && (c < I(0)) && (d < I(0));
+
+          if (!output(r)) {
+            return false;
+          }
+
+          rv = (rv, N(r));
+          if (negative) {
+            rv.negative = true;
+          }
+          continue;
         }
-        if (op.h != zero()) {
-          rdh = N(dh);
+
+        if ((e == I(0)) && (f == I(0)) && (g == I(0)) && (h == I(0))) {
+          return true;
         }
 
-        if ((op.e != zero()) && (op.f != zero()) && (op.g != zero()) &&
-            (op.h != zero())) {
-          if ((rae == rbf) && (rbf == rcg) && (rcg == rdh)) {
-            rv = (rv, rae);
-            if ((op.a < zero()) && (op.b < zero()) && (op.c < zero()) &&
-                (op.d < zero())) {
-              rv.negative = true;
+        if (at.xInf && at.yInf) {
+          if (h != I(0)) {
+            continuedFractional<N> cfdh = fractional<N>(N(d), N(h));
+            for (std::size_t i = 0; i < cfdh.coefficient.size(); i++) {
+              rv = (rv, cfdh.coefficient[i]);
             }
-            op = op.output(rae);
-            continue;
           }
+          return true;
         }
 
-        if ((op.e == zero()) && (op.f == zero()) && (op.g == zero()) &&
-            (op.h == zero())) {
-          break;
+        bool processX;
+
+        if ((f == I(0)) || (h == I(0))) {
+          processX = false;
+        } else if ((e == I(0)) || (g == I(0))) {
+          processX = true;
+        } else {
+          processX = wider();
         }
 
-        if (xInf && yInf) {
-          if (op.h != zero()) {
-            continuedFractional<N> cfdh = dh;
-            for (N i = N(0); i < cfdh.coefficient.size(); i++) {
-              rv = (rv, cfdh.coefficient[i]);
-            }
+        if (processX && at.xInf) {
+          processX = false;
+        } else if (!processX && at.yInf) {
+          processX = true;
+        }
+
+        if (processX) {
+          I p;
+          if (at.x >= x.coefficient.size()) {
+            insertXinf();
+            at.xInf = true;
+          } else if (convert(x.coefficient[at.x], p) && insertX(p)) {
+            at.x++;
+          } else {
+            return false;
+          }
+        } else {
+          I q;
+          if (at.y >= y.coefficient.size()) {
+            insertYinf();
+            at.yInf = true;
+          } else if (convert(y.coefficient[at.y], q) && insertY(q)) {
+            at.y++;
+          } else {
+            return false;
           }
-          break;
         }
+      }
+    }
+
+    static binaryOperator addition(void) {
+      return binaryOperator(0, 1, 1, 0, 1, 0, 0, 0);
+    }
+
+    static binaryOperator subtraction(void) {
+      return binaryOperator(0, 1, -1, 0, 1, 0, 0, 0);
+    }
+
+    static binaryOperator multiplication(void) {
+      return binaryOperator(0, 0, 0, 1, 1, 0, 0, 0);
+    }
+
+    static binaryOperator division(void) {
+      return binaryOperator(0, 1, 0, 0, 0, 0, 1, 0);
+    }
+
+   protected:
+    template <typename J, bool c>
+    friend class binaryOperator;
+
+    I a, b, c, d, e, f, g, h;
+
+    /**\brief Integer part, if known
+     *
+     * Divides each of the four pairs of coefficients at most once, and
+     * stops at the first quotient that differs from the others.
+     *
+     * \param[out] r Where to write the integer part to.
+     *
+     * \returns 'true' if all four quotients are the same.
+     */
+    bool integral(I &r) const {
+      if ((e == I(0)) || (f == I(0)) || (g == I(0)) || (h == I(0))) {
+        return false;
+      }
+
+      r = quotient(a, e);
+      return (quotient(b, f) == r) && (quotient(c, g) == r) &&
+             (quotient(d, h) == r);
+    }
+
+    /**\brief Which operand to take a coefficient from
+     *
+     * \returns 'true' if |b/f - a/e| > |c/g - a/e|, which is compared as
+     *          |be - af| |g| > |ce - ag| |f| so that there is no need to
+     *          divide; the two products have up to 190 bits with checked
+     *          coefficients, and are compared in parts.
+     */
+    bool wider(void) const {
+      if constexpr (checked) {
+#if defined(__SIZEOF_INT128__)
+        typedef unsigned __int128 wide;
+        const wide p = magnitude((__int128)(b)*e - (__int128)(a)*f),
+                   q = magnitude((__int128)(c)*e - (__int128)(a)*g),
+                   mg = magnitude(g), mf = magnitude(f),
+                   pl = wide((unsigned long long)(p)) * mg,
+                   ql = wide((unsigned long long)(q)) * mf,
+                   ph = (p >> 64) * mg + (pl >> 64),
+                   qh = (q >> 64) * mf + (ql >> 64);
+
+        return ph != qh ? ph > qh
+                        : (unsigned long long)(pl) > (unsigned long long)(ql);
+#else
+        static_assert(!checked, "checked coefficients need __int128");
+#endif
+      } else {
+        return magnitude(b * e - a * f) * magnitude(g) >
+               magnitude(c * e - a * g) * magnitude(f);
+      }
+    }
 
-        fractional<N> bfae = bf - ae;
-        fractional<N> cgae = cg - ae;
+    template <typename T>
+    static T magnitude(const T &v) {
+      return v < T(0) ? -v : v;
+    }
 
-        if (bfae < zero()) {
-          bfae *= N(-1);
+    /**\brief Convert between coefficient types
+     *
+     * \param[in]  v The value to convert.
+     * \param[out] r Where to write the converted value to.
+     *
+     * \returns 'false' if v does not fit into a checked I, or is the
+     *          minimum of I, which affine() never produces either.
+     */
+    template <typename J>
+    static bool convert(const J &v, I &r) {
+      if constexpr (!checked) {
+        r = I(v);
+      } else if constexpr (std::is_integral<J>::value) {
+        const auto max = std::numeric_limits<I>::max();
+        if constexpr (std::is_unsigned<J>::value) {
+          if (v > (unsigned long long)(max)) {
+            return false;
+          }
+        } else if ((v > max) || (v < -max)) {
+          return false;
         }
-        if (cgae < zero()) {
-          cgae *= N(-1);
+        r = I(v);
+      } else {
+        if (v.bitLength() >= std::numeric_limits<I>::digits) {
+          return false;
         }
+        r = I(v.toSignedInteger());
+      }
+      return true;
+    }
 
-        if ((op.f == zero()) || (op.h == zero())) {
-          goto processY;
+    /**\brief Set r to x * p + y
+     *
+     * \returns 'false' if the result does not fit into a checked I. Only
+     *          the range of -max to max is used, so that the quotients in
+     *          integral() cannot overflow.
+     */
+    static bool affine(I &r, const I &x, const I &p, const I &y) {
+      if constexpr (checked) {
+#if defined(__SIZEOF_INT128__)
+        const __int128 t = (__int128)(x)*p + y;
+        if ((t > std::numeric_limits<I>::max()) ||
+            (t < -std::numeric_limits<I>::max())) {
+          return false;
         }
-        if ((op.e == zero()) || (op.g == zero())) {
-          goto processX;
+        r = I(t);
+#else
+        static_assert(!checked, "checked coefficients need __int128");
+#endif
+      } else {
+        r = x * p + y;
+      }
+      return true;
+    }
+
+    bool insertX(const I &P) {
+      I t[4];
+      if (!affine(t[0], b, P, a) || !affine(t[1], d, P, c) ||
+          !affine(t[2], f, P, e) || !affine(t[3], h, P, g)) {
+        return false;
+      }
+      set(b, t[0], d, t[1], f, t[2], h, t[3]);
+      return true;
+    }
+
+    void insertXinf(void) { set(a, b, a, b, e, f, e, f); }
+
+    bool insertY(const I &Q) {
+      I t[4];
+      if (!affine(t[0], c, Q, a) || !affine(t[1], d, Q, b) ||
+          !affine(t[2], g, Q, e) || !affine(t[3], h, Q, f)) {
+        return false;
+      }
+      set(c, d, t[0], t[1], g, h, t[2], t[3]);
+      return true;
+    }
+
+    void insertYinf(void) { set(c, d, c, d, g, h, g, h); }
+
+    bool output(const I &R) {
+      I t[4];
+      if (!affine(t[0], e, -R, a) || !affine(t[1], f, -R, b) ||
+          !affine(t[2], g, -R, c) || !affine(t[3], h, -R, d)) {
+        return false;
+      }
+      set(e, f, g, h, t[0], t[1], t[2], t[3]);
+      return true;
+    }
+
+    void set(I pA, I pB, I pC, I pD, I pE, I pF, I pG, I pH) {
+      a = pA;
+      b = pB;
+      c = pC;
+      d = pD;
+      e = pE;
+      f = pF;
+      g = pG;
+      h = pH;
+    }
+  };
+};
+
+/**\brief Lazily evaluated continued fraction
+ *
+ * A regular continued fraction, [a0; a1, a2, ...] with an arbitrary a0 and
+ * positive coefficients after that, whose coefficients come from a
+ * generator. Each coefficient is generated the first time it is asked for
+ * and remembered afterwards; copies share the coefficients generated so
+ * far.
+ *
+ * The arithmetic operators run Gosper's algorithm on the coefficients of
+ * their operands as they are needed, so the result of a + b produces one
+ * coefficient at a time and only consumes as much of a and b as it takes
+ * to determine it. This allows exact arithmetic with irrational numbers
+ * like e and the square root of two, up to whatever precision is then
+ * requested with convergent() or approximation().
+ *
+ * Gosper's algorithm cannot determine the coefficients of results that
+ * are rational, but only known through irrational operands, e.g. the
+ * square root of two times itself. After consuming patience terms of its
+ * operands without producing a coefficient, an operator treats the
+ * operands as if they had ended, which ends the result with a rational
+ * approximation of its value rather than the exact one. exact() tells
+ * whether that has happened.
+ *
+ * \tparam N        Integer type of the coefficients.
+ * \tparam patience How many terms of their operands the operators may
+ *                  consume per coefficient of their result before they
+ *                  give up and approximate.
+ */
+template <typename N, std::size_t patience = 256>
+class lazyContinuedFractional : public numeric {
+ public:
+  typedef N integer;
+
+  /**\brief Coefficient generator
+   *
+   * Called with a reference to write the next coefficient to; returns
+   * 'false' once there are no more coefficients.
+   */
+  typedef std::function<bool(N &)> generator;
+
+  lazyContinuedFractional(void) : lazyContinuedFractional(N(0)) {}
+
+  lazyContinuedFractional(const N &t)
+      : lazyContinuedFractional(fractional<N>(t)) {}
+
+  lazyContinuedFractional(const fractional<N> &f)
+      : lazyContinuedFractional(generator(euclid(f.numerator, f.denominator))) {
+  }
+
+  /**\brief Convert an eagerly evaluated continued fraction
+   *
+   * \param[in] cf The continued fraction to convert; its coefficients are
+   *               used as they are, and its sign applied afterwards.
+   */
+  lazyContinuedFractional(const continuedFractional<N> &cf)
+      : lazyContinuedFractional(generator(sequence(cf.coefficient))) {
+    if (cf.negative) {
+      *this = -*this;
+    }
+  }
+
+  /**\brief Construct with a generator
+   *
+   * \param[in] g Produces the coefficients, in order, when called.
+   */
+  explicit lazyContinuedFractional(generator g)
+      : state(std::make_shared<stream>(g)) {}
+
+  lazyContinuedFractional operator+(const lazyContinuedFractional &b) const {
+    return combine(b, N(0), N(1), N(1), N(0), N(0), N(0), N(0), N(1));
+  }
+
+  lazyContinuedFractional operator-(const lazyContinuedFractional &b) const {
+    return combine(b, N(0), N(1), N(-1), N(0), N(0), N(0), N(0), N(1));
+  }
+
+  lazyContinuedFractional operator*(const lazyContinuedFractional &b) const {
+    return combine(b, N(1), N(0), N(0), N(0), N(0), N(0), N(0), N(1));
+  }
+
+  lazyContinuedFractional operator/(const lazyContinuedFractional &b) const {
+    return combine(b, N(0), N(1), N(0), N(0), N(0), N(0), N(1), N(0));
+  }
+
+  lazyContinuedFractional operator-(void) const {
+    return lazyContinuedFractional(N(0)) - *this;
+  }
+
+  /**\brief Get a coefficient
+   *
+   * Runs the generator until the coefficient is known, if necessary.
+   *
+   * \param[in]  i Index of the coefficient, starting at 0 for a0.
+   * \param[out] r Where to write the coefficient to.
+   *
+   * \returns 'false' if the continued fraction has fewer coefficients,
+   *          'true' otherwise.
+   */
+  bool at(std::size_t i, N &r) const {
+    stream &s = *state;
+
+    while ((s.coefficient.size() <= i) && s.next) {
+      N t;
+
+      if (s.next(t)) {
+        s.coefficient.push_back(t);
+      } else {
+        s.next = generator();
+      }
+    }
+
+    if (i < s.coefficient.size()) {
+      r = s.coefficient[i];
+      return true;
+    }
+
+    return false;
+  }
+
+  /**\brief Whether the coefficients are exact
+   *
+   * Only covers the coefficients generated so far, e.g. by at() or
+   * convergent(); an operator that runs out of patience later on may
+   * still end the continued fraction with an approximation.
+   *
+   * \returns 'false' if an operator, for this continued fraction or for
+   *          one of the operands it was calculated from, ran out of
+   *          patience and replaced the rest with an approximation;
+   *          'true' otherwise.
+   */
+  bool exact(void) const { return !state->truncated; }
+
+  /**\brief Convergent
+   *
+   * \param[in] n Index of the last coefficient to use.
+   *
+   * \returns The value of [a0; a1, ..., an], or of the whole continued
+   *          fraction if it has fewer coefficients.
+   */
+  fractional<N> convergent(std::size_t n) const {
+    N p = N(1), q = N(0), pp = N(0), pq = N(1), a;
+
+    for (std::size_t i = 0; (i <= n) && at(i, a); i++) {
+      next(p, pp, a);
+      next(q, pq, a);
+    }
+
+    return fractional<N>(p, q);
+  }
+
+  /**\brief Approximate to a given precision
+   *
+   * \param[in] precision Reciprocal of the largest acceptable error.
+   *
+   * \returns The first convergent that is within 1/precision of the
+   *          value of the continued fraction, which is also the one with
+   *          the smallest denominator among these convergents.
+   */
+  fractional<N> approximation(const N &precision) const {
+    N p = N(1), q = N(0), pp = N(0), pq = N(1), a;
+
+    for (std::size_t i = 0; at(i, a); i++) {
+      next(p, pp, a);
+      next(q, pq, a);
+
+      // the error of p/q is below 1 / (q * q'), with q' the next denominator
+      if (at(i + 1, a) && (q * (a * q + pq) < precision)) {
+        continue;
+      }
+
+      break;
+    }
+
+    return fractional<N>(p, q);
+  }
+
+  /**\brief Euler's number
+   *
+   * \returns e = [2; 1, 2, 1, 1, 4, 1, 1, 6, ...].
+   */
+  static lazyContinuedFractional eulersNumber(void) {
+    std::size_t i = 0;
+
+    return lazyContinuedFractional(generator([i](N &r) mutable {
+      r = i == 0 ? N(2) : (i % 3 == 2 ? N(2 * (i + 1) / 3) : N(1));
+      i++;
+      return true;
+    }));
+  }
+
+  /**\brief Square root
+   *
+   * Generates the periodic continued fraction of the square root of a
+   * non-negative integer, which ends right away for perfect squares.
+   *
+   * \param[in] n The number to take the square root of.
+   *
+   * \returns The square root of n.
+   */
+  static lazyContinuedFractional squareRoot(const N &n) {
+    const N root = integerRoot(n);
+    N m = N(0), d = N(1), a = root;
+    bool first = true;
+
+    return lazyContinuedFractional(
+        generator([n, root, m, d, a, first](N &r) mutable {
+          if (first) {
+            first = false;
+          } else if (root * root == n) {
+            return false;
+          } else {
+            m = d * a - m;
+            d = quotient(n - m * m, d);
+            a = quotient(root + m, d);
+          }
+
+          r = a;
+          return true;
+        }));
+  }
+
+ protected:
+  /**\brief Shared coefficients
+   *
+   * The coefficients generated so far, and the generator for the rest,
+   * which is cleared when it has no more coefficients.
+   */
+  class stream {
+   public:
+    stream(generator pNext) : coefficient(), next(pNext), truncated(false) {}
+
+    std::vector<N> coefficient;
+    generator next;
+
+    /**\brief Whether the coefficients end with an approximation */
+    bool truncated;
+  };
+
+  std::shared_ptr<stream> state;
+
+  /**\brief Apply Gosper's algorithm
+   *
+   * Creates the result first, so that the operator can flag it as
+   * truncated in its stream, which outlives the operator.
+   *
+   * \param[in] b The second operand.
+   *
+   * \returns The continued fraction of (axy + bx + cy + d) /
+   *          (exy + fx + gy + h), where x is this and y is b.
+   */
+  lazyContinuedFractional combine(const lazyContinuedFractional &b, N pA,
+                                  N pB, N pC, N pD, N pE, N pF, N pG,
+                                  N pH) const {
+    lazyContinuedFractional rv{generator()};
+    rv.state->next = binaryOperator(*this, b, pA, pB, pC, pD, pE, pF, pG, pH,
+                                    rv.state->truncated);
+    return rv;
+  }
+
+  /**\brief Quotient rounded towards negative infinity
+   *
+   * \param[in] a Dividend.
+   * \param[in] b Divisor.
+   *
+   * \returns The largest integer not above a / b.
+   */
+  static N floor(const N &a, const N &b) {
+    N r = quotient(a, b);
+
+    if ((r * b != a) && ((a < N(0)) != (b < N(0)))) {
+      r = r - N(1);
+    }
+
+    return r;
+  }
+
+  static N magnitude(const N &a) { return a < N(0) ? -a : a; }
+
+  /**\brief Integer square root
+   *
+   * \param[in] n A non-negative integer.
+   *
+   * \returns The largest integer whose square is not above n.
+   */
+  static N integerRoot(const N &n) {
+    if (n < N(2)) {
+      return n;
+    }
+
+    N x = n, y = quotient(x + N(1), N(2));
+
+    while (y < x) {
+      x = y;
+      y = quotient(x + quotient(n, x), N(2));
+    }
+
+    return x;
+  }
+
+  /**\brief Continuant recurrence
+   *
+   * \param[in,out] c  The latest numerator or denominator of a convergent.
+   * \param[in,out] pc The one before that.
+   * \param[in]     a  The next coefficient.
+   */
+  static void next(N &c, N &pc, const N &a) {
+    const N t = a * c + pc;
+    pc = c;
+    c = t;
+  }
+
+  /**\brief Euclidean algorithm
+   *
+   * Generates the coefficients of the fraction p/q.
+   */
+  class euclid {
+   public:
+    euclid(const N &pP, const N &pQ) : p(pP), q(pQ) {}
+
+    bool operator()(N &r) {
+      if (q == N(0)) {
+        return false;
+      }
+
+      r = floor(p, q);
+      const N t = p - r * q;
+      p = q;
+      q = t;
+      return true;
+    }
+
+   protected:
+    N p, q;
+  };
+
+  /**\brief Fixed coefficients
+   *
+   * Generates the coefficients in a vector.
+   */
+  class sequence {
+   public:
+    sequence(const std::vector<N> &pCoefficient)
+        : coefficient(pCoefficient), i(0) {}
+
+    bool operator()(N &r) {
+      if (i >= coefficient.size()) {
+        return false;
+      }
+
+      r = coefficient[i++];
+      return true;
+    }
+
+   protected:
+    std::vector<N> coefficient;
+    std::size_t i;
+  };
+
+  /**\brief Gosper's algorithm
+   *
+   * Generates the coefficients of
+   *
+   *     z = (axy + bx + cy + d) / (exy + fx + gy + h)
+   *
+   * by taking in coefficients of x and y, which turns x into the rest of
+   * the continued fraction of x, and likewise for y, and putting out the
+   * integer part of z whenever all the values that z may still have share
+   * it. The rest of x and of y is at least one once their first
+   * coefficients are in, so these are the values at the corners of
+   * [0, inf] x [0, inf], unless the denominator has a zero in there.
+   *
+   * Sets the truncated flag it is given when it runs out of patience, or
+   * when either operand has, as the result is then an approximation.
+   */
+  class binaryOperator {
+   public:
+    binaryOperator(const lazyContinuedFractional &pX,
+                   const lazyContinuedFractional &pY, N pA, N pB, N pC, N pD,
+                   N pE, N pF, N pG, N pH, bool &pTruncated)
+        : x(pX),
+          y(pY),
+          px(0),
+          py(0),
+          xEnded(false),
+          yEnded(false),
+          a(pA),
+          b(pB),
+          c(pC),
+          d(pD),
+          e(pE),
+          f(pF),
+          g(pG),
+          h(pH),
+          truncated(pTruncated) {}
+
+    bool operator()(N &r) {
+      const bool rv = step(r);
+
+      if (!x.exact() || !y.exact()) {
+        truncated = true;
+      }
+
+      return rv;
+    }
+
+   protected:
+    lazyContinuedFractional x, y;
+    std::size_t px, py;
+    bool xEnded, yEnded;
+    N a, b, c, d, e, f, g, h;
+    bool &truncated;
+
+    /**\brief Generate a coefficient
+     *
+     * \param[out] r Where to write the coefficient to.
+     *
+     * \returns 'false' if there are no more coefficients.
+     */
+    bool step(N &r) {
+      for (std::size_t i = 0;; i++) {
+        if (integral(r)) {
+          output(r);
+          return true;
         }
 
-        if (bfae > cgae) {
-        processX:
-          if (px < x.coefficient.size()) {
-            op = op.insertX(x.coefficient[px]);
+        if ((h == N(0)) && (xEnded || (f == N(0))) &&
+            (yEnded || (g == N(0))) &&
+            (xEnded || yEnded || (e == N(0)))) {
+          return false;
+        }
+
+        if (i >= patience) {
+          truncated = truncated || !xEnded || !yEnded;
+          endX();
+          endY();
+        } else if (!xEnded && (yEnded || preferX())) {
+          N t;
+          if (x.at(px, t)) {
             px++;
-          } else if (!xInf) {
-            op = op.insertXinf();
-            xInf = true;
+            insertX(t);
           } else {
-            goto processY;
+            endX();
           }
         } else {
-        processY:
-          if (py < y.coefficient.size()) {
-            op = op.insertY(y.coefficient[py]);
+          N t;
+          if (y.at(py, t)) {
             py++;
-          } else if (!yInf) {
-            op = op.insertYinf();
-            yInf = true;
+            insertY(t);
           } else {
-            goto processX;
+            endY();
           }
         }
       }
-      return rv;
     }
 
-    binaryOperator insertX(N P) const {
-      return binaryOperator(b, a + b * P, d, c + d * P, f, e + f * P, h,
-                            g + h * P);
-    }
+    /**\brief Integer part, if known
+     *
+     * \param[out] r Where to write the integer part of z to.
+     *
+     * \returns 'true' if all the corners that are still relevant have a
+     *          denominator of the same sign, and the same integer part.
+     */
+    bool integral(N &r) const {
+      if ((!xEnded && (px == 0)) || (!yEnded && (py == 0))) {
+        return false;
+      }
 
-    binaryOperator insertXinf() const {
-      return binaryOperator(a, b, a, b, e, f, e, f);
+      if (h == N(0)) {
+        return false;
+      }
+
+      const bool negative = h < N(0);
+      r = floor(d, h);
+
+      return (xEnded || corner(b, f, negative, r)) &&
+             (yEnded || corner(c, g, negative, r)) &&
+             (xEnded || yEnded || corner(a, e, negative, r));
     }
 
-    binaryOperator insertY(N Q) const {
-      return binaryOperator(c, d, a + c * Q, b + d * Q, g, h, e + g * Q,
-                            f + h * Q);
+    static bool corner(const N &n, const N &m, bool negative, const N &r) {
+      return (m != N(0)) && ((m < N(0)) == negative) && (floor(n, m) == r);
     }
 
-    binaryOperator insertYinf() const {
-      return binaryOperator(c, d, c, d, g, h, g, h);
+    /**\brief Which operand to take a coefficient from
+     *
+     * \returns 'true' if the corners of z are further apart along x than
+     *          along y, or if that is not known and x is behind y.
+     */
+    bool preferX(void) const {
+      if ((e == N(0)) || (f == N(0)) || (g == N(0))) {
+        return px <= py;
+      }
+
+      // |a/e - c/g| > |a/e - b/f|, without the division
+      return magnitude(a * g - c * e) * magnitude(f) >
+             magnitude(a * f - b * e) * magnitude(g);
     }
 
-    binaryOperator output(N R) const {
-      return binaryOperator(e, f, g, h, a - e * R, b - f * R, c - g * R,
-                            d - h * R);
+    void insertX(const N &p) {
+      set(a * p + c, b * p + d, a, b, e * p + g, f * p + h, e, f);
     }
 
-    static binaryOperator addition(void) {
-      return binaryOperator(0, 1, 1, 0, 1, 0, 0, 0);
+    void insertY(const N &q) {
+      set(a * q + b, a, c * q + d, c, e * q + f, e, g * q + h, g);
     }
 
-    static binaryOperator subtraction(void) {
-      return binaryOperator(0, 1, -1, 0, 1, 0, 0, 0);
+    void endX(void) {
+      if (!xEnded) {
+        set(N(0), N(0), a, b, N(0), N(0), e, f);
+        xEnded = true;
+      }
     }
 
-    static binaryOperator multiplication(void) {
-      return binaryOperator(0, 0, 0, 1, 1, 0, 0, 0);
+    void endY(void) {
+      if (!yEnded) {
+        set(N(0), a, N(0), c, N(0), e, N(0), g);
+        yEnded = true;
+      }
     }
 
-    static binaryOperator division(void) {
-      return binaryOperator(0, 1, 0, 0, 0, 0, 1, 0);
+    void output(const N &r) {
+      set(e, f, g, h, a - e * r, b - f * r, c - g * r, d - h * r);
     }
 
-   protected:
-    N a, b, c, d, e, f, g, h;
+    void set(N pA, N pB, N pC, N pD, N pE, N pF, N pG, N pH) {
+      a = pA;
+      b = pB;
+      c = pC;
+      d = pD;
+      e = pE;
+      f = pF;
+      g = pG;
+      h = pH;
+    }
   };
 };
 
@@ -352,10 +1109,160 @@ fractional<N> round(const fractional<N> &pQ,
   return q;
 }
 
+/**\brief Best rational approximation
+ *
+ * Finds the fraction closest to x among those with a denominator of at
+ * most maxDenominator. Walks the continued fraction of x up to the last
+ * convergent within the bound, then compares that convergent with the
+ * largest semiconvergent that is also within the bound; one of the two is
+ * the answer.
+ *
+ * \tparam N Integer type of the fraction.
+ *
+ * \param[in] x              The fraction to approximate.
+ * \param[in] maxDenominator The largest denominator to allow; values
+ *                           below one are treated as one.
+ *
+ * \returns The closest fraction with a denominator of at most
+ *          maxDenominator; of two equally close ones, the one with the
+ *          smaller denominator.
+ */
+template <typename N>
+fractional<N> bestApproximation(const fractional<N> &x,
+                                const N &maxDenominator) {
+  const N max = maxDenominator < N(1) ? N(1) : maxDenominator;
+  const lazyContinuedFractional<N> cf(x);
+  N p0 = N(0), q0 = N(1), p1 = N(1), q1 = N(0), a;
+
+  for (std::size_t i = 0; cf.at(i, a); i++) {
+    const N q2 = q0 + a * q1;
+
+    if (q2 > max) {
+      const N k = quotient(max - q0, q1);
+      const fractional<N> convergent(p1, q1),
+          semiconvergent(p0 + k * p1, q0 + k * q1);
+      fractional<N> dc = convergent - x, ds = semiconvergent - x;
+
+      if (dc.numerator < N(0)) {
+        dc *= N(-1);
+      }
+      if (ds.numerator < N(0)) {
+        ds *= N(-1);
+      }
+
+      return ds < dc ? semiconvergent : convergent;
+    }
+
+    const N p2 = p0 + a * p1;
+    p0 = p1;
+    q0 = q1;
+    p1 = p2;
+    q1 = q2;
+  }
+
+  return fractional<N>(p1, q1);
+}
+
+/**\brief Best rational approximation of a floating point number
+ *
+ * Converts x to a fraction of big integers, which is exact since x is a
+ * multiple of a power of two, and approximates that.
+ *
+ * \tparam N Integer type of the fraction.
+ * \tparam T Floating point type of x.
+ *
+ * \param[in] x              The number to approximate; zero is used in
+ *                           place of infinities and NaNs.
+ * \param[in] maxDenominator The largest denominator to allow.
+ *
+ * \returns The closest fraction with a denominator of at most
+ *          maxDenominator.
+ */
+template <typename N, typename T>
+typename std::enable_if<std::is_floating_point<T>::value,
+                        fractional<N>>::type
+bestApproximation(const T &x, const N &maxDenominator) {
+  if (!std::isfinite(x)) {
+    return fractional<N>(N(0));
+  }
+
+  int exponent;
+  const T m = std::frexp(x, &exponent);
+  const int digits = std::numeric_limits<T>::digits;
+  Z numerator((unsigned long long)(std::ldexp(std::fabs(m), digits)), false);
+  Z denominator(1);
+
+  // shifting small big integers drops their sign, so negate afterwards
+  exponent -= digits;
+  if (exponent > 0) {
+    numerator <<= (unsigned int)(exponent);
+  } else {
+    denominator <<= (unsigned int)(-exponent);
+  }
+  if (m < 0) {
+    numerator = -numerator;
+  }
+
+  if constexpr (std::is_integral<N>::value) {
+    const fractional<Z> r =
+        bestApproximation(fractional<Z>(numerator, denominator),
+                          Z((long long)(maxDenominator)));
+    return fractional<N>(N(r.numerator.toSignedInteger()),
+                         N(r.denominator.toSignedInteger()));
+  } else {
+    const fractional<Z> r = bestApproximation(
+        fractional<Z>(numerator, denominator), Z(maxDenominator));
+    return fractional<N>(N(r.numerator), N(r.denominator));
+  }
+}
+
+/**\brief Best rational approximations of a vector
+ *
+ * \tparam N      Integer type of the fractions.
+ * \tparam n      Number of coordinates.
+ * \tparam format Coordinate format tag.
+ *
+ * \param[in] v              The vector to approximate.
+ * \param[in] maxDenominator The largest denominator to allow.
+ *
+ * \returns A vector with the best approximation of each coordinate of v.
+ */
+template <typename N, unsigned int n, typename format>
+vector<fractional<N>, n, format> bestApproximation(
+    const vector<fractional<N>, n, format> &v, const N &maxDenominator) {
+  vector<fractional<N>, n, format> rv = v;
+
+  for (fractional<N> &c : rv) {
+    c = bestApproximation(c, maxDenominator);
+  }
+
+  return rv;
+}
+
+/**\brief Best rational approximations of a batch of vectors
+ *
+ * Replaces the coordinates of all the vectors in a range, e.g. the
+ * vertices of a mesh, with their best approximations.
+ *
+ * \tparam I Iterator type; its values are math::vector instances of
+ *           fractions of N.
+ * \tparam N Integer type of the fractions.
+ *
+ * \param[in] begin          Start of the range.
+ * \param[in] end            End of the range.
+ * \param[in] maxDenominator The largest denominator to allow.
+ */
+template <typename I, typename N>
+void bestApproximation(I begin, I end, const N &maxDenominator) {
+  for (I i = begin; i != end; ++i) {
+    *i = bestApproximation(*i, maxDenominator);
+  }
+}
+
 template <typename C, typename N>
 std::basic_ostream<C> &operator<<(std::basic_ostream<C> &out,
                                   const continuedFractional<N> &f) {
-  if (f.coefficient.size() == N(0)) {
+  if (f.coefficient.size() == 0) {
     return out << "[ 0 ]";
   }
 
@@ -363,10 +1270,10 @@ std::basic_ostream<C> &operator<<(std::basic_ostream<C> &out,
     out << "- ";
   }
   out << "[";
-  for (N i = N(0); i < f.coefficient.size(); i++) {
-    if (i == N(0)) {
+  for (std::size_t i = 0; i < f.coefficient.size(); i++) {
+    if (i == 0) {
       out << " " << f.coefficient[i];
-    } else if (i == N(1)) {
+    } else if (i == 1) {
       out << "; " << f.coefficient[i];
     } else {
       out << ", " << f.coefficient[i];
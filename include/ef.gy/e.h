@@ -16,9 +16,13 @@
 #if !defined(EF_GY_E_H)
 #define EF_GY_E_H
 
+#include <ef.gy/exponential.h>
 #include <ef.gy/factorial.h>
 #include <ef.gy/series.h>
 
+#include <cstddef>
+#include <type_traits>
+
 namespace efgy {
 namespace math {
 namespace algorithm {
@@ -32,6 +36,13 @@ namespace algorithm {
  */
 template <typename Q, typename N>
 class powerSeriesE {
+ protected:
+  /**\brief The base data type's integer type
+   *
+   * Used to make sure that type casts work as intended.
+   */
+  typedef typename numeric::traits<Q>::integral integer;
+
  public:
   /**\copydoc bailey1997::defaultSeriesIterations */
   static const N defaultSeriesIterations = 10;
@@ -41,20 +52,75 @@ class powerSeriesE {
    * Calculates a single member of the sequence used to
    * calculate the exponential function.
    *
+   * Built-in integers overflow at 21!, so if that's what Q uses, the
+   * factorial is calculated with Q itself. Otherwise the factorials of the
+   * first few members come from the memoised table, since series that are
+   * evaluated repeatedly keep asking for those.
+   *
    * \param[in] n The sequence member to calculate.
    *
    * \returns The sequence member that was to be calculated.
    */
   static constexpr Q at(const N &n) {
-    return Q(1) / Q(factorial<integer>(integer(n)));
+    if constexpr (std::is_integral<integer>::value) {
+      Q r = Q(1);
+
+      for (N k = 2; k <= n; k++) {
+        r *= Q(k);
+      }
+
+      return Q(1) / r;
+    } else {
+      return Q(1) / Q(factorial<integer>::cached(std::size_t(n)));
+    }
   }
 
- protected:
-  /**\brief The base data type's integer type
+  /**\brief Get next sequence member
    *
-   * Used to make sure that type casts work as intended.
+   * Calculates a member of the sequence from the previous one, which
+   * only needs a single division instead of a whole factorial.
+   *
+   * \param[in] previous The sequence member before the one to calculate.
+   * \param[in] n        The sequence member to calculate.
+   *
+   * \returns The sequence member that was to be calculated.
    */
-  typedef typename numeric::traits<Q>::integral integer;
+  static constexpr Q next(const Q &previous, const N &n) {
+    return previous / Q(n);
+  }
+
+  /**\brief Bound the error
+   *
+   * Uses (n+1)! > ((n+1)/e)^(n+1), with 68/25 in place of e, to bound the
+   * first member left out without calculating a factorial. Once that
+   * member is less than half the previous one, the rest of the members
+   * add up to less than the member itself. Before that, the Lagrange
+   * form of the remainder gives a bound, with 3^(|d|+1) in place of
+   * e^|d|.
+   *
+   * \param[in] n Index of the last member in the sum.
+   * \param[in] d Power factor minus centre.
+   *
+   * \returns An upper bound for the error of the sum up to the nth member.
+   */
+  static constexpr Q tail(const N &n, const Q &d) {
+    const Q a = Q(0) > d ? Q(0) - d : d;
+    const Q m = exponentiate::integral<Q>::raise(
+        Q(68) * a / (Q(25) * Q(n + N(1))), integer(n + N(1)));
+
+    const Q b = exponentiate::integral<Q>::raise(Q(3), integer(a) + integer(1));
+
+    return Q(n + N(2)) > Q(2) * a ? Q(2) * m : b * m;
+  }
+
+  /**\copydoc bailey1997::termRatio
+   *
+   * Each member is the previous one divided by n.
+   */
+  static series::ratio<integer> termRatio(const N &n) {
+    return {integer(1), n == N(0) ? integer(1) : integer(n), integer(1),
+            integer(1)};
+  }
 };
 };  // namespace algorithm
 
@@ -86,8 +152,9 @@ class powerSeriesE {
  *
  * \see For more details, see math::pi.
  */
-template <typename Q, typename N = unsigned long long>
-using e = series::power<Q, algorithm::powerSeriesE, N>;
+template <typename Q, typename N = unsigned long long,
+          typename summation = series::termwise>
+using e = series::power<Q, algorithm::powerSeriesE, N, summation>;
 };  // namespace math
 };  // namespace efgy
 
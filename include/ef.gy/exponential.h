@@ -21,6 +21,10 @@
 
 #include <ef.gy/traits.h>
 
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
 namespace efgy {
 namespace math {
 /**\brief Templates to calculate exponential values
@@ -29,6 +33,89 @@ namespace math {
  * specified powers.
  */
 namespace exponentiate {
+/**\brief Window size for sliding window exponentiation
+ *
+ * The usual thresholds: the windows get one bit wider whenever the
+ * multiplications that they save outweigh the larger table of odd powers.
+ *
+ * \param[in] n The number of bits in the exponent.
+ *
+ * \return How many bits of the exponent to process at once.
+ */
+constexpr unsigned int windowSize(std::size_t n) {
+  return n > 671 ? 6 : n > 239 ? 5 : n > 79 ? 4 : n > 23 ? 3 : 1;
+}
+
+/**\brief Sliding window exponentiation
+ *
+ * Raises base to a power given as a sequence of bits, processing the
+ * exponent from the most significant bit down. Runs of zero bits only
+ * square the result, and everything else is split into windows that end
+ * in a one bit, each of which is handled with one multiplication by an
+ * odd power of the base from a precomputed table. Compared to plain
+ * square-and-multiply, this saves most of the multiplications for long
+ * exponents.
+ *
+ * The multiplication is passed in so that modular arithmetic can use the
+ * same algorithm with its own reduction.
+ *
+ * \tparam Q        The type of the base and the result.
+ * \tparam bit      Functor that returns bit i of the exponent.
+ * \tparam multiply Functor that multiplies two Q values.
+ *
+ * \param[in] base  The number to raise.
+ * \param[in] n     The number of bits in the exponent; positive, and the
+ *                  bit n-1 must be set.
+ * \param[in] b     Access to the bits of the exponent.
+ * \param[in] m     The multiplication to use.
+ *
+ * \return base raised to the power given by the bits.
+ */
+template <typename Q, typename bit, typename multiply>
+Q slidingWindow(const Q &base, std::size_t n, const bit &b,
+                const multiply &m) {
+  const unsigned int k = windowSize(n);
+  std::vector<Q> odd{base};
+
+  if (k > 1) {
+    const Q square = m(base, base);
+
+    for (std::size_t i = 1; i < (std::size_t(1) << (k - 1)); i++) {
+      odd.push_back(m(odd.back(), square));
+    }
+  }
+
+  Q result = base;
+  bool started = false;
+
+  for (std::size_t i = n; i > 0;) {
+    if (!b(i - 1)) {
+      result = m(result, result);
+      i--;
+      continue;
+    }
+
+    std::size_t j = i > k ? i - k : 0;
+    while (!b(j)) {
+      j++;
+    }
+
+    std::size_t window = 0;
+    for (std::size_t l = i; l > j; l--) {
+      window = (window << 1) | (b(l - 1) ? 1 : 0);
+      if (started) {
+        result = m(result, result);
+      }
+    }
+
+    result = started ? m(result, odd[window >> 1]) : odd[window >> 1];
+    started = true;
+    i = j;
+  }
+
+  return result;
+}
+
 /**\brief Integral, compile-time constant power
  *
  * This class defines a method raise() that raises a given number
@@ -143,8 +230,12 @@ class integral<Q, 0> {
 
   /**\brief Raise to the specified power
    *
-   * Raises the 'base' value to the 'exponent'th power using a
-   * square-and-multiply algorithm.
+   * Raises the 'base' value to the 'exponent'th power with an iterative
+   * square-and-multiply algorithm, or with windowed() for exponents that
+   * are long enough for the windows to pay off. Built-in arithmetic
+   * types gain nothing from the windows, so they always take the plain
+   * loop, which keeps this usable in constant expressions. Negative
+   * exponents raise the reciprocal of the base instead.
    *
    * \param[in] base     The number to raise.
    * \param[in] exponent What to raise the number to.
@@ -153,23 +244,99 @@ class integral<Q, 0> {
    */
   constexpr static Q raise(
       const Q &base, const typename numeric::traits<Q>::integral &exponent) {
-    return exponent == typename numeric::traits<Q>::integral(0)
-               ? Q(1)
-               : exponent == typename numeric::traits<Q>::integral(-1)
-                     ? Q(1) / base
-                     : exponent == typename numeric::traits<Q>::integral(1)
-                           ? base
-                           : exponent % typename numeric::traits<Q>::integral(
-                                            2) ==
-                                     typename numeric::traits<Q>::integral(0)
-                                 ? raise(base * base, exponent >> 1)
-                                 : base * raise(base * base,
-                                                (exponent -
-                                                 typename numeric::traits<
-                                                     Q>::integral(1)) >>
-                                                    1);
+    typedef typename numeric::traits<Q>::integral integer;
+
+    if (exponent < integer(0)) {
+      return Q(1) / raise(base, integer(0) - exponent);
+    }
+
+    if constexpr (!std::is_arithmetic<Q>::value) {
+      std::size_t n = 0;
+      for (integer e = exponent; e > integer(0); e = e >> 1) {
+        n++;
+      }
+
+      if (windowSize(n) > 1) {
+        return windowed(base, exponent, n);
+      }
+    }
+
+    Q result = Q(1);
+    Q power = base;
+
+    for (integer e = exponent; e > integer(0);) {
+      if (e % integer(2) == integer(1)) {
+        result = result * power;
+      }
+
+      e = e >> 1;
+
+      if (e > integer(0)) {
+        power = power * power;
+      }
+    }
+
+    return result;
+  }
+
+ protected:
+  /**\brief Windowed power
+   *
+   * Raises the base with slidingWindow(), after splitting the exponent
+   * into its bits.
+   *
+   * \param[in] base     The number to raise.
+   * \param[in] exponent What to raise the number to; positive.
+   * \param[in] n        The number of bits in the exponent.
+   *
+   * \return base raised to the exponent'th power.
+   */
+  static Q windowed(const Q &base,
+                    typename numeric::traits<Q>::integral exponent,
+                    std::size_t n) {
+    typedef typename numeric::traits<Q>::integral integer;
+    std::vector<bool> bits(n);
+
+    for (std::size_t i = 0; i < n; i++, exponent = exponent >> 1) {
+      bits[i] = exponent % integer(2) == integer(1);
+    }
+
+    return slidingWindow(
+        base, n, [&bits](std::size_t i) -> bool { return bits[i]; },
+        [](const Q &a, const Q &b) -> Q { return a * b; });
   }
 };
+
+/**\brief Modular power
+ *
+ * Calculates base^exponent mod modulus with the square-and-multiply
+ * algorithm, reducing after every multiplication so the intermediate
+ * values never get bigger than the square of the modulus.
+ *
+ * \tparam T Integer type to calculate with; the square of the modulus
+ *           must fit into it.
+ *
+ * \param[in] base     The number to raise.
+ * \param[in] exponent What to raise the number to.
+ * \param[in] modulus  The modulus; must be positive.
+ *
+ * \return base raised to the exponent'th power, modulo the modulus.
+ */
+template <typename T>
+constexpr T modular(T base, T exponent, const T &modulus) {
+  T result = T(1) % modulus;
+  base %= modulus;
+
+  while (exponent > T(0)) {
+    if (exponent % T(2) == T(1)) {
+      result = result * base % modulus;
+    }
+    base = base * base % modulus;
+    exponent /= T(2);
+  }
+
+  return result;
+}
 };  // namespace exponentiate
 };  // namespace math
 };  // namespace efgy
@@ -12,11 +12,20 @@
 #if !defined(EF_GY_FACTORIAL_H)
 #define EF_GY_FACTORIAL_H
 
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
 namespace efgy {
 namespace math {
 /**\brief A template to calculate the factorial of a number.
  *
- * Uses a basic iterative algorithm.
+ * Uses a basic iterative algorithm for built-in arithmetic types. Anything
+ * else - i.e. big integers - multiplies the factors in a balanced product
+ * tree instead, so that the operands of each multiplication are of roughly
+ * the same size; that way the multiplication itself can use its faster
+ * algorithms rather than multiplying one huge number by one tiny one n times.
  *
  * \tparam Z Basic arithmetic type used for calculations.
  * Z is required to allow integral values and multiplication,
@@ -35,16 +44,109 @@ class factorial {
   factorial(const Z &pInteger) : integer(pInteger) {}
 
   operator Z() const {
-    Z rv = Z(1);
+    if constexpr (std::is_arithmetic<Z>::value) {
+      Z rv = Z(1);
+
+      for (Z n = Z(2); n <= integer; ++n) {
+        rv *= n;
+      }
 
-    for (Z n = Z(2); n <= integer; n++) {
-      rv = rv * n;
+      return rv;
+    } else {
+      return product(Z(2), integer);
     }
+  }
 
-    return rv;
+  /**\brief Memoised factorial
+   *
+   * Looks up the factorial of small numbers in a table that is calculated
+   * once, on first use, and falls back to calculating the factorial for
+   * anything that isn't in the table. Built-in types only get a table of
+   * the values that don't overflow.
+   *
+   * \param[in] n The number to get the factorial of.
+   *
+   * \returns n!
+   */
+  static Z cached(std::size_t n) {
+    static const std::vector<Z> table = tabulate();
+
+    return n < table.size() ? table[n] : Z(factorial(Z(n)));
   }
 
+  /**\brief Size of the cache
+   *
+   * The number of factorials that cached() keeps around, at most.
+   */
+  static const std::size_t cacheSize = 128;
+
   Z integer;
+
+ protected:
+  /**\brief Balanced product
+   *
+   * Multiplies all the integers in a range by first multiplying short runs
+   * of them directly and then multiplying neighbouring products in pairs,
+   * until only one is left.
+   *
+   * \param[in] first The first factor.
+   * \param[in] last  The last factor, inclusive.
+   *
+   * \returns first * (first + 1) * ... * last.
+   */
+  static Z product(const Z &first, const Z &last) {
+    std::vector<Z> products;
+    std::size_t run = 0;
+
+    for (Z n = first; n <= last; ++n, run++) {
+      if (run % 16 == 0) {
+        products.push_back(n);
+      } else {
+        products.back() *= n;
+      }
+    }
+
+    while (products.size() > 1) {
+      std::size_t i = 0;
+
+      for (; 2 * i + 1 < products.size(); i++) {
+        products[i] = products[2 * i] * products[2 * i + 1];
+      }
+
+      if (2 * i < products.size()) {
+        products[i] = products[2 * i];
+        i++;
+      }
+
+      products.resize(i, Z(1));
+    }
+
+    return products.empty() ? Z(1) : products[0];
+  }
+
+  /**\brief Fill the cache
+   *
+   * Calculates the table used by cached(), stopping early for built-in
+   * types once the next factorial would overflow.
+   *
+   * \returns The first few factorials, starting with 0!.
+   */
+  static std::vector<Z> tabulate(void) {
+    std::vector<Z> rv{Z(1)};
+
+    for (std::size_t n = 1; n < cacheSize; n++) {
+      if constexpr (std::numeric_limits<Z>::is_specialized &&
+                    std::numeric_limits<Z>::is_bounded) {
+        if (rv.back() > std::numeric_limits<Z>::max() / Z(n)) {
+          break;
+        }
+      }
+
+      rv.push_back(rv.back() * Z(n));
+    }
+
+    return rv;
+  }
 };
 };  // namespace math
 };  // namespace efgy
@@ -19,6 +19,9 @@
 #define EF_GY_FLAME_H
 
 #include <ef.gy/ifs.h>
+#include <ef.gy/simd.h>
+
+#include <vector>
 
 namespace efgy {
 namespace geometry {
@@ -43,20 +46,195 @@ class flame : public affine<Q, d> {
 
   math::vector<Q, d> operator*(const math::vector<Q, d> &pV) const {
     const math::vector<Q, d> V = affine<Q, d>(*this) * pV;
-    math::vector<Q, d> rv = V * coefficient[0];
 
-    for (int i : range<int>(1, coefficients, false)) {
-      rv = rv + apply(i, V);
+    return combine(V, features(V, coefficient));
+  }
+
+  /**\brief Transform many points at once
+   *
+   * Does the same as the multiplication operator for each of the n points,
+   * but calculates the angles and radii of all of them, and their sines
+   * and cosines, together with the batched functions in math::simd.
+   *
+   * \param[in]  pV The points to transform.
+   * \param[out] rv Where to write the transformed points to.
+   * \param[in]  n  The number of points.
+   */
+  void transform(const math::vector<Q, d> *pV, math::vector<Q, d> *rv,
+                 std::size_t n) const {
+    std::vector<math::vector<Q, d>> V(n);
+    std::vector<Q> quotient(n), theta(n), r2(n), r(n);
+    std::vector<Q> sinTheta(n), cosTheta(n), sinR(n), cosR(n), sinR2(n),
+        cosR2(n);
+
+    for (std::size_t i = 0; i < n; i++) {
+      V[i] = affine<Q, d>(*this) * pV[i];
+      quotient[i] = V[i][0] / V[i][1];
+      r2[i] = math::lengthSquared(V[i]);
     }
 
-    return rv;
+    math::simd::arctangent(quotient.data(), theta.data(), n);
+    math::simd::squareRoot(r2.data(), r.data(), n);
+    math::simd::sines(theta.data(), sinTheta.data(), cosTheta.data(), n);
+    math::simd::sines(r.data(), sinR.data(), cosR.data(), n);
+    math::simd::sines(r2.data(), sinR2.data(), cosR2.data(), n);
+
+    for (std::size_t i = 0; i < n; i++) {
+      features p;
+      p.theta = theta[i];
+      p.r2 = r2[i];
+      p.r = r[i];
+      p.sinTheta = sinTheta[i];
+      p.cosTheta = cosTheta[i];
+      p.sinR = sinR[i];
+      p.cosR = cosR[i];
+      p.sinR2 = sinR2[i];
+      p.cosR2 = cosR2[i];
+
+      rv[i] = combine(V[i], p);
+    }
   }
 
   static const std::size_t coefficients = 19;
   Q coefficient[coefficients];
 
  protected:
-  math::vector<Q, d> apply(std::size_t f, const math::vector<Q, d> &V) const {
+  /**\brief Polar features of a point
+   *
+   * The angle and radius of a point after the affine transformation, and
+   * the sines and cosines that several of the variations share.
+   */
+  class features {
+   public:
+    features(void) {}
+
+    /**\brief Calculate features
+     *
+     * Only calculates the features that the variations with a positive
+     * coefficient actually use, according to flame::uses, so that flames
+     * made up of cheap variations don't pay for arc tangents, roots and
+     * sines per point. The remaining features are left at zero.
+     *
+     * \param[in] V The point after the affine transformation.
+     * \param[in] c The coefficients of the variations.
+     */
+    features(const math::vector<Q, d> &V, const Q (&c)[coefficients])
+        : theta(0),
+          r2(0),
+          r(0),
+          sinTheta(0),
+          cosTheta(0),
+          sinR(0),
+          cosR(0),
+          sinR2(0),
+          cosR2(0) {
+      unsigned int u = 0;
+
+      for (std::size_t f = 0; f < coefficients; f++) {
+        if (c[f] > Q(0)) {
+          u |= uses[f];
+        }
+      }
+
+      if (u & useSines) {
+        u |= useTheta | useR;
+      }
+      if (u & (useR | useSwirl)) {
+        u |= useR2;
+      }
+
+      if (u & useR2) {
+        r2 = math::lengthSquared(V);
+      }
+      if (u & useR) {
+        r = sqrt(r2);
+      }
+      if (u & useTheta) {
+        theta = atan(V[0] / V[1]);
+      }
+      if (u & useSwirl) {
+        sinR2 = sin(r2);
+        cosR2 = cos(r2);
+      }
+      if (u & useSines) {
+        sinTheta = sin(theta);
+        cosTheta = cos(theta);
+        sinR = sin(r);
+        cosR = cos(r);
+      }
+    }
+
+    Q theta, r2, r;
+    Q sinTheta, cosTheta, sinR, cosR, sinR2, cosR2;
+  };
+
+  /**\brief Features of a point
+   *
+   * Flags for the features that apply() reads: features::r2, features::r,
+   * features::theta, the sine and cosine of r2 for the swirl, and the
+   * sines and cosines of theta and r. Each feature also needs the ones
+   * that it is calculated from: r and the swirl need r2, and the sines
+   * need both theta and r.
+   */
+  enum feature : unsigned int {
+    useR2 = 1,
+    useR = 2,
+    useTheta = 4,
+    useSwirl = 8,
+    useSines = 16
+  };
+
+  /**\brief Features that the variations use
+   *
+   * For each variation, the features that its case in apply() reads;
+   * keep this in sync when adding or changing variations.
+   */
+  static constexpr unsigned int uses[] = {
+      0,                // "linear"
+      0,                // "sinusoidal"
+      useR2,            // "spherical"
+      useSwirl,         // "swirl"
+      useR,             // "horseshoe"
+      useTheta | useR,  // "polar"
+      useTheta | useR,  // "handkerchief"
+      useTheta | useR,  // "heart"
+      useTheta | useR,  // "disc"
+      useSines | useR,  // "spiral"
+      useSines | useR,  // "hyperbolic"
+      useSines,         // "diamond"
+      useTheta | useR,  // "ex"
+      useTheta | useR,  // "julia"
+      0,                // "bent"
+      0,                // "waves"
+      useR,             // "fisheye"
+      0,                // "popcorn"
+      0                 // "exponential"
+  };
+
+  static_assert(sizeof(uses) / sizeof(uses[0]) == coefficients,
+                "every variation needs an entry in flame::uses");
+
+  /**\brief Combine the variations
+   *
+   * \param[in] V The point after the affine transformation.
+   * \param[in] p The point's features.
+   *
+   * \returns The sum of all the variations, weighted by their
+   *          coefficients.
+   */
+  math::vector<Q, d> combine(const math::vector<Q, d> &V,
+                             const features &p) const {
+    math::vector<Q, d> rv = V * coefficient[0];
+
+    for (int i : range<int>(1, coefficients, false)) {
+      rv = rv + apply(i, V, p);
+    }
+
+    return rv;
+  }
+
+  math::vector<Q, d> apply(std::size_t f, const math::vector<Q, d> &V,
+                           const features &p) const {
     math::vector<Q, d> rv;
 
     if (coefficient[f] <= Q(0)) {
@@ -67,10 +245,10 @@ class flame : public affine<Q, d> {
     // paper, but won't be used until the remaining
     // variations are implemented
 
-    const Q theta = atan(V[0] / V[1]);
+    const Q &theta = p.theta;
     // const Q phi   = atan(V[1]/V[0]);
-    const Q r2 = math::lengthSquared(V);
-    const Q r = sqrt(r2);
+    const Q &r2 = p.r2;
+    const Q &r = p.r;
     const Q omega = Q(std::rand() % 2) * Q(M_PI);
     // const Q delta = (std::rand() % 2) == 1 ? Q(1) : Q(-1);
     // const Q psi   = Q(std::rand() % 10000) / Q(10000);
@@ -88,8 +266,8 @@ class flame : public affine<Q, d> {
         break;
       case 3:  // "swirl"
       {
-        const Q sinrsq = sin(r2);
-        const Q cosrsq = cos(r2);
+        const Q &sinrsq = p.sinR2;
+        const Q &cosrsq = p.cosR2;
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wtautological-compare"
         for (std::size_t i : range<std::size_t>(0, depth, depth, false))
@@ -108,7 +286,7 @@ class flame : public affine<Q, d> {
       case 5:  // "polar"
         rv = V;
         rv[0] = theta / Q(M_PI);
-        rv[1] = sqrt(math::lengthSquared(V)) - Q(1);
+        rv[1] = r - Q(1);
         break;
       case 6:  // "handkerchief"
         for (std::size_t i : range<std::size_t>(0, depth, depth, false))
@@ -158,16 +336,16 @@ class flame : public affine<Q, d> {
         for (std::size_t i : range<std::size_t>(0, depth, depth, false))
           switch (i % 4) {
             case 0:
-              rv[i] = cos(theta) + sin(r);
+              rv[i] = p.cosTheta + p.sinR;
               break;
             case 1:
-              rv[i] = sin(theta) - cos(r);
+              rv[i] = p.sinTheta - p.cosR;
               break;
             case 2:
-              rv[i] = cos(theta) - sin(r);
+              rv[i] = p.cosTheta - p.sinR;
               break;
             case 3:
-              rv[i] = sin(theta) + cos(r);
+              rv[i] = p.sinTheta + p.cosR;
               break;
           }
         rv = rv / r;
@@ -176,16 +354,16 @@ class flame : public affine<Q, d> {
         for (std::size_t i : range<std::size_t>(0, depth, depth, false))
           switch (i % 4) {
             case 0:
-              rv[i] = sin(theta) / r;
+              rv[i] = p.sinTheta / r;
               break;
             case 1:
-              rv[i] = cos(theta) * r;
+              rv[i] = p.cosTheta * r;
               break;
             case 2:
-              rv[i] = sin(theta) * r;
+              rv[i] = p.sinTheta * r;
               break;
             case 3:
-              rv[i] = cos(theta) / r;
+              rv[i] = p.cosTheta / r;
               break;
           }
         break;
@@ -193,10 +371,10 @@ class flame : public affine<Q, d> {
         for (std::size_t i : range<std::size_t>(0, depth, depth, false))
           switch (i % 2) {
             case 0:
-              rv[i] = sin(theta) * cos(r);
+              rv[i] = p.sinTheta * p.cosR;
               break;
             case 1:
-              rv[i] = cos(theta) * sin(r);
+              rv[i] = p.cosTheta * p.sinR;
               break;
           }
         break;
@@ -275,7 +453,7 @@ class flame : public affine<Q, d> {
         break;
       case 16:  // "fisheye"
         for (std::size_t i : range<std::size_t>(0, depth, depth, false))
-          rv[i] = V[(d - i)];
+          rv[i] = V[(d - 1 - i)];
         rv = rv * Q(2) / (r + Q(1));
         break;
       case 17:  // "popcorn"
@@ -15,12 +15,109 @@
 #include <ef.gy/big-integers.h>
 #include <ef.gy/traits.h>
 
-#define normalise minimise
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace efgy {
 namespace math {
 namespace numeric {
+/**\brief Number of significant bits
+ *
+ * Used by lazyReduction to decide when a fraction has grown large enough
+ * to be worth reducing. This generic version works for the built-in
+ * integer types; bigIntegers provides its own overload.
+ *
+ * \param[in] v The number to examine.
+ *
+ * \returns The number of bits needed for the absolute value of v.
+ */
 template <typename N>
+std::size_t bitLength(const N &v) {
+  N a = (v < zero()) ? N(-v) : v;
+  std::size_t r = 0;
+
+  while (a > zero()) {
+    a /= N(2);
+    r++;
+  }
+
+  return r;
+}
+
+/**\brief Eager fraction reduction
+ *
+ * Reduction policy for the fractional template that divides numerator
+ * and denominator by their GCD after every operation, so fractions are
+ * always in lowest terms. This is the default.
+ */
+class eagerReduction {
+ public:
+  /**\brief Are fractions always in lowest terms? */
+  static const bool canonical = true;
+
+  /**\brief Reduce before writing a fraction to a stream? */
+  static const bool reduceOnOutput = false;
+
+  /**\brief Reduce after an operation?
+   *
+   * \returns 'true' if a fraction with the given numerator and
+   *          denominator should be reduced now.
+   */
+  template <typename N>
+  static bool due(const N &, const N &) {
+    return true;
+  }
+};
+
+/**\brief Lazy fraction reduction
+ *
+ * Reduction policy for the fractional template that only reduces a
+ * fraction once its numerator or denominator needs more than the given
+ * number of bits, and when it is written to a stream. Long sums and
+ * products thus only pay for a GCD every so often, instead of after
+ * every single operation. Comparisons work on unreduced fractions.
+ *
+ * \tparam bits Size at which fractions are reduced. For built-in integer
+ *              types, this should leave enough room for the products of
+ *              two numerators or denominators.
+ */
+template <std::size_t bits = 256>
+class lazyReduction {
+ public:
+  static const bool canonical = false;
+  static const bool reduceOnOutput = true;
+
+  template <typename N>
+  static bool due(const N &numerator, const N &denominator) {
+    return (bitLength(denominator) > bits) || (bitLength(numerator) > bits);
+  }
+};
+
+/**\brief Manual fraction reduction
+ *
+ * Reduction policy for the fractional template that never reduces
+ * fractions on its own; call fractional::reduce() where appropriate.
+ */
+class manualReduction {
+ public:
+  static const bool canonical = false;
+  static const bool reduceOnOutput = false;
+
+  template <typename N>
+  static bool due(const N &, const N &) {
+    return false;
+  }
+};
+
+/**\brief Fractions
+ *
+ * \tparam N         Integer type for the numerator and denominator.
+ * \tparam reduction When to reduce fractions to lowest terms; one of
+ *                   eagerReduction, lazyReduction or manualReduction.
+ */
+template <typename N, typename reduction>
 class fractional : public numeric {
  public:
   typedef N integer;
@@ -31,8 +128,17 @@ class fractional : public numeric {
 
   fractional(N pNumerator, N pDenominator)
       : numerator(pNumerator), denominator(pDenominator) {
-    normalise();
-    // minimise();
+    update();
+  }
+
+  /**\brief Convert from a different reduction policy
+   *
+   * \param[in] f The fraction to convert.
+   */
+  template <typename R>
+  explicit fractional(const fractional<N, R> &f)
+      : numerator(f.numerator), denominator(f.denominator) {
+    update();
   }
 
   fractional &operator=(const fractional &b) {
@@ -55,8 +161,7 @@ class fractional : public numeric {
   fractional &operator+=(const fractional &b) {
     numerator = numerator * b.denominator + b.numerator * denominator;
     denominator = denominator * b.denominator;
-    normalise();
-    // minimise();
+    update();
     return (*this);
   }
   fractional operator+(const N &b) const {
@@ -64,8 +169,7 @@ class fractional : public numeric {
   }
   fractional &operator+=(const N &b) {
     numerator += b * denominator;
-    normalise();
-    // minimise();
+    update();
     return (*this);
   }
 
@@ -76,8 +180,7 @@ class fractional : public numeric {
   fractional &operator-=(const fractional &b) {
     numerator = numerator * b.denominator - b.numerator * denominator;
     denominator = denominator * b.denominator;
-    normalise();
-    // minimise();
+    update();
     return (*this);
   }
   fractional operator-(const N &b) const {
@@ -85,8 +188,7 @@ class fractional : public numeric {
   }
   fractional &operator-=(const N &b) {
     numerator -= b * denominator;
-    normalise();
-    // minimise();
+    update();
     return (*this);
   }
 
@@ -96,8 +198,7 @@ class fractional : public numeric {
   fractional &operator*=(const fractional &b) {
     numerator *= b.numerator;
     denominator *= b.denominator;
-    normalise();
-    // minimise();
+    update();
     return (*this);
   }
   fractional operator*(const N &b) const {
@@ -105,8 +206,7 @@ class fractional : public numeric {
   }
   fractional &operator*=(const N &b) {
     numerator *= b;
-    normalise();
-    // minimise();
+    update();
     return (*this);
   }
 
@@ -136,8 +236,7 @@ class fractional : public numeric {
   fractional &operator/=(const fractional &b) {
     numerator *= b.denominator;
     denominator *= b.numerator;
-    normalise();
-    // minimise();
+    update();
     return (*this);
   }
   fractional operator/(const N &b) const {
@@ -145,8 +244,7 @@ class fractional : public numeric {
   }
   fractional &operator/=(const N &b) {
     denominator *= b;
-    normalise();
-    // minimise();
+    update();
     return (*this);
   }
 
@@ -177,23 +275,11 @@ class fractional : public numeric {
   bool operator==(const fractional &b) const {
     if ((numerator == b.numerator) && (denominator == b.denominator)) {
       return true;
-    }
-#if defined(normalise)
-    else {
+    } else if (reduction::canonical) {
       return false;
     }
-#endif
-
-    fractional p = *this;
-    fractional q = b;
-
-    p.minimise();
-    q.minimise();
 
-    const fractional &pc = p;
-    const fractional &qc = q;
-
-    return (pc.numerator == qc.numerator) && (pc.denominator == qc.denominator);
+    return (numerator * b.denominator) == (b.numerator * denominator);
   }
 
   bool operator==(const zero &b) const { return numerator == b; }
@@ -220,11 +306,23 @@ class fractional : public numeric {
     return rv;
   }
 
+  /**\brief Reduce to lowest terms
+   *
+   * Divides numerator and denominator by their greatest common divisor.
+   * Fractions with the eagerReduction policy are always in lowest terms,
+   * with the other policies this may be called whenever convenient.
+   *
+   * \returns A reference to this fraction.
+   */
+  fractional &reduce(void) {
+    minimise();
+    return *this;
+  }
+
   N numerator;
   N denominator;
 
  protected:
-#undef normalise
   void normalise(void) {
     if (denominator < zero()) {
       numerator = -numerator;
@@ -243,30 +341,195 @@ class fractional : public numeric {
       denominator /= n;
     }
   }
+
+  /**\brief Tidy up after an operation
+   *
+   * Makes the denominator positive and reduces the fraction if the
+   * reduction policy says it is time to.
+   */
+  void update(void) {
+    if (reduction::due(numerator, denominator)) {
+      minimise();
+    } else {
+      normalise();
+    }
+  }
 };
 
-template <typename C, typename N>
+template <typename C, typename N, typename reduction>
 std::basic_ostream<C> &operator<<(std::basic_ostream<C> &out,
-                                  const fractional<N> &f) {
+                                  const fractional<N, reduction> &f) {
+  if (reduction::reduceOnOutput) {
+    fractional<N, reduction> r = f;
+    r.reduce();
+    return out << r.numerator << "/" << r.denominator;
+  }
+
   return out << f.numerator << "/" << f.denominator;
 }
 
-template <typename N>
-fractional<N> reciprocal(const fractional<N> &f) {
+template <typename N, typename reduction>
+fractional<N, reduction> reciprocal(const fractional<N, reduction> &f) {
   if ((f.numerator == zero()) || (f.denominator == zero())) {
-    return fractional<N>(N(0));
+    return fractional<N, reduction>(N(0));
   }
 
-  return fractional<N>(f.denominator, f.numerator);
+  return fractional<N, reduction>(f.denominator, f.numerator);
 }
 
-template <typename N>
-class traits<fractional<N>> {
+/**\brief Fraction sum accumulator
+ *
+ * Sums fractions with a balanced binary tree instead of one after the
+ * other: terms are paired up as they arrive, pairs of pairs are combined
+ * as soon as there are two of them, and so on, much like a binary counter.
+ * The denominators are thus multiplied in a product tree, where the big
+ * integer multiplication algorithms can shine, rather than one growing
+ * product at a time. Partial sums with the same denominator simply add
+ * their numerators.
+ *
+ * Nothing is reduced while summing unless a cadence is given, in which
+ * case partial sums of at least that many terms are reduced. Built-in
+ * integers would overflow long before the end of most sums, so their
+ * partial sums are also reduced whenever the fraction's own reduction
+ * policy says so. The total is reduced according to that policy when it
+ * is converted back to a fraction.
+ *
+ * \tparam N         Integer type of the fractions.
+ * \tparam reduction Reduction policy of the fractions.
+ */
+template <typename N, typename reduction>
+class accumulator<fractional<N, reduction>> {
+ public:
+  typedef fractional<N, reduction> value;
+
+  /**\brief Start an empty sum
+   *
+   * \param[in] pCadence Reduce partial sums of at least this many terms;
+   *                     0 to only reduce at the end.
+   */
+  accumulator(std::size_t pCadence = 0) : cadence(pCadence) {}
+
+  /**\brief Start a sum
+   *
+   * \param[in] pSum     The first term of the sum.
+   * \param[in] pCadence Reduce partial sums of at least this many terms;
+   *                     0 to only reduce at the end.
+   */
+  accumulator(const value &pSum, std::size_t pCadence = 0)
+      : cadence(pCadence) {
+    if (!(pSum == zero())) {
+      *this += pSum;
+    }
+  }
+
+  accumulator &operator+=(const value &term) {
+    partials.push_back(partial{term.numerator, term.denominator, 1});
+
+    while ((partials.size() > 1) &&
+           (partials[(partials.size() - 1)].count ==
+            partials[(partials.size() - 2)].count)) {
+      partial b = std::move(partials.back());
+      partials.pop_back();
+      partials.back() = combine(partials.back(), b);
+    }
+
+    return *this;
+  }
+
+  /**\brief Get the sum
+   *
+   * Combines the remaining partial sums, smallest first.
+   *
+   * \returns The sum of all the terms added so far.
+   */
+  operator value(void) const {
+    if (partials.size() == 0) {
+      return value();
+    }
+
+    partial r = partials.back();
+
+    for (std::size_t i = partials.size() - 1; i > 0; i--) {
+      r = combine(partials[(i - 1)], r);
+    }
+
+    return value(r.numerator, r.denominator);
+  }
+
+ protected:
+  /**\brief Partial sum
+   *
+   * The sum of count terms, not necessarily in lowest terms.
+   */
+  class partial {
+   public:
+    N numerator;
+    N denominator;
+    std::size_t count;
+  };
+
+  /**\brief Add two partial sums
+   *
+   * \param[in] a The first partial sum.
+   * \param[in] b The second partial sum.
+   *
+   * \returns The sum of a and b, reduced if it covers enough terms, or
+   *          if the reduction policy asks for it with built-in integers.
+   */
+  partial combine(const partial &a, const partial &b) const {
+    partial r;
+
+    r.count = a.count + b.count;
+
+    if (a.denominator == b.denominator) {
+      r.numerator = a.numerator + b.numerator;
+      r.denominator = a.denominator;
+    } else {
+      r.numerator = a.numerator * b.denominator + b.numerator * a.denominator;
+      r.denominator = a.denominator * b.denominator;
+    }
+
+    if (((cadence > 0) && (r.count >= cadence)) ||
+        (std::is_integral<N>::value &&
+         reduction::due(r.numerator, r.denominator))) {
+      const N g = gcd(r.numerator, r.denominator);
+
+      if ((g != zero()) && (g != one())) {
+        r.numerator /= g;
+        r.denominator /= g;
+      }
+    }
+
+    return r;
+  }
+
+  /**\brief Partial sums
+   *
+   * Ordered by the number of terms they cover, largest first; the
+   * number of terms halves or more from one entry to the next.
+   */
+  std::vector<partial> partials;
+
+  /**\brief Reduction cadence
+   *
+   * Partial sums of at least this many terms are reduced; 0 means that
+   * only the total is reduced.
+   */
+  const std::size_t cadence;
+};
+
+template <typename N, typename reduction>
+class builtinFraction<fractional<N, reduction>>
+    : public std::integral_constant<bool, std::is_integral<N>::value> {};
+
+template <typename N, typename reduction>
+class traits<fractional<N, reduction>> {
  public:
-  typedef typename fractional<N>::integer integral;
-  typedef fractional<N> rational;
-  typedef fractional<N> self;
-  typedef fractional<N> derivable;
+  typedef typename fractional<N, reduction>::integer integral;
+  typedef fractional<N, reduction> rational;
+  typedef fractional<N, reduction> self;
+  typedef fractional<N, reduction> derivable;
+  typedef euclideanGCD gcdAlgorithm;
 
   static const bool stable = traits<N>::stable;
 };
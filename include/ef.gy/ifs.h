@@ -98,7 +98,7 @@ template <typename Q, std::size_t depth, std::size_t renderDepth>
 class gasket {
  public:
   using translation = transformation::affine<Q, renderDepth>;
-  using dimensions = dimensions<2, 0>;
+  using dimensions = geometry::dimensions<2, 0>;
   static constexpr const char *id(void) { return "sierpinski-gasket"; }
 
   using scale = transformation::scale<Q, renderDepth>;
@@ -139,7 +139,7 @@ template <typename Q, std::size_t depth, std::size_t renderDepth>
 class carpet {
  public:
   using translation = transformation::affine<Q, renderDepth>;
-  using dimensions = dimensions<2, 3>;
+  using dimensions = geometry::dimensions<2, 3>;
   static constexpr const char *id(void) { return "sierpinski-carpet"; }
 
   using scale = transformation::scale<Q, renderDepth>;
@@ -207,7 +207,7 @@ template <typename Q, std::size_t depth, std::size_t renderDepth,
 class random {
  public:
   using translation = trans<Q, renderDepth>;
-  using dimensions = dimensions<2, 0>;
+  using dimensions = geometry::dimensions<2, 0>;
   static constexpr const char *id(void) { return name; }
 
   static std::vector<translation> functions(const parameters<Q> &parameter) {
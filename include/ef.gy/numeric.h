@@ -12,6 +12,8 @@
 #if !defined(EF_GY_NUMERIC_H)
 #define EF_GY_NUMERIC_H
 
+#include <ef.gy/traits.h>
+
 namespace efgy {
 namespace math {
 namespace numeric {
@@ -236,6 +238,45 @@ zero operator*(const zero &a, const T &b) {
   return zero();
 }
 
+/**\brief Sum accumulator
+ *
+ * Collects the terms of a sum. This generic version simply adds every term
+ * to a running total, in the order they arrive; types for which that is
+ * not the best way to sum many terms, like fractions, specialise it.
+ *
+ * \tparam Q The type of the terms and the sum.
+ */
+template <typename Q>
+class accumulator {
+ public:
+  /**\brief Start a sum
+   *
+   * \param[in] pSum The initial value of the sum.
+   */
+  constexpr accumulator(const Q &pSum = Q(0)) : sum(pSum) {}
+
+  /**\brief Add a term
+   *
+   * \param[in] term The term to add to the sum.
+   *
+   * \returns A reference to this accumulator.
+   */
+  constexpr accumulator &operator+=(const Q &term) {
+    sum += term;
+    return *this;
+  }
+
+  /**\brief Get the sum
+   *
+   * \returns The sum of all the terms added so far.
+   */
+  constexpr operator Q(void) const { return sum; }
+
+ protected:
+  /**\brief The sum so far */
+  Q sum;
+};
+
 /**
  * Generic power2 template.
  */
@@ -251,21 +292,30 @@ factorial<T> operator!(const T &a) {
   return factorial<T>(a);
 }
 
-/* generic exponentiation operator */
+/* generic exponentiation operator
+ *
+ * Square-and-multiply, so it needs log2(b) squarings rather than b
+ * multiplications. Exponents that aren't positive result in 1.
+ */
 
 template <typename T, typename Z>
 T operator^(const T &a, const Z &b) {
-  if (b == zero()) {
-    return T(1);
-  } else {
-    T rv = a;
+  T rv = T(1);
+  T power = a;
 
-    for (Z i = 1; i < b; i++) {
-      rv *= a;
+  for (Z e = b; e > Z(0);) {
+    if (e % Z(2) == Z(1)) {
+      rv *= power;
     }
 
-    return rv;
+    e = e >> 1;
+
+    if (e > Z(0)) {
+      power *= power;
+    }
   }
+
+  return rv;
 }
 
 template <typename T, typename Z>
@@ -277,23 +327,45 @@ T &operator^=(T &a, const Z &b) {
 
 /* generic functions */
 
+/**\brief Number of trailing zero bits
+ *
+ * \param[in] v A positive integer.
+ *
+ * \returns The number of consecutive zero bits at the least significant
+ *          end of v.
+ */
 template <typename T>
-T gcd(const T &rA, const T &rB) {
-  T t;
-  T a = (rA < zero()) ? -rA : rA;
-  T b = (rB < zero()) ? -rB : rB;
+unsigned int trailingZeroBits(T v) {
+  unsigned int r = 0;
+
+#if defined(__GNUC__)
+  if constexpr (sizeof(T) > sizeof(unsigned long long)) {
+    while ((unsigned long long)(v) == 0) {
+      v >>= 64;
+      r += 64;
+    }
+  }
 
-  while (b > zero()) {
-    t = b;
-    b = a % b;
-    a = t;
+  return r + __builtin_ctzll((unsigned long long)(v));
+#else
+  while ((v & T(1)) == T(0)) {
+    v >>= 1;
+    r++;
   }
 
-  return a;
+  return r;
+#endif
 }
 
+/**\brief Euclidean GCD of positive numbers
+ *
+ * \param[in] rA The first number; must not be negative.
+ * \param[in] rB The second number; must not be negative.
+ *
+ * \returns The greatest common divisor of rA and rB.
+ */
 template <typename T>
-T gcdP(const T &rA, const T &rB) {
+T gcdP(const T &rA, const T &rB, const euclideanGCD &) {
   T t;
   T a = rA;
   T b = rB;
@@ -306,6 +378,78 @@ T gcdP(const T &rA, const T &rB) {
 
   return a;
 }
+
+/**\brief Binary GCD of positive numbers
+ *
+ * Stein's algorithm: factors of two common to both numbers are removed
+ * with one shift, after which the smaller odd number is repeatedly
+ * subtracted from the larger and the difference made odd again. This
+ * avoids the division instruction entirely.
+ *
+ * \copydetails gcdP(const T &, const T &, const euclideanGCD &)
+ */
+template <typename T>
+T gcdP(const T &rA, const T &rB, const binaryGCD &) {
+  T a = rA;
+  T b = rB;
+
+  if (!(b > T(0))) {
+    return a;
+  } else if (!(a > T(0))) {
+    return b;
+  }
+
+  const unsigned int shift = trailingZeroBits(a | b);
+
+  a >>= trailingZeroBits(a);
+
+  do {
+    b >>= trailingZeroBits(b);
+
+    if (a > b) {
+      const T t = a;
+      a = b;
+      b = t;
+    }
+
+    b -= a;
+  } while (b != T(0));
+
+  return a << shift;
+}
+
+/**\brief GCD of positive numbers with the type's own algorithm
+ *
+ * \copydetails gcdP(const T &, const T &, const euclideanGCD &)
+ */
+template <typename T>
+T gcdP(const T &rA, const T &rB, const lehmerGCD &) {
+  return T::gcd(rA, rB);
+}
+
+/**\brief GCD of positive numbers
+ *
+ * Uses the algorithm selected by traits<T>::gcdAlgorithm.
+ *
+ * \copydetails gcdP(const T &, const T &, const euclideanGCD &)
+ */
+template <typename T>
+T gcdP(const T &rA, const T &rB) {
+  return gcdP(rA, rB, typename traits<T>::gcdAlgorithm());
+}
+
+/**\brief GCD
+ *
+ * \param[in] rA The first number.
+ * \param[in] rB The second number.
+ *
+ * \returns The greatest common divisor of the absolute values of rA and
+ *          rB.
+ */
+template <typename T>
+T gcd(const T &rA, const T &rB) {
+  return gcdP((rA < zero()) ? T(-rA) : rA, (rB < zero()) ? T(-rB) : rB);
+}
 };  // namespace numeric
 };  // namespace math
 };  // namespace efgy
@@ -17,8 +17,12 @@
 #define EF_GY_PARAMETRIC_H
 
 #include <ef.gy/polytope.h>
+#include <ef.gy/simd.h>
 
 #include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace efgy {
 namespace geometry {
@@ -30,10 +34,46 @@ namespace geometry {
  * such as the geometry::parametric template.
  */
 namespace formula {
+/**\brief Sines and cosines of many positions
+ *
+ * Calculates the sines and cosines of one coordinate of a number of
+ * positions, optionally multiplied by a factor, all at once with
+ * math::simd. The batched getCoordinates() functions of the formulae use
+ * this instead of calling sin() and cos() for every vertex.
+ *
+ * \tparam Q  Base type for calculations.
+ * \tparam od Model depth.
+ */
+template <typename Q, std::size_t od>
+class angles {
+ public:
+  /**\brief Calculate sines and cosines
+   *
+   * \param[in] ve The positions.
+   * \param[in] n  The number of positions.
+   * \param[in] i  Which coordinate to use.
+   * \param[in] f  The factor to multiply the coordinate with.
+   */
+  angles(const math::vector<Q, od> *ve, std::size_t n, std::size_t i,
+         const Q &f = Q(1))
+      : sine(n), cosine(n) {
+    std::vector<Q> a(n);
+
+    for (std::size_t k = 0; k < n; k++) {
+      a[k] = ve[k][i] * f;
+    }
+
+    math::simd::sines(a.data(), sine.data(), cosine.data(), n);
+  }
+
+  std::vector<Q> sine;
+  std::vector<Q> cosine;
+};
+
 template <typename Q, std::size_t od>
 class moebiusStrip {
  public:
-  typedef dimensions<2, 2> dimensions;
+  typedef geometry::dimensions<2, 2> dimensions;
   typedef math::format::cartesian format;
 
   static constexpr const std::size_t renderDepth = 3;
@@ -55,12 +95,27 @@ class moebiusStrip {
          Q((parameter.radius + ve[1] / Q(2) * cos(ve[0] / Q(2))) * sin(ve[0])),
          Q(ve[1] / Q(2) * sin(ve[0] / Q(2)))}};
   }
+
+  static void getCoordinates(const parameters<Q> &parameter,
+                             const math::vector<Q, od> *ve,
+                             math::vector<Q, renderDepth> *out,
+                             std::size_t n) {
+    const angles<Q, od> u(ve, n, 0), h(ve, n, 0, Q(1) / Q(2));
+
+    for (std::size_t k = 0; k < n; k++) {
+      out[k] = {{Q((parameter.radius + ve[k][1] / Q(2) * h.cosine[k]) *
+                   u.cosine[k]),
+                 Q((parameter.radius + ve[k][1] / Q(2) * h.cosine[k]) *
+                   u.sine[k]),
+                 Q(ve[k][1] / Q(2) * h.sine[k])}};
+    }
+  }
 };
 
 template <typename Q, std::size_t od>
 class kleinBagel {
  public:
-  typedef dimensions<2, 2> dimensions;
+  typedef geometry::dimensions<2, 2> dimensions;
   typedef math::format::cartesian format;
 
   static constexpr const std::size_t renderDepth = 3;
@@ -84,12 +139,30 @@ class kleinBagel {
              Q(sin(ve[0] / Q(2)) * sin(ve[1]) -
                cos(ve[0] / Q(2)) * sin(Q(2) * ve[1]))}};
   }
+
+  static void getCoordinates(const parameters<Q> &parameter,
+                             const math::vector<Q, od> *ve,
+                             math::vector<Q, renderDepth> *out,
+                             std::size_t n) {
+    const angles<Q, od> u(ve, n, 0), h(ve, n, 0, Q(1) / Q(2)), v(ve, n, 1),
+        w(ve, n, 1, Q(2));
+
+    for (std::size_t k = 0; k < n; k++) {
+      out[k] = {{Q((parameter.radius + h.cosine[k] * v.sine[k] -
+                    h.sine[k] * w.sine[k]) *
+                   u.cosine[k]),
+                 Q((parameter.radius + h.cosine[k] * v.sine[k] -
+                    h.sine[k] * w.sine[k]) *
+                   u.sine[k]),
+                 Q(h.sine[k] * v.sine[k] - h.cosine[k] * w.sine[k])}};
+    }
+  }
 };
 
 template <typename Q, std::size_t od>
 class kleinBottle {
  public:
-  typedef dimensions<2, 2> dimensions;
+  typedef geometry::dimensions<2, 2> dimensions;
   typedef math::format::cartesian format;
 
   static constexpr const std::size_t renderDepth = 4;
@@ -113,12 +186,31 @@ class kleinBottle {
              Q(parameter.radius2 * sin(ve[0]) *
                (Q(1) + parameter.constant * sin(ve[1])))}};
   }
+
+  static void getCoordinates(const parameters<Q> &parameter,
+                             const math::vector<Q, od> *ve,
+                             math::vector<Q, renderDepth> *out,
+                             std::size_t n) {
+    const angles<Q, od> u(ve, n, 0), h(ve, n, 0, Q(1) / Q(2)), v(ve, n, 1),
+        w(ve, n, 1, Q(2));
+
+    for (std::size_t k = 0; k < n; k++) {
+      out[k] = {{Q(parameter.radius *
+                   (h.cosine[k] * v.cosine[k] - h.sine[k] * w.sine[k])),
+                 Q(parameter.radius *
+                   (h.sine[k] * v.cosine[k] + h.cosine[k] * w.sine[k])),
+                 Q(parameter.radius2 * u.cosine[k] *
+                   (Q(1) + parameter.constant * v.sine[k])),
+                 Q(parameter.radius2 * u.sine[k] *
+                   (Q(1) + parameter.constant * v.sine[k]))}};
+    }
+  }
 };
 
 template <typename Q, std::size_t od>
 class sphere {
  public:
-  typedef dimensions<2, 0> dimensions;
+  typedef geometry::dimensions<2, 0> dimensions;
   typedef math::format::cartesian format;
 
   static constexpr const std::size_t renderDepth = od + 1;
@@ -145,7 +237,7 @@ class sphere {
 template <typename Q, std::size_t od>
 class plane {
  public:
-  typedef dimensions<2, 0> dimensions;
+  typedef geometry::dimensions<2, 0> dimensions;
   typedef math::format::cartesian format;
 
   static constexpr const std::size_t renderDepth = od;
@@ -172,7 +264,7 @@ class plane {
 template <typename Q, std::size_t od>
 class torus {
  public:
-  typedef dimensions<2, 2> dimensions;
+  typedef geometry::dimensions<2, 2> dimensions;
   typedef math::format::cartesian format;
 
   static constexpr const std::size_t renderDepth = 3;
@@ -192,12 +284,27 @@ class torus {
          Q((parameter.radius + parameter.radius2 * cos(ve[1])) * sin(ve[0])),
          Q(parameter.radius2 * sin(ve[1]))}};
   }
+
+  static void getCoordinates(const parameters<Q> &parameter,
+                             const math::vector<Q, od> *ve,
+                             math::vector<Q, renderDepth> *out,
+                             std::size_t n) {
+    const angles<Q, od> u(ve, n, 0), v(ve, n, 1);
+
+    for (std::size_t k = 0; k < n; k++) {
+      out[k] = {{Q((parameter.radius + parameter.radius2 * v.cosine[k]) *
+                   u.cosine[k]),
+                 Q((parameter.radius + parameter.radius2 * v.cosine[k]) *
+                   u.sine[k]),
+                 Q(parameter.radius2 * v.sine[k])}};
+    }
+  }
 };
 
 template <typename Q, std::size_t od>
 class cliffordTorus {
  public:
-  typedef dimensions<2, 2> dimensions;
+  typedef geometry::dimensions<2, 2> dimensions;
   typedef math::format::cartesian format;
 
   static constexpr const std::size_t renderDepth = 4;
@@ -217,12 +324,25 @@ class cliffordTorus {
              Q(sin(parameter.constant) * cos(ve[1])),
              Q(sin(parameter.constant) * sin(ve[1]))}};
   }
+
+  static void getCoordinates(const parameters<Q> &parameter,
+                             const math::vector<Q, od> *ve,
+                             math::vector<Q, renderDepth> *out,
+                             std::size_t n) {
+    const angles<Q, od> u(ve, n, 0), v(ve, n, 1);
+    const Q c = cos(parameter.constant), s = sin(parameter.constant);
+
+    for (std::size_t k = 0; k < n; k++) {
+      out[k] = {{Q(c * u.cosine[k]), Q(c * u.sine[k]), Q(s * v.cosine[k]),
+                 Q(s * v.sine[k])}};
+    }
+  }
 };
 
 template <typename Q, std::size_t od>
 class dinisSurface {
  public:
-  typedef dimensions<2, 2> dimensions;
+  typedef geometry::dimensions<2, 2> dimensions;
   typedef math::format::cartesian format;
 
   static constexpr const std::size_t renderDepth = 3;
@@ -246,6 +366,28 @@ class dinisSurface {
                parameter.radius2 * ve[0])}};
   }
 };
+
+/**\brief Detect formulae with batched coordinates
+ *
+ * Derives from std::true_type if the formula has a getCoordinates()
+ * overload that calculates the coordinates of several positions at once,
+ * and from std::false_type otherwise.
+ *
+ * \tparam F  The formula.
+ * \tparam Q  Base type for calculations.
+ * \tparam od Model depth.
+ */
+template <typename F, typename Q, std::size_t od, typename = void>
+class hasBatchCoordinates : public std::false_type {};
+
+template <typename F, typename Q, std::size_t od>
+class hasBatchCoordinates<
+    F, Q, od,
+    std::void_t<decltype(F::getCoordinates(
+        std::declval<const parameters<Q> &>(),
+        std::declval<const math::vector<Q, od> *>(),
+        std::declval<math::vector<Q, F::renderDepth> *>(),
+        std::declval<std::size_t>()))>> : public std::true_type {};
 }  // namespace formula
 
 template <typename Q, std::size_t od,
@@ -413,6 +555,31 @@ class parametric : public object<Q, od, formula<Q, od>::renderDepth, 4,
   using iterator = parametricIterator<Q, od, formula>;
   using usedParameters = typename source::usedParameters;
 
+  /**\brief Calculate many vertices at once
+   *
+   * Applies the formula to n positions. Formulae with a batched
+   * getCoordinates() calculate the sines and cosines for all of the
+   * positions together with math::simd; the others are called once per
+   * position.
+   *
+   * \param[in]  parameter The model parameters.
+   * \param[in]  ve        The positions.
+   * \param[out] out       Where to write the vertices to.
+   * \param[in]  n         The number of positions.
+   */
+  static void getCoordinates(const parameters<Q> &parameter,
+                             const math::vector<Q, od> *ve,
+                             math::vector<Q, source::renderDepth> *out,
+                             std::size_t n) {
+    if constexpr (formula::hasBatchCoordinates<source, Q, od>::value) {
+      source::getCoordinates(parameter, ve, out, n);
+    } else {
+      for (std::size_t k = 0; k < n; k++) {
+        out[k] = source::getCoordinates(parameter, ve[k]);
+      }
+    }
+  }
+
   constexpr iterator begin(void) const { return iterator(parent::parameter); }
   constexpr iterator end(void) const { return begin().end(); }
 
@@ -20,6 +20,12 @@
 #include <ef.gy/exponential.h>
 #include <ef.gy/series.h>
 
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
 namespace efgy {
 /**\brief Classes and functions dealing with mathematics
  *
@@ -54,6 +60,13 @@ namespace algorithm {
  */
 template <typename Q, typename N>
 class bailey1997 {
+ protected:
+  /**\brief The base data type's integer type
+   *
+   * Used for the factors in term ratios.
+   */
+  typedef typename numeric::traits<Q>::integral integer;
+
  public:
   /**\brief Default number of iterations
    *
@@ -77,6 +90,369 @@ class bailey1997 {
            (Q(4) / (Q(8) * Q(n) + Q(1)) - Q(2) / (Q(8) * Q(n) + Q(4)) -
             Q(1) / (Q(8) * Q(n) + Q(5)) - Q(1) / (Q(8) * Q(n) + Q(6)));
   }
+
+  /**\brief Get next sequence member
+   *
+   * Calculates a member of the sequence from the previous one. The
+   * bracket in at() is the fraction bracketNumerator/bracketDenominator,
+   * so each member is the previous one divided by 16 times the ratio of
+   * two such fractions, instead of another power of 1/16.
+   *
+   * \param[in] previous The sequence member before the one to calculate.
+   * \param[in] n        The sequence member to calculate.
+   *
+   * \returns The sequence member that was to be calculated.
+   */
+  static constexpr Q next(const Q &previous, const N &n) {
+    return previous *
+           (bracketNumerator<Q>(n) * bracketDenominator<Q>(n - N(1))) /
+           (Q(16) * bracketNumerator<Q>(n - N(1)) * bracketDenominator<Q>(n));
+  }
+
+  /**\brief Get term ratio
+   *
+   * Describes a member of the sequence for the binary splitting
+   * summation policy. The four fractions in the bracket are combined
+   * into a single one, and each member is 1/16 of the previous one
+   * times that fraction.
+   *
+   * \param[in] n The sequence member to describe.
+   *
+   * \returns The term ratio of the sequence member.
+   */
+  static series::ratio<integer> termRatio(const N &n) {
+    return {integer(1), integer(n == N(0) ? 1 : 16),
+            bracketNumerator<integer>(n), bracketDenominator<integer>(n)};
+  }
+
+  /**\brief Bound the error
+   *
+   * Each member is less than 4 times 16^-n, so the members after the nth
+   * add up to less than 64/15 times 16^-(n+1).
+   *
+   * \param[in] n Index of the last member in the sum.
+   *
+   * \returns An upper bound for the error of the sum up to the nth member.
+   */
+  static constexpr Q tail(const N &n) {
+    return Q(64) /
+           (Q(15) * exponentiate::integral<Q>::raise(Q(16), integer(n + N(1))));
+  }
+
+ protected:
+  /**\brief Numerator of the bracket
+   *
+   * The numerator of 4/(8n+1) - 2/(8n+4) - 1/(8n+5) - 1/(8n+6), written as
+   * a single fraction.
+   *
+   * \tparam T The type to calculate with.
+   *
+   * \param[in] n The sequence member to calculate the bracket for.
+   *
+   * \returns 120n^2 + 151n + 47.
+   */
+  template <typename T>
+  static constexpr T bracketNumerator(const N &n) {
+    return (T(120) * T(n) + T(151)) * T(n) + T(47);
+  }
+
+  /**\brief Denominator of the bracket
+   *
+   * The denominator matching bracketNumerator().
+   *
+   * \tparam T The type to calculate with.
+   *
+   * \param[in] n The sequence member to calculate the bracket for.
+   *
+   * \returns 512n^4 + 1024n^3 + 712n^2 + 194n + 15.
+   */
+  template <typename T>
+  static constexpr T bracketDenominator(const N &n) {
+    return (((T(512) * T(n) + T(1024)) * T(n) + T(712)) * T(n) + T(194)) *
+               T(n) +
+           T(15);
+  }
+};
+
+/**\brief Machin's pi formula
+ *
+ * John Machin's formula from 1706, pi = 16 arctan(1/5) - 4 arctan(1/239),
+ * with both arc tangents expanded into their power series and summed up
+ * as a single series. Each member adds about 1.4 decimal digits, which is
+ * a bit more than bailey1997 manages, and the members are plain
+ * fractions, so this is a good choice for machine floating point types.
+ *
+ * \tparam Q The data type to use in the calculations, e.g. double.
+ * \tparam N Sequence index type.
+ */
+template <typename Q, typename N>
+class machin {
+ protected:
+  /**\copydoc bailey1997::integer */
+  typedef typename numeric::traits<Q>::integral integer;
+
+ public:
+  /**\copydoc bailey1997::defaultSeriesIterations */
+  static const N defaultSeriesIterations = 8;
+
+  /**\brief Get sequence member
+   *
+   * Calculates the nth members of both arc tangent series and combines
+   * them.
+   *
+   * \param[in] n The sequence member to calculate.
+   *
+   * \returns The sequence member that was to be calculated.
+   */
+  static constexpr Q at(const N &n) {
+    return Q(n % N(2) == N(0) ? 1 : -1) / Q(N(2) * n + N(1)) *
+           (Q(16) / exponentiate::integral<Q>::raise(Q(5),
+                                                     integer(N(2) * n + N(1))) -
+            Q(4) / exponentiate::integral<Q>::raise(Q(239),
+                                                    integer(N(2) * n + N(1))));
+  }
+
+  /**\brief Bound the error
+   *
+   * Both arc tangent series alternate, with members that get smaller, so
+   * the error of each is less than its first member that was left out.
+   *
+   * \param[in] n Index of the last member in the sum.
+   *
+   * \returns An upper bound for the error of the sum up to the nth member.
+   */
+  static constexpr Q tail(const N &n) {
+    return (Q(16) / exponentiate::integral<Q>::raise(Q(5),
+                                                     integer(N(2) * n + N(3))) +
+            Q(4) / exponentiate::integral<Q>::raise(Q(239),
+                                                    integer(N(2) * n + N(3)))) /
+           Q(N(2) * n + N(3));
+  }
+};
+
+/**\brief The Chudnovsky brothers' pi formula
+ *
+ * Calculates pi with the series published by David and Gregory Chudnovsky
+ * in 1988:
+ *
+ *     426880 sqrt(10005) / pi =
+ *       sum (-1)^n (6n)! (13591409 + 545140134n) / ((3n)! (n!)^3 640320^3n)
+ *
+ * Each member adds about 14 decimal digits. The series sums to the
+ * left hand side, so the algorithm provides a finish() function that
+ * turns that into pi, and a termRatio() function for the binary
+ * splitting summation policy, which is the fastest way to get a lot of
+ * digits.
+ *
+ * \tparam Q The data type to use in the calculations, e.g. double.
+ * \tparam N Sequence index type.
+ */
+template <typename Q, typename N>
+class chudnovsky {
+ protected:
+  /**\copydoc bailey1997::integer */
+  typedef typename numeric::traits<Q>::integral integer;
+
+ public:
+  /**\copydoc bailey1997::defaultSeriesIterations */
+  static const N defaultSeriesIterations = 1;
+
+  /**\brief Get sequence member
+   *
+   * Calculates a member of the sequence by multiplying up the ratios of
+   * all the members before it, which is a lot cheaper than the three
+   * factorials in the formula.
+   *
+   * \param[in] n The sequence member to calculate.
+   *
+   * \returns The sequence member that was to be calculated.
+   */
+  static constexpr Q at(const N &n) {
+    Q c = Q(1);
+
+    for (N k = 1; k <= n; k++) {
+      c *= factorialRatio(k);
+    }
+
+    return c * linear(n);
+  }
+
+  /**\brief Get next sequence member
+   *
+   * Calculates a member of the sequence from the previous one.
+   *
+   * \param[in] previous The sequence member before the one to calculate.
+   * \param[in] n        The sequence member to calculate.
+   *
+   * \returns The sequence member that was to be calculated.
+   */
+  static constexpr Q next(const Q &previous, const N &n) {
+    return previous * factorialRatio(n) * linear(n) / linear(n - N(1));
+  }
+
+  /**\brief Get term ratio
+   *
+   * Describes a member of the sequence for the binary splitting summation
+   * policy. The factorials are turned into a ratio of cubic polynomials,
+   * and the linear part is the member's own factor.
+   *
+   * \param[in] n The sequence member to describe.
+   *
+   * \returns The term ratio of the sequence member.
+   */
+  static series::ratio<integer> termRatio(const N &n) {
+    if (n == N(0)) {
+      return {integer(1), integer(1), integer(13591409), integer(1)};
+    }
+
+    const integer k(n);
+
+    return {-((integer(6) * k - integer(5)) * (integer(2) * k - integer(1)) *
+              (integer(6) * k - integer(1))),
+            k * k * k * integer(10939058860032000LL),
+            integer(13591409) + integer(545140134) * k, integer(1)};
+  }
+
+  /**\brief Turn the sum into pi
+   *
+   * Divides 426880 sqrt(10005) by the sum. The square root is
+   * calculated with Newton's method, with as many iterations as needed
+   * to match the precision of the sum.
+   *
+   * \param[in] sum The sum of the series.
+   * \param[in] n   Index of the last member in the sum.
+   *
+   * \returns Pi, as accurately as the sum allows.
+   */
+  static constexpr Q finish(const Q &sum, const N &n) {
+    const N bits = N(48) * (n + N(1)) + N(16);
+    Q r = Q(100);
+
+    for (N b = 12; b < bits; b *= N(2)) {
+      r = (r + Q(10005) / r) / Q(2);
+    }
+
+    return Q(426880) * r / sum;
+  }
+
+  /**\brief Bound the error
+   *
+   * The series alternates, and the factorial part of each member is less
+   * than 1/151931373056000 times that of the previous one, so the error
+   * of the sum is less than (13591409 + 545140134(n+1)) times
+   * 151931373056000^-(n+1). finish() divides a number below 4.3*10^7 by
+   * two sums that are both above 1.3*10^7, which shrinks the error by a
+   * factor of at least 4*10^6. The error of the square root is a lot
+   * smaller than that, so doubling the bound covers it.
+   *
+   * \param[in] n Index of the last member in the sum.
+   *
+   * \returns An upper bound for the error of pi calculated with the sum
+   *          up to the nth member.
+   */
+  static constexpr Q tail(const N &n) {
+    return linear(n + N(1)) /
+           (Q(2000000) * exponentiate::integral<Q>::raise(
+                             Q(151931373056000LL), integer(n + N(1))));
+  }
+
+ protected:
+  /**\brief Ratio of the factorials
+   *
+   * The factorial part of the nth member divided by that of the member
+   * before it, including the alternating sign.
+   *
+   * \param[in] n The sequence member to calculate the ratio for.
+   *
+   * \returns (6n-5)(2n-1)(6n-1) / (-10939058860032000 n^3).
+   */
+  static constexpr Q factorialRatio(const N &n) {
+    return Q(N(6) * n - N(5)) * Q(N(2) * n - N(1)) * Q(N(6) * n - N(1)) /
+           (Q(n) * Q(n) * Q(n) * Q(-10939058860032000LL));
+  }
+
+  /**\brief Linear part of a member
+   *
+   * \param[in] n The sequence member to calculate the factor for.
+   *
+   * \returns 13591409 + 545140134n.
+   */
+  static constexpr Q linear(const N &n) {
+    return Q(13591409) + Q(545140134) * Q(n);
+  }
+};
+
+/**\brief Bailey-Borwein-Plouffe digit extraction
+ *
+ * The formula behind bailey1997 lends itself to calculating hexadecimal
+ * digits of pi at an arbitrary position without calculating the ones
+ * before it: multiplying each of its four sums by 16^n only moves the
+ * binary point, and the integral parts of the first n terms can be
+ * dropped by calculating 16^(n-k) modulo 8k+j. That takes O(n log n)
+ * time and constant memory.
+ *
+ * The sums are accumulated in Q, so the result is only as good as Q's
+ * precision allows; with long double, the first few hex digits of the
+ * fractional part are correct for positions well into the millions. The
+ * squares of the moduli, 8n+6, have to fit into N.
+ *
+ * \tparam Q Floating point type to accumulate the sums with.
+ * \tparam N Integer type for positions and modular arithmetic.
+ */
+template <typename Q = long double, typename N = unsigned long long>
+class bbpDigits {
+ public:
+  /**\brief Fractional part of 16^n pi
+   *
+   * Combines the four sums of the BBP formula, shifted by n hexadecimal
+   * digits.
+   *
+   * \param[in] n How many hexadecimal digits to skip.
+   *
+   * \returns The fractional part of 16^n pi, in [0,1).
+   */
+  static Q fraction(const N &n) {
+    Q s = Q(4) * sum(n, N(1)) - Q(2) * sum(n, N(4)) - sum(n, N(5)) -
+          sum(n, N(6));
+
+    return s - std::floor(s);
+  }
+
+ protected:
+  /**\brief Shifted partial sum
+   *
+   * Calculates the fractional part of the sum of 16^(n-k)/(8k+j) over all
+   * k >= 0. Terms with k <= n are taken modulo 1 by reducing 16^(n-k)
+   * modulo 8k+j, and the rest are added until they fall below Q's
+   * precision.
+   *
+   * \param[in] n How many hexadecimal digits to skip.
+   * \param[in] j Which of the four sums to calculate.
+   *
+   * \returns The fractional part of the shifted sum.
+   */
+  static Q sum(const N &n, const N &j) {
+    Q s = Q(0);
+
+    for (N k = 0; k <= n; k++) {
+      const N m = N(8) * k + j;
+      s += Q(exponentiate::modular<N>(N(16), n - k, m)) / Q(m);
+      s -= std::floor(s);
+    }
+
+    Q p = Q(1);
+
+    for (N k = n + N(1);; k++) {
+      p /= Q(16);
+      const Q t = p / Q(N(8) * k + j);
+      if (s + t == s) {
+        break;
+      }
+      s += t;
+    }
+
+    return s - std::floor(s);
+  }
 };
 };  // namespace algorithm
 
@@ -98,6 +474,11 @@ class bailey1997 {
  *                    with numeric::traits<Q> defined.
  * \tparam N          Base integral type; used to specify the
  *                    precision.
+ * \tparam summation  How to sum up the series; see series::termwise and
+ *                    series::binarySplitting.
+ * \tparam method     The algorithm to use; algorithm::bailey1997 by
+ *                    default, algorithm::machin and algorithm::chudnovsky
+ *                    converge faster.
  *
  * This class may look rather curious, so I should probably explain how
  * to use it. The idea is to create an instance of the pi class with the
@@ -131,6 +512,21 @@ class bailey1997 {
  * (double)math::pi<double>();
  * \endcode
  *
+ * For a lot of digits, use fractions of big integers and the binary
+ * splitting summation policy, which sums the series in a product tree
+ * rather than one term at a time:
+ *
+ * \code{.cpp}
+ * math::Q p = math::pi<math::Q, unsigned long long,
+ *                      math::series::binarySplitting>::get(1000);
+ * \endcode
+ *
+ * Or let pi::toPrecision pick the algorithm and number of terms for you:
+ *
+ * \code{.cpp}
+ * math::Q p = math::pi<math::Q>::toPrecision(100000);
+ * \endcode
+ *
  * And finally, in case you're wondering why this has been implemented
  * as a class template that acts like a function template, as opposed to
  * an actual function template, consider this: you can re-specialise
@@ -143,8 +539,145 @@ class bailey1997 {
  * that at this point that's all theoretical, but it's getting there and
  * I really do think this would be a good thing in the end.
  */
-template <typename Q, typename N = unsigned long long>
-using pi = series::series<Q, algorithm::bailey1997, N>;
+template <typename Q, typename N = unsigned long long,
+          typename summation = series::termwise,
+          template <typename, typename> class method = algorithm::bailey1997>
+class pi : public series::series<Q, method, N, summation> {
+ public:
+  /**\brief The series this is based on */
+  typedef series::series<Q, method, N, summation> base;
+
+  using base::base;
+
+  /**\brief Calculate pi to a precision
+   *
+   * Picks an algorithm and the number of terms so that the result is
+   * accurate to the given number of bits after the binary point. Up to
+   * 64 bits, which covers machine floating point types, this is
+   * algorithm::machin. Above that it is algorithm::chudnovsky, summed up
+   * with the binary splitting policy if Q has an arbitrary precision
+   * integral type. The number of terms comes from series::termsFor.
+   *
+   * Fractions of built-in integers overflow long before either series
+   * converges, so for those pi is calculated as a long double and
+   * rounded to a multiple of 2^-bits. The denominator is kept to half
+   * the width of the integer type, so the result is only guaranteed to
+   * be accurate to that many bits, and products of two such fractions
+   * still fit.
+   *
+   * This ignores the method template argument; use the series template
+   * directly to calculate pi to a precision with a specific algorithm.
+   *
+   * \param[in] bits How many bits after the binary point should be
+   *                 accurate.
+   *
+   * \returns Pi, to the given precision.
+   */
+  static Q toPrecision(const N &bits) {
+    typedef typename numeric::traits<Q>::integral integral;
+
+    if constexpr (numeric::builtinFraction<Q>::value) {
+      const N half = N(std::numeric_limits<integral>::digits / 2);
+      const int k = int(bits < half ? bits : half);
+
+      return Q(integral(std::round(
+                   std::ldexp(pi<long double, N>::toPrecision(N(64)), k))),
+               integral(1) << k);
+    }
+
+    typedef typename std::conditional<std::is_integral<integral>::value,
+                                      series::termwise,
+                                      series::binarySplitting>::type precise;
+
+    if (bits <= N(64)) {
+      return series::series<Q, algorithm::machin, N>::toPrecision(bits);
+    }
+
+    return series::series<Q, algorithm::chudnovsky, N, precise>::toPrecision(
+        bits);
+  }
+};
+
+/**\brief Hexadecimal digit of pi
+ *
+ * Calculates a single hexadecimal digit of pi's fractional part with
+ * algorithm::bbpDigits, without calculating any of the digits before it.
+ * Positions start at 0, so piHexDigit(0) is 2, piHexDigit(1) is 4 and so
+ * on, as pi is 3.243F6A88... in hexadecimal.
+ *
+ * \tparam N Integer type for the position. It is not deduced from the
+ *           argument, as the BBP sums square moduli of about 8n, which
+ *           overflow narrow types like int for positions in the tens of
+ *           thousands.
+ *
+ * \param[in] n The position of the digit.
+ *
+ * \returns The digit, in [0,15].
+ */
+template <typename N = unsigned long long>
+unsigned int piHexDigit(const typename std::common_type<N>::type &n) {
+  return (unsigned int)(16 * algorithm::bbpDigits<long double, N>::fraction(n));
+}
+
+/**\brief Range of hexadecimal digits of pi
+ *
+ * Calculates count hexadecimal digits of pi's fractional part, starting
+ * at position first. Every evaluation of the BBP sums yields several
+ * correct digits, so the range is split into blocks of six digits, and
+ * the blocks are spread over a number of threads. Later blocks take
+ * longer to calculate, so the threads take turns rather than each taking
+ * a contiguous part of the range. The result does not depend on the
+ * number of threads.
+ *
+ * \tparam N Integer type for the positions; not deduced, as with
+ *           piHexDigit().
+ *
+ * \param[in] first   The position of the first digit.
+ * \param[in] count   How many digits to calculate.
+ * \param[in] threads How many threads to use; defaults to the number of
+ *                    hardware threads.
+ *
+ * \returns The digits, each in [0,15].
+ */
+template <typename N = unsigned long long>
+std::vector<unsigned int> piHexDigits(
+    const typename std::common_type<N>::type &first,
+    const typename std::common_type<N>::type &count,
+    unsigned int threads = std::thread::hardware_concurrency()) {
+  static const N block = 6;
+  const N blocks = (count + block - N(1)) / block;
+  std::vector<unsigned int> digits(count);
+  std::vector<std::thread> workers;
+
+  if (threads == 0) {
+    threads = 1;
+  }
+  if (N(threads) > blocks) {
+    threads = (unsigned int)blocks;
+  }
+
+  for (unsigned int t = 0; t < threads; t++) {
+    workers.emplace_back([&, t]() {
+      for (N b = t; b < blocks; b += threads) {
+        long double f =
+            algorithm::bbpDigits<long double, N>::fraction(first + b * block);
+
+        for (N i = b * block; (i < count) && (i < (b + N(1)) * block); i++) {
+          f *= 16;
+          const unsigned int d = (unsigned int)f;
+          digits[i] = d;
+          f -= d;
+        }
+      }
+    });
+  }
+
+  for (auto &w : workers) {
+    w.join();
+  }
+
+  return digits;
+}
 };  // namespace math
 };  // namespace efgy
 
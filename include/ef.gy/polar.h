@@ -43,7 +43,8 @@ class polar {
    * Specifies the precision to use for real<>polar vector
    * format conversions. This precision refers to the
    * iterations parameter in the trigonometric functions,
-   * which in turn is passed along to the complex e function.
+   * which in turn is the number of terms of the power series
+   * for the sine and cosine.
    *
    * \note The precision is ignored when using the float,
    *       double or long double types, as these automatically
@@ -154,10 +155,13 @@ class vector<F, n, format::polar> : public std::array<F, n> {
     {
       const unsigned int p = i + 1;
 
-      v[i] *= math::cosine((*this)[p], spaceTag.precision);
+      F c;
+      const F s = math::sines((*this)[p], c, spaceTag.precision);
+
+      v[i] *= c;
 
       for (unsigned int j = p; j < n; j++) {
-        v[j] *= math::sine((*this)[p], spaceTag.precision);
+        v[j] *= s;
       }
     }
 
@@ -1,4 +1,12 @@
 /**\file
+ * \brief Polynomials
+ *
+ * Polynomials with a fixed number of coefficients, and with a number of
+ * coefficients that is only known at run time. Both evaluate with Horner's
+ * scheme and multiply with Karatsuba's algorithm once there are enough
+ * coefficients; polynomials with big integer coefficients are multiplied
+ * with a single big integer multiplication instead, which switches to
+ * number-theoretic transforms for large enough operands.
  *
  * \copyright
  * This file is part of the libefgy project, which is released as open source
@@ -12,14 +20,493 @@
 #if !defined(EF_GY_POLYNOMIAL_H)
 #define EF_GY_POLYNOMIAL_H
 
+#include <ef.gy/big-integers.h>
+#include <ef.gy/simd.h>
+#include <ef.gy/traits.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
 namespace efgy {
 namespace math {
+/**\brief Kronecker substitution
+ *
+ * Multiplies polynomials by evaluating them at a large enough power of two
+ * and multiplying the results. Only big integer coefficients support this,
+ * see the specialisation below.
+ *
+ * \tparam Q Coefficient type.
+ */
+template <typename Q>
+class kroneckerSubstitution {
+ public:
+  static const bool applies = false;
+
+  static void multiply(Q *, const Q *, std::size_t, const Q *, std::size_t) {}
+};
+
+/**\brief Kronecker substitution for big integers
+ *
+ * Packs the coefficients of each polynomial into one big integer, with
+ * enough bits per coefficient for the largest coefficient of the product,
+ * multiplies those and unpacks the product. Packing and unpacking split
+ * the coefficients in halves, so that they only take O(n log n) cell
+ * operations. Coefficients are split into their positive and negative
+ * parts, as the packed form would otherwise have to borrow between them.
+ */
+template <typename Ts, typename Tu, typename cellType,
+          unsigned int cellBitCount, std::size_t inlineCells>
+class kroneckerSubstitution<
+    numeric::bigIntegers<Ts, Tu, cellType, cellBitCount, inlineCells>> {
+ public:
+  typedef numeric::bigIntegers<Ts, Tu, cellType, cellBitCount, inlineCells> Q;
+
+  static const bool applies = true;
+
+  /**\brief Multiply
+   *
+   * \param[out] r  The an + bn - 1 coefficients of the product.
+   * \param[in]  a  The coefficients of the first factor.
+   * \param[in]  an Number of coefficients of a.
+   * \param[in]  b  The coefficients of the second factor.
+   * \param[in]  bn Number of coefficients of b.
+   */
+  static void multiply(Q *r, const Q *a, std::size_t an, const Q *b,
+                       std::size_t bn) {
+    std::vector<Q> ap(an), am(an), bp(bn), bm(bn);
+    const std::size_t n = an + bn - 1;
+    const cellType bits = cellType(split(a, an, ap, am) + split(b, bn, bp, bm) +
+                                   bitLength(std::min(an, bn)) + 1);
+    const Q pa = pack(ap.data(), an, bits), ma = pack(am.data(), an, bits),
+            pb = pack(bp.data(), bn, bits), mb = pack(bm.data(), bn, bits);
+    std::vector<Q> t(n);
+
+    std::fill(r, r + n, Q(0));
+
+    const Q *factors[4][2] = {{&pa, &pb}, {&ma, &mb}, {&pa, &mb}, {&ma, &pb}};
+
+    for (std::size_t f = 0; f < 4; f++) {
+      const Q &x = *factors[f][0], &y = *factors[f][1];
+
+      if ((x == Q(0)) || (y == Q(0))) {
+        continue;
+      }
+
+      unpack(x * y, bits, t.data(), n);
+
+      for (std::size_t i = 0; i < n; i++) {
+        if (f < 2) {
+          r[i] += t[i];
+        } else {
+          r[i] -= t[i];
+        }
+      }
+    }
+  }
+
+ protected:
+  /**\brief Split into positive and negative parts
+   *
+   * \returns The largest bit length of the coefficients.
+   */
+  static std::size_t split(const Q *a, std::size_t n, std::vector<Q> &p,
+                           std::vector<Q> &m) {
+    std::size_t bits = 0;
+
+    for (std::size_t i = 0; i < n; i++) {
+      if (a[i] < Q(0)) {
+        p[i] = Q(0);
+        m[i] = -a[i];
+      } else {
+        p[i] = a[i];
+        m[i] = Q(0);
+      }
+      bits = std::max(bits, a[i].bitLength());
+    }
+
+    return bits;
+  }
+
+  static std::size_t bitLength(std::size_t n) {
+    std::size_t bits = 0;
+
+    for (; n > 0; n >>= 1) {
+      bits++;
+    }
+
+    return bits;
+  }
+
+  static Q pack(const Q *a, std::size_t n, cellType bits) {
+    if (n == 1) {
+      return a[0];
+    }
+
+    const std::size_t h = n / 2;
+
+    return pack(a, h, bits) + (pack(a + h, n - h, bits) << cellType(h * bits));
+  }
+
+  static void unpack(const Q &v, cellType bits, Q *r, std::size_t n) {
+    if (n == 1) {
+      r[0] = v;
+      return;
+    }
+
+    const std::size_t h = n / 2;
+    const cellType shift = cellType(h * bits);
+
+    // shifting right by more bits than the value has is not safe
+    if (v.bitLength() <= shift) {
+      unpack(v, bits, r, h);
+      std::fill(r + h, r + n, Q(0));
+      return;
+    }
+
+    const Q high = v >> shift;
+    unpack(v - (high << shift), bits, r, h);
+    unpack(high, bits, r + h, n - h);
+  }
+};
+
+/**\brief Polynomial arithmetic
+ *
+ * The algorithms that the polynomial templates are built on, working on
+ * plain arrays of coefficients, lowest power first.
+ *
+ * \tparam Q Coefficient type.
+ */
+template <typename Q>
+class polynomialArithmetic {
+ public:
+  /**\brief Coefficients for Karatsuba multiplication
+   *
+   * Products with fewer coefficients in the shorter factor than this are
+   * calculated with the schoolbook algorithm.
+   */
+  static constexpr std::size_t karatsubaThreshold = 48;
+
+  /**\brief Coefficients for Kronecker substitution
+   *
+   * Products of big integer polynomials with at least this many
+   * coefficients in the shorter factor use kroneckerSubstitution.
+   */
+  static constexpr std::size_t kroneckerThreshold = 32;
+
+  /**\brief Coefficients for Estrin's scheme
+   *
+   * Vectorised evaluation of polynomials with no more coefficients than
+   * this uses Horner's scheme on each vector instead.
+   */
+  static constexpr std::size_t estrinThreshold = 16;
+
+  /**\brief Evaluate with Horner's scheme
+   *
+   * \param[in] c The coefficients.
+   * \param[in] n Number of coefficients.
+   * \param[in] x Where to evaluate the polynomial.
+   *
+   * \returns The value of the polynomial at x.
+   */
+  static Q evaluate(const Q *c, std::size_t n, const Q &x) {
+    if (n == 0) {
+      return Q(0);
+    }
+
+    Q r = c[n - 1];
+
+    for (std::size_t i = n - 1; i-- > 0;) {
+      r *= x;
+      r += c[i];
+    }
+
+    return r;
+  }
+
+  /**\brief Evaluate at many points
+   *
+   * Uses estrin() for types with a vector kernel in simd.h, i.e. float and
+   * double, and runs Horner's scheme on four points at a time otherwise,
+   * which gives the processor four independent chains of multiplications
+   * and additions to work on instead of one.
+   *
+   * \param[in]  c     The coefficients.
+   * \param[in]  n     Number of coefficients.
+   * \param[in]  x     Where to evaluate the polynomial.
+   * \param[out] out   The values of the polynomial at each x.
+   * \param[in]  count Number of points.
+   */
+  static void evaluate(const Q *c, std::size_t n, const Q *x, Q *out,
+                       std::size_t count) {
+    if constexpr (simd::kernel<Q>::vectorised) {
+      estrin(c, n, x, out, nullptr, count);
+      return;
+    }
+
+    std::size_t j = 0;
+
+    for (; (n > 0) && (j + 4 <= count); j += 4) {
+      Q r0 = c[n - 1], r1 = r0, r2 = r0, r3 = r0;
+
+      for (std::size_t i = n - 1; i-- > 0;) {
+        r0 = r0 * x[j] + c[i];
+        r1 = r1 * x[j + 1] + c[i];
+        r2 = r2 * x[j + 2] + c[i];
+        r3 = r3 * x[j + 3] + c[i];
+      }
+
+      out[j] = r0;
+      out[j + 1] = r1;
+      out[j + 2] = r2;
+      out[j + 3] = r3;
+    }
+
+    for (; j < count; j++) {
+      out[j] = evaluate(c, n, x[j]);
+    }
+  }
+
+  /**\brief Evaluate with the derivative at many points
+   *
+   * Calculates the values of the polynomial and of its derivative in the
+   * same pass over the points, which saves loading the points twice and,
+   * for float and double, calculating the powers of x that estrin() needs
+   * twice. Other types run Horner's scheme on both at once.
+   *
+   * \param[in]  c          The coefficients.
+   * \param[in]  n          Number of coefficients.
+   * \param[in]  x          Where to evaluate the polynomial.
+   * \param[out] value      The values of the polynomial at each x.
+   * \param[out] derivative The values of the derivative at each x.
+   * \param[in]  count      Number of points.
+   */
+  static void evaluate(const Q *c, std::size_t n, const Q *x, Q *value,
+                       Q *derivative, std::size_t count) {
+    if constexpr (simd::kernel<Q>::vectorised) {
+      estrin(c, n, x, value, derivative, count);
+      return;
+    }
+
+    for (std::size_t j = 0; j < count; j++) {
+      Q r = n > 0 ? c[n - 1] : Q(0), d = Q(0);
+
+      for (std::size_t i = n - 1; (n > 0) && (i-- > 0);) {
+        d = d * x[j] + r;
+        r = r * x[j] + c[i];
+      }
+
+      value[j] = r;
+      derivative[j] = d;
+    }
+  }
+
+ protected:
+  /**\brief Estrin's scheme on vectors
+   *
+   * Evaluates one vector of points at a time: pairs of coefficients are
+   * combined into c[2i] + c[2i+1] x, pairs of those with x^2, then with
+   * x^4 and so on. That takes about as many operations as Horner's scheme,
+   * but the longest chain of operations that depend on each other only
+   * grows with the logarithm of the degree, so the processor can overlap
+   * them.
+   *
+   * \param[in]  c          The coefficients.
+   * \param[in]  n          Number of coefficients.
+   * \param[in]  x          Where to evaluate the polynomial.
+   * \param[out] value      The values of the polynomial at each x.
+   * \param[out] derivative The values of the derivative at each x; may be
+   *                        null.
+   * \param[in]  count      Number of points.
+   */
+  static void estrin(const Q *c, std::size_t n, const Q *x, Q *value,
+                     Q *derivative, std::size_t count) {
+    typedef typename simd::kernel<Q>::type type;
+    std::vector<Q> d(n > 1 ? n - 1 : 1, Q(0));
+    std::vector<type> s((n + 1) / 2 + 1), t(n / 2 + 1);
+
+    for (std::size_t i = 1; i < n; i++) {
+      d[i - 1] = Q(i) * c[i];
+    }
+
+    simd::map<Q>(count, {x, nullptr}, {value, derivative},
+                 [&](const type(&a)[2], type(&r)[2]) {
+                   r[0] = combine(c, n, a[0], s.data());
+                   if (derivative) {
+                     r[1] = combine(d.data(), n - (n > 0), a[0], t.data());
+                   }
+                 });
+  }
+
+  /**\brief Combine coefficients pairwise
+   *
+   * Polynomials with up to estrinThreshold coefficients run Horner's
+   * scheme on the vector instead; for those the lanes already give the
+   * processor enough independent work, and the scratch space only costs
+   * loads and stores.
+   *
+   * \param[in] c The coefficients.
+   * \param[in] n Number of coefficients.
+   * \param[in] x The points.
+   * \param[in] s Scratch space for (n + 1) / 2 vectors.
+   *
+   * \returns The values of the polynomial at x.
+   */
+  template <typename V>
+  static V combine(const Q *c, std::size_t n, const V &x, V *s) {
+    if (n <= estrinThreshold) {
+      V r = V{} + (n > 0 ? c[n - 1] : Q(0));
+
+      for (std::size_t i = n - 1; (n > 0) && (i-- > 0);) {
+        r = r * x + c[i];
+      }
+
+      return r;
+    }
+
+    std::size_t m = (n + 1) / 2;
+    V p = x * x;
+
+    for (std::size_t i = 0; i < n / 2; i++) {
+      s[i] = c[2 * i] + c[2 * i + 1] * x;
+    }
+    if (n % 2) {
+      s[m - 1] = V{} + c[n - 1];
+    }
+
+    for (; m > 1; m = (m + 1) / 2, p *= p) {
+      for (std::size_t i = 0; i < m / 2; i++) {
+        s[i] = s[2 * i] + s[2 * i + 1] * p;
+      }
+      if (m % 2) {
+        s[m / 2] = s[m - 1];
+      }
+    }
+
+    return s[0];
+  }
+
+ public:
+  /**\brief Multiply
+   *
+   * Picks the schoolbook algorithm, Karatsuba's algorithm or Kronecker
+   * substitution depending on the coefficient type and the number of
+   * coefficients.
+   *
+   * \param[out] r  The an + bn - 1 coefficients of the product; must not
+   *                overlap with a or b.
+   * \param[in]  a  The coefficients of the first factor.
+   * \param[in]  an Number of coefficients of a; at least one.
+   * \param[in]  b  The coefficients of the second factor.
+   * \param[in]  bn Number of coefficients of b; at least one.
+   */
+  static void multiply(Q *r, const Q *a, std::size_t an, const Q *b,
+                       std::size_t bn) {
+    if (an < bn) {
+      std::swap(a, b);
+      std::swap(an, bn);
+    }
+
+    if (kroneckerSubstitution<Q>::applies && (bn >= kroneckerThreshold)) {
+      kroneckerSubstitution<Q>::multiply(r, a, an, b, bn);
+    } else if (bn < karatsubaThreshold) {
+      schoolbook(r, a, an, b, bn);
+    } else {
+      // multiply slices of a with the same length as b, and add them up
+      std::vector<Q> t(2 * bn - 1);
+      std::fill(r, r + an + bn - 1, Q(0));
+
+      for (std::size_t o = 0; o < an; o += bn) {
+        const std::size_t l = std::min(bn, an - o);
+
+        if (l == bn) {
+          karatsuba(t.data(), a + o, b, bn);
+        } else {
+          multiply(t.data(), a + o, l, b, bn);
+        }
+
+        for (std::size_t i = 0; i < l + bn - 1; i++) {
+          r[o + i] += t[i];
+        }
+      }
+    }
+  }
+
+  /**\brief Schoolbook multiplication
+   *
+   * \param[out] r  The an + bn - 1 coefficients of the product.
+   * \param[in]  a  The coefficients of the first factor.
+   * \param[in]  an Number of coefficients of a.
+   * \param[in]  b  The coefficients of the second factor.
+   * \param[in]  bn Number of coefficients of b.
+   */
+  static void schoolbook(Q *r, const Q *a, std::size_t an, const Q *b,
+                         std::size_t bn) {
+    std::fill(r, r + an + bn - 1, Q(0));
+
+    for (std::size_t i = 0; i < an; i++) {
+      for (std::size_t j = 0; j < bn; j++) {
+        r[i + j] += a[i] * b[j];
+      }
+    }
+  }
+
+  /**\brief Karatsuba multiplication
+   *
+   * Splits both factors into a lower half with l and an upper half with h
+   * coefficients and gets by with three half-sized products,
+   * a0 b0, a1 b1 and (a0 + a1) (b0 + b1).
+   *
+   * \param[out] r The 2n - 1 coefficients of the product.
+   * \param[in]  a The coefficients of the first factor.
+   * \param[in]  b The coefficients of the second factor.
+   * \param[in]  n Number of coefficients of a and b.
+   */
+  static void karatsuba(Q *r, const Q *a, const Q *b, std::size_t n) {
+    if (n < karatsubaThreshold) {
+      schoolbook(r, a, n, b, n);
+      return;
+    }
+
+    const std::size_t h = n / 2, l = n - h;
+    std::vector<Q> sa(a, a + l), sb(b, b + l), m(2 * l - 1);
+
+    for (std::size_t i = 0; i < h; i++) {
+      sa[i] += a[l + i];
+      sb[i] += b[l + i];
+    }
+
+    karatsuba(r, a, b, l);
+    r[2 * l - 1] = Q(0);
+    karatsuba(r + 2 * l, a + l, b + l, h);
+    karatsuba(m.data(), sa.data(), sb.data(), l);
+
+    for (std::size_t i = 0; i < 2 * l - 1; i++) {
+      m[i] -= r[i];
+    }
+    for (std::size_t i = 0; i < 2 * h - 1; i++) {
+      m[i] -= r[2 * l + i];
+    }
+    for (std::size_t i = 0; i < 2 * l - 1; i++) {
+      r[l + i] += m[i];
+    }
+  }
+};
+
+/**\brief Polynomial with a fixed number of coefficients
+ *
+ * \tparam Q      Coefficient type.
+ * \tparam degree Number of coefficients, i.e. one more than the highest
+ *                power of the variable; 0 selects the polynomial with a
+ *                number of coefficients that is set at run time.
+ */
 template <typename Q, unsigned int degree>
 class polynomial {
  public:
-  typedef typename Q::integer integer;
+  typedef typename numeric::traits<Q>::integral integer;
 
-  polynomial() {}
+  polynomial() : coefficients() {}
 
   polynomial &operator=(const polynomial &b) {
     for (unsigned int i = 0; i < degree; i++) {
@@ -41,11 +528,15 @@ class polynomial {
 
   polynomial operator+(const Q &b) const {
     polynomial r = *this;
-    r.coefficients[0] + b;
+    r.coefficients[0] += b;
     return r;
   }
 
-  polynomial operator+(const integer &b) const { return (*this) + Q(b); }
+  template <typename I = integer>
+  typename std::enable_if<!std::is_same<I, Q>::value, polynomial>::type
+  operator+(const integer &b) const {
+    return (*this) + Q(b);
+  }
 
   polynomial &operator+=(const polynomial &b) {
     return ((*this) = ((*this) + b));
@@ -53,7 +544,11 @@ class polynomial {
 
   polynomial &operator+=(const Q &b) { return ((*this) = ((*this) + b)); }
 
-  polynomial &operator+=(const integer &b) { return ((*this) = ((*this) + b)); }
+  template <typename I = integer>
+  typename std::enable_if<!std::is_same<I, Q>::value, polynomial &>::type
+  operator+=(const integer &b) {
+    return ((*this) = ((*this) + b));
+  }
 
   polynomial operator-(const polynomial &b) const {
     polynomial r;
@@ -67,11 +562,15 @@ class polynomial {
 
   polynomial operator-(const Q &b) const {
     polynomial r = *this;
-    r.coefficients[0] - b;
+    r.coefficients[0] -= b;
     return r;
   }
 
-  polynomial operator-(const integer &b) const { return (*this) - Q(b); }
+  template <typename I = integer>
+  typename std::enable_if<!std::is_same<I, Q>::value, polynomial>::type
+  operator-(const integer &b) const {
+    return (*this) - Q(b);
+  }
 
   polynomial &operator-=(const polynomial &b) {
     return ((*this) = ((*this) - b));
@@ -79,17 +578,26 @@ class polynomial {
 
   polynomial &operator-=(const Q &b) { return ((*this) = ((*this) - b)); }
 
-  polynomial &operator-=(const integer &b) { return ((*this) = ((*this) - b)); }
+  template <typename I = integer>
+  typename std::enable_if<!std::is_same<I, Q>::value, polynomial &>::type
+  operator-=(const integer &b) {
+    return ((*this) = ((*this) - b));
+  }
 
+  /**\brief Multiply
+   *
+   * \tparam f Number of coefficients of the other factor.
+   *
+   * \param[in] b The other factor.
+   *
+   * \returns The product, with all degree + f - 1 of its coefficients.
+   */
   template <unsigned int f>
-  polynomial<Q, (degree * f)> operator*(const polynomial<Q, f> &b) const {
-    polynomial<Q, (degree * f)> r;
+  polynomial<Q, (degree + f - 1)> operator*(const polynomial<Q, f> &b) const {
+    polynomial<Q, (degree + f - 1)> r;
 
-    for (unsigned int i = 0; i < degree; i++) {
-      for (unsigned int j = 0; j < f; j++) {
-        r.coefficients[(i * j)] += coefficients[i] * b.coefficients[j];
-      }
-    }
+    polynomialArithmetic<Q>::multiply(r.coefficients, coefficients, degree,
+                                      b.coefficients, f);
 
     return r;
   }
@@ -104,7 +612,11 @@ class polynomial {
     return r;
   }
 
-  polynomial operator*(const integer &b) const { return (*this) * Q(b); }
+  template <typename I = integer>
+  typename std::enable_if<!std::is_same<I, Q>::value, polynomial>::type
+  operator*(const integer &b) const {
+    return (*this) * Q(b);
+  }
 
   polynomial operator/(const Q &b) const {
     polynomial r;
@@ -116,9 +628,13 @@ class polynomial {
     return r;
   }
 
-  polynomial operator/(const integer &b) const { return (*this) / Q(b); }
+  template <typename I = integer>
+  typename std::enable_if<!std::is_same<I, Q>::value, polynomial>::type
+  operator/(const integer &b) const {
+    return (*this) / Q(b);
+  }
 
-  template <unsigned int f>
+  template <unsigned int f, typename = typename std::enable_if<(f > 0)>::type>
   operator polynomial<Q, f>(void) const {
     polynomial<Q, f> r;
 
@@ -129,17 +645,181 @@ class polynomial {
     return r;
   }
 
+  /**\brief Evaluate
+   *
+   * \param[in] x Where to evaluate the polynomial.
+   *
+   * \returns The value of the polynomial at x, calculated with Horner's
+   *          scheme.
+   */
   Q operator()(const Q &x) const {
-    Q r = coefficients[0] * x;
+    return polynomialArithmetic<Q>::evaluate(coefficients, degree, x);
+  }
+
+  /**\brief Evaluate at many points
+   *
+   * \param[in]  xs  Where to evaluate the polynomial.
+   * \param[out] out The values of the polynomial at each of xs.
+   * \param[in]  n   Number of points.
+   */
+  void evaluate(const Q *xs, Q *out, std::size_t n) const {
+    polynomialArithmetic<Q>::evaluate(coefficients, degree, xs, out, n);
+  }
+
+  /**\brief Evaluate with the derivative at many points
+   *
+   * \param[in]  xs         Where to evaluate the polynomial.
+   * \param[out] value      The values of the polynomial at each of xs.
+   * \param[out] derivative The values of its derivative at each of xs.
+   * \param[in]  n          Number of points.
+   */
+  void evaluate(const Q *xs, Q *value, Q *derivative, std::size_t n) const {
+    polynomialArithmetic<Q>::evaluate(coefficients, degree, xs, value,
+                                      derivative, n);
+  }
+
+  Q coefficients[degree];
+};
+
+/**\brief Polynomial with a variable number of coefficients
+ *
+ * The number of coefficients is set at run time, and grows as needed when
+ * polynomials are added or multiplied.
+ *
+ * \tparam Q Coefficient type.
+ */
+template <typename Q>
+class polynomial<Q, 0> {
+ public:
+  typedef typename numeric::traits<Q>::integral integer;
+
+  polynomial() : coefficients() {}
+
+  /**\brief Construct with coefficients
+   *
+   * \param[in] pCoefficients The coefficients, lowest power first.
+   */
+  explicit polynomial(const std::vector<Q> &pCoefficients)
+      : coefficients(pCoefficients) {}
+
+  /**\brief Convert from a fixed number of coefficients
+   *
+   * \param[in] p The polynomial to convert.
+   */
+  template <unsigned int d>
+  polynomial(const polynomial<Q, d> &p)
+      : coefficients(p.coefficients, p.coefficients + d) {}
+
+  polynomial operator+(const polynomial &b) const {
+    polynomial r = *this;
+    return r += b;
+  }
+
+  polynomial &operator+=(const polynomial &b) {
+    if (coefficients.size() < b.coefficients.size()) {
+      coefficients.resize(b.coefficients.size(), Q(0));
+    }
+
+    for (std::size_t i = 0; i < b.coefficients.size(); i++) {
+      coefficients[i] += b.coefficients[i];
+    }
+
+    return *this;
+  }
+
+  polynomial operator-(const polynomial &b) const {
+    polynomial r = *this;
+    return r -= b;
+  }
+
+  polynomial &operator-=(const polynomial &b) {
+    if (coefficients.size() < b.coefficients.size()) {
+      coefficients.resize(b.coefficients.size(), Q(0));
+    }
 
-    for (unsigned int i = 1; i < degree; i++) {
-      r += coefficients[i] * (x ^ integer(i));
+    for (std::size_t i = 0; i < b.coefficients.size(); i++) {
+      coefficients[i] -= b.coefficients[i];
+    }
+
+    return *this;
+  }
+
+  polynomial operator*(const polynomial &b) const {
+    polynomial r;
+
+    if ((coefficients.size() > 0) && (b.coefficients.size() > 0)) {
+      r.coefficients.resize(coefficients.size() + b.coefficients.size() - 1);
+      polynomialArithmetic<Q>::multiply(
+          r.coefficients.data(), coefficients.data(), coefficients.size(),
+          b.coefficients.data(), b.coefficients.size());
     }
 
     return r;
   }
 
-  Q coefficients[degree];
+  polynomial &operator*=(const polynomial &b) { return *this = *this * b; }
+
+  polynomial operator*(const Q &b) const {
+    polynomial r = *this;
+
+    for (Q &c : r.coefficients) {
+      c *= b;
+    }
+
+    return r;
+  }
+
+  polynomial operator/(const Q &b) const {
+    polynomial r = *this;
+
+    for (Q &c : r.coefficients) {
+      c /= b;
+    }
+
+    return r;
+  }
+
+  /**\brief Degree
+   *
+   * \returns The highest power with a coefficient other than zero, or 0
+   *          for polynomials that are zero.
+   */
+  std::size_t degree(void) const {
+    for (std::size_t i = coefficients.size(); i-- > 1;) {
+      if (coefficients[i] != Q(0)) {
+        return i;
+      }
+    }
+
+    return 0;
+  }
+
+  /**\brief Evaluate
+   *
+   * \param[in] x Where to evaluate the polynomial.
+   *
+   * \returns The value of the polynomial at x, calculated with Horner's
+   *          scheme.
+   */
+  Q operator()(const Q &x) const {
+    return polynomialArithmetic<Q>::evaluate(coefficients.data(),
+                                             coefficients.size(), x);
+  }
+
+  /**\copydoc polynomial::evaluate */
+  void evaluate(const Q *xs, Q *out, std::size_t n) const {
+    polynomialArithmetic<Q>::evaluate(coefficients.data(),
+                                      coefficients.size(), xs, out, n);
+  }
+
+  /**\copydoc polynomial::evaluate(const Q *, Q *, Q *, std::size_t) const */
+  void evaluate(const Q *xs, Q *value, Q *derivative, std::size_t n) const {
+    polynomialArithmetic<Q>::evaluate(coefficients.data(),
+                                      coefficients.size(), xs, value,
+                                      derivative, n);
+  }
+
+  std::vector<Q> coefficients;
 };
 };  // namespace math
 };  // namespace efgy
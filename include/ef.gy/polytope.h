@@ -415,7 +415,8 @@ class adaptiveIterator : public iterator {
 template <typename Q, std::size_t d, class model, class format>
 class adapt : public object<Q, model::depth, d, model::faceVertices, format> {
  public:
-  using parent = object<Q, model::depth, d, model::faceVertices, format>;
+  using parent =
+      geometry::object<Q, model::depth, d, model::faceVertices, format>;
   using iterator =
       adaptiveIterator<typename parent::face, typename model::iterator>;
 
@@ -549,7 +550,7 @@ class cube<1> {
 template <typename Q, std::size_t depth>
 class cube {
  public:
-  typedef dimensions<2, 0> dimensions;
+  typedef geometry::dimensions<2, 0> dimensions;
   static constexpr const std::size_t renderDepth = depth;
   static constexpr const std::size_t faceVertices = 4;
   static constexpr const char *id(void) { return "cube"; }
@@ -42,10 +42,13 @@ template <typename C>
 static inline xml::ostream<C> operator<<(
     xml::ostream<C> stream,
     const math::vector<math::fraction, 3, math::format::HSL> &pValue) {
+  const math::fraction::integer maxDenominator = (1LL << stream.precision) - 1;
   math::vector<math::fraction, 3, math::format::HSL> value = pValue;
-  value.hue = math::numeric::round(value.hue, stream.precision);
-  value.saturation = math::numeric::round(value.saturation, stream.precision);
-  value.lightness = math::numeric::round(value.lightness, stream.precision);
+  value.hue = math::numeric::bestApproximation(value.hue, maxDenominator);
+  value.saturation =
+      math::numeric::bestApproximation(value.saturation, maxDenominator);
+  value.lightness =
+      math::numeric::bestApproximation(value.lightness, maxDenominator);
 
   stream.stream << std::string(
                        "<colour xmlns='http://colouri.se/2012' space='hsl'")
@@ -85,10 +88,11 @@ template <typename C>
 static inline xml::ostream<C> operator<<(
     xml::ostream<C> stream,
     const math::vector<math::fraction, 3, math::format::RGB> &pValue) {
+  const math::fraction::integer maxDenominator = (1LL << stream.precision) - 1;
   math::vector<math::fraction, 3, math::format::RGB> value = pValue;
-  value.red = math::numeric::round(value.red, stream.precision);
-  value.green = math::numeric::round(value.green, stream.precision);
-  value.blue = math::numeric::round(value.blue, stream.precision);
+  value.red = math::numeric::bestApproximation(value.red, maxDenominator);
+  value.green = math::numeric::bestApproximation(value.green, maxDenominator);
+  value.blue = math::numeric::bestApproximation(value.blue, maxDenominator);
 
   stream.stream << std::string(
                        "<colour xmlns='http://colouri.se/2012' space='rgb'")
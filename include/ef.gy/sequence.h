@@ -15,8 +15,29 @@
 #if !defined(EF_GY_SEQUENCES_H)
 #define EF_GY_SEQUENCES_H
 
+#include <type_traits>
+#include <utility>
+
 namespace efgy {
 namespace math {
+/* Detect stateful sequence algorithms
+ * @A The sequence algorithm.
+ * @Q Base type for calculations.
+ * @N Base integral type; used for indices into the sequence.
+ *
+ * Derives from std::true_type if the algorithm has a static next()
+ * function that can be called with the previous sequence member and an
+ * index, and from std::false_type otherwise.
+ */
+template <typename A, typename Q, typename N, typename = void>
+class isStateful : public std::false_type {};
+
+template <typename A, typename Q, typename N>
+class isStateful<A, Q, N,
+                 std::void_t<decltype(A::next(std::declval<const Q &>(),
+                                              std::declval<const N &>()))>>
+    : public std::true_type {};
+
 /* Infinite sequence
  * @Q Base type for calculations.
  * @algorithm The algorithm to calculate the sequence members.
@@ -24,11 +45,23 @@ namespace math {
  *
  * Represents an infinite sequence. You need to provide an algrithm to
  * calculate arbitrary members of these sequences.
+ *
+ * Algorithms may also provide a static next(previous, n) function that
+ * calculates the n'th member from the (n-1)'th one. Such sequences are
+ * called stateful, and code that walks through a sequence in order, like
+ * series::termwise, uses next() instead of at() for them.
  */
 template <typename Q, template <typename, typename> class algorithm,
           typename N = unsigned long long>
 class sequence : public algorithm<Q, N> {
  public:
+  /* Whether the sequence is stateful
+   *
+   * Set if the algorithm can calculate a sequence member from the
+   * previous one.
+   */
+  static constexpr bool stateful = isStateful<algorithm<Q, N>, Q, N>::value;
+
   /* Get n'th sequence member
    *
    * Uses the algorithm template to calculate the n'th member of
@@ -40,6 +73,23 @@ class sequence : public algorithm<Q, N> {
    */
   constexpr static Q at(const N &n) { return sequenceAlgorithm::at(n); }
 
+  /* Get n'th sequence member from the previous one
+   * @previous The (n-1)'th sequence member.
+   * @n        The sequence member to return.
+   *
+   * Calculates the n'th member with the algorithm's next() function if
+   * the sequence is stateful, and with at() otherwise.
+   *
+   * @return The n'th sequence member.
+   */
+  constexpr static Q advance(const Q &previous, const N &n) {
+    if constexpr (stateful) {
+      return sequenceAlgorithm::next(previous, n);
+    } else {
+      return sequenceAlgorithm::at(n);
+    }
+  }
+
  protected:
   /* Sequence algorithm
    *
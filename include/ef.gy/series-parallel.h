@@ -0,0 +1,259 @@
+/* Parallel series summation
+ *
+ * Contains summation policies for series::series that spread the terms
+ * over several threads. These are kept apart from series.h, so that
+ * serial users don't need threads.
+ *
+ * See also:
+ * * Project Documentation: https://ef.gy/documentation/libefgy
+ * * Project Source Code: https://github.com/ef-gy/libefgy
+ * * Licence Terms: https://github.com/ef-gy/libefgy/blob/master/COPYING
+ *
+ * @copyright
+ * This file is part of the libefgy project, which is released as open source
+ * under the terms of an MIT/X11-style licence, described in the COPYING file.
+ */
+
+#if !defined(EF_GY_SERIES_PARALLEL_H)
+#define EF_GY_SERIES_PARALLEL_H
+
+#include <ef.gy/series.h>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace efgy {
+namespace math {
+namespace series {
+/* Worker threads
+ * @threads How many threads to use; 0 means one per hardware thread.
+ *
+ * Runs a number of independent tasks on a set of threads that take the
+ * next task as soon as they are done with the previous one. The calling
+ * thread is one of the workers. If a task throws, no new tasks are
+ * started, and the first exception is rethrown once all the threads are
+ * done.
+ */
+template <unsigned int threads = 0>
+class workers {
+ public:
+  /* Run tasks
+   * @tasks How many tasks there are.
+   * @task  Function to run each task; gets the index of the task.
+   */
+  template <typename F>
+  static void run(std::size_t tasks, const F &task) {
+    std::size_t count = threads > 0 ? threads
+                                    : std::thread::hardware_concurrency();
+    std::atomic<std::size_t> next(0);
+    std::vector<std::thread> pool;
+    std::exception_ptr error;
+    std::mutex lock;
+
+    if (count > tasks) {
+      count = tasks;
+    }
+
+    const auto work = [&next, &task, &error, &lock, tasks]() {
+      for (std::size_t t = next++; t < tasks; t = next++) {
+        try {
+          task(t);
+        } catch (...) {
+          std::lock_guard<std::mutex> guard(lock);
+          if (!error) {
+            error = std::current_exception();
+          }
+          next = tasks;
+        }
+      }
+    };
+
+    for (std::size_t i = 1; i < count; i++) {
+      pool.emplace_back(work);
+    }
+
+    work();
+
+    for (auto &t : pool) {
+      t.join();
+    }
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+/* Parallel summation
+ * @inner   The summation policy to use for the parts; termwise or
+ *          binarySplitting.
+ * @threads How many threads to use; 0 means one per hardware thread.
+ *
+ * Splits the range of terms into parts, sums up the parts on separate
+ * threads with the inner policy and merges the results. How the range is
+ * split only depends on the number of terms, never on the number of
+ * threads, so the result is the same no matter how many threads are used.
+ */
+template <typename inner = binarySplitting, unsigned int threads = 0>
+class parallel;
+
+/* Parallel term-by-term summation
+ * @threads How many threads to use; 0 means one per hardware thread.
+ *
+ * Cuts the terms into at most 64 runs of consecutive terms. Each run
+ * starts with at() and advances from there, so for stateful sequences
+ * whose at() is expensive this trades a few random accesses for the
+ * parallelism. The partial sums are added up in order.
+ *
+ * With exact types the result is the same as with the plain termwise
+ * policy. With floating point types the terms are added up in a
+ * different order, so the result may differ in the last few bits, but it
+ * does not depend on the number of threads.
+ */
+template <unsigned int threads>
+class parallel<termwise, threads> : public termwise {
+ public:
+  /**\copydoc termwise::sum */
+  template <typename sequence, typename Q, typename N>
+  static Q sum(const N &n, const Q &f, const Q &acc) {
+    return merge<N>(n, acc, [&f](const N &begin, const N &end) {
+      return termwise::range<sequence>(begin, end, f, Q(0));
+    });
+  }
+
+  /**\copydoc splitting::sum */
+  template <typename sequence, typename Q, typename N>
+  static Q sum(const N &n, const Q &f, const Q &x, const Q &c,
+               const Q &acc) {
+    const Q d = x - c;
+
+    return merge<N>(n, acc, [&f, &d](const N &begin, const N &end) {
+      return termwise::range<sequence>(begin, end, f, d, Q(0));
+    });
+  }
+
+ protected:
+  /* Sum runs of terms in parallel
+   * @n     Up to which sequence member to accumulate.
+   * @acc   The initial value.
+   * @range Sums up the terms from begin to end-1.
+   *
+   * @return acc plus the sum of all the runs.
+   */
+  template <typename N, typename Q, typename F>
+  static Q merge(const N &n, const Q &acc, const F &range) {
+    const N runs = n < N(64) ? n + N(1) : N(64);
+    const N length = (n + runs) / runs;
+    std::vector<Q> parts(std::size_t(runs), Q(0));
+
+    workers<threads>::run(std::size_t(runs), [&](std::size_t t) {
+      const N begin = N(t) * length;
+      const N end = begin + length < n + N(1) ? begin + length : n + N(1);
+
+      if (begin < end) {
+        parts[t] = range(begin, end);
+      }
+    });
+
+    numeric::accumulator<Q> sum(acc);
+
+    for (const Q &p : parts) {
+      sum += p;
+    }
+
+    return sum;
+  }
+};
+
+/* Parallel binary splitting
+ * @threads How many threads to use; 0 means one per hardware thread.
+ *
+ * Cuts the binary splitting tree at a depth of six, which leaves up to
+ * 64 subtrees. These are summed up on separate threads and then combined
+ * along the top of the tree, exactly like the serial policy does, so the
+ * result is always the same as that of binarySplitting. The sums come
+ * from splitting, which also hands types with a built-in integral type
+ * to the termwise policy; only split() is replaced.
+ */
+template <unsigned int threads>
+class parallel<binarySplitting, threads>
+    : public splitting<parallel<binarySplitting, threads>> {
+ protected:
+  /* The serial algorithm, whose sums call split() below */
+  typedef splitting<parallel<binarySplitting, threads>> base;
+
+  friend base;
+
+  /**\copydoc splitting::split
+   *
+   * Sums up the subtrees with the serial splitting::split() in parallel.
+   */
+  template <typename sequence, typename Z, typename N>
+  static ratio<Z> split(const N &begin, const N &end, const Z &xn,
+                        const Z &xd) {
+    std::vector<N> bounds;
+    leaves(begin, end, 6, bounds);
+    bounds.push_back(end);
+
+    std::vector<ratio<Z>> parts(bounds.size() - 1);
+
+    workers<threads>::run(parts.size(), [&](std::size_t t) {
+      parts[t] =
+          base::template split<sequence>(bounds[t], bounds[t + 1], xn, xd);
+    });
+
+    std::size_t next = 0;
+    return gather(begin, end, 6, parts, next);
+  }
+
+  /* Find the subtrees
+   * @begin  The first term to include.
+   * @end    The first term not to include.
+   * @depth  How many more levels to split.
+   * @bounds Where to append the first term of each subtree.
+   */
+  template <typename N>
+  static void leaves(const N &begin, const N &end, unsigned int depth,
+                     std::vector<N> &bounds) {
+    if ((depth == 0) || (end - begin == N(1))) {
+      bounds.push_back(begin);
+      return;
+    }
+
+    const N middle = begin + (end - begin) / N(2);
+
+    leaves(begin, middle, depth - 1, bounds);
+    leaves(middle, end, depth - 1, bounds);
+  }
+
+  /* Combine the subtrees
+   * @begin The first term to include.
+   * @end   The first term not to include.
+   * @depth How many more levels there are above the subtrees.
+   * @parts The sums of the subtrees.
+   * @next  Index of the next subtree to use.
+   *
+   * @return The combined P, Q, B and T of the range.
+   */
+  template <typename Z, typename N>
+  static ratio<Z> gather(const N &begin, const N &end, unsigned int depth,
+                         std::vector<ratio<Z>> &parts, std::size_t &next) {
+    if ((depth == 0) || (end - begin == N(1))) {
+      return std::move(parts[next++]);
+    }
+
+    const N middle = begin + (end - begin) / N(2);
+    ratio<Z> l = gather(begin, middle, depth - 1, parts, next);
+
+    return base::combine(l, gather(middle, end, depth - 1, parts, next));
+  }
+};
+}  // namespace series
+}  // namespace math
+}  // namespace efgy
+
+#endif
@@ -16,10 +16,21 @@
 #define EF_GY_SERIES_H
 
 #include <ef.gy/exponential.h>
+#include <ef.gy/numeric.h>
 #include <ef.gy/sequence.h>
 
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace efgy {
 namespace math {
+namespace numeric {
+template <typename N, typename reduction>
+class fractional;
+}  // namespace numeric
+
 /* Mathematical series templates
  *
  * This namespace contains templates for the different types of series
@@ -27,16 +38,336 @@ namespace math {
  * that describes the most basic form of series.
  */
 namespace series {
+/* Detect series algorithms with a final step
+ * @A The sequence algorithm.
+ * @Q Base type for calculations.
+ * @N Base integral type; used for indices into the sequence.
+ *
+ * Derives from std::true_type if the algorithm has a static finish()
+ * function that takes the sum of a series and the index of the last
+ * member that went into it, and from std::false_type otherwise.
+ */
+template <typename A, typename Q, typename N, typename = void>
+class hasFinish : public std::false_type {};
+
+template <typename A, typename Q, typename N>
+class hasFinish<A, Q, N,
+                std::void_t<decltype(A::finish(std::declval<const Q &>(),
+                                               std::declval<const N &>()))>>
+    : public std::true_type {};
+
+/* Term ratio
+ * @Z Integral type for the factors.
+ *
+ * Describes the n'th term of a series in the form used by the
+ * binarySplitting policy: the term is a/b times the product of all p/q
+ * up to and including this one, i.e.
+ *
+ *     term(n) = a(n)/b(n) * p(0)...p(n) / (q(0)...q(n))
+ *
+ * Algorithms that support binary splitting provide a static
+ * termRatio(n) function that returns one of these.
+ */
+template <typename Z>
+class ratio {
+ public:
+  /* Numerator of the ratio to the previous term */
+  Z p;
+
+  /* Denominator of the ratio to the previous term */
+  Z q;
+
+  /* Numerator of this term's own factor */
+  Z a;
+
+  /* Denominator of this term's own factor */
+  Z b;
+};
+
+/* Term-by-term summation
+ *
+ * The default summation policy for series: the terms are calculated in
+ * order, multiplied with the series factor and added to a
+ * numeric::accumulator. For stateful sequences every term is derived
+ * from the previous one with next(), otherwise it is calculated with
+ * at(). This works for any algorithm and base type, and is constexpr
+ * where the base type allows it.
+ */
+class termwise {
+ public:
+  /* Sum a series
+   * @sequence The sequence to sum up.
+   * @n        Up to which sequence member to accumulate.
+   * @f        Factor to multiply the sequence members with.
+   * @acc      The initial value.
+   *
+   * Adds up the terms starting with the 0th, so that a stateful
+   * sequence needs only one step per term.
+   *
+   * @return acc plus the sum of the 0th to the nth sequence member times f.
+   */
+  template <typename sequence, typename Q, typename N>
+  constexpr static Q sum(const N &n, const Q &f, const Q &acc) {
+    return range<sequence>(N(0), n + N(1), f, acc);
+  }
+
+  /* Sum a power series
+   * @sequence The sequence to sum up.
+   * @n        Up to which sequence member to accumulate.
+   * @f        Factor to multiply the sequence members with.
+   * @x        The power factor.
+   * @c        The centre of the power series.
+   * @acc      The initial value.
+   *
+   * Like the regular sum, but the nth term is also multiplied with
+   * (x-c)^n. The power is kept as a running product, so that's one more
+   * multiplication per term.
+   *
+   * @return acc plus the sum of the 0th to the nth power series member.
+   */
+  template <typename sequence, typename Q, typename N>
+  constexpr static Q sum(const N &n, const Q &f, const Q &x, const Q &c,
+                         const Q &acc) {
+    return range<sequence>(N(0), n + N(1), f, x - c, acc);
+  }
+
+ protected:
+  /* Sum a range of terms
+   * @sequence The sequence to sum up.
+   * @begin    The first term to include.
+   * @end      The first term not to include.
+   * @f        Factor to multiply the sequence members with.
+   * @acc      The initial value.
+   *
+   * Starts with at(begin) and advances from there.
+   *
+   * @return acc plus the sum of the terms from begin to end-1 times f.
+   */
+  template <typename sequence, typename Q, typename N>
+  constexpr static Q range(const N &begin, const N &end, const Q &f,
+                           const Q &acc) {
+    numeric::accumulator<Q> sum(acc);
+    Q term = sequence::at(begin);
+
+    for (N i = begin; i < end; i++) {
+      if (i > begin) {
+        term = sequence::advance(term, i);
+      }
+      sum += term * f;
+    }
+
+    return sum;
+  }
+
+  /* Sum a range of power series terms
+   * @sequence The sequence to sum up.
+   * @begin    The first term to include.
+   * @end      The first term not to include.
+   * @f        Factor to multiply the sequence members with.
+   * @d        The power factor minus the centre.
+   * @acc      The initial value.
+   *
+   * Raises d to the power of begin once, and keeps multiplying from
+   * there.
+   *
+   * @return acc plus the sum of the power series terms from begin to end-1.
+   */
+  template <typename sequence, typename Q, typename N>
+  constexpr static Q range(const N &begin, const N &end, const Q &f,
+                           const Q &d, const Q &acc) {
+    typedef typename numeric::traits<Q>::integral integer;
+
+    numeric::accumulator<Q> sum(acc);
+    Q term = sequence::at(begin);
+    Q power = begin == N(0)
+                  ? f
+                  : f * exponentiate::integral<Q>::raise(d, integer(begin));
+
+    for (N i = begin; i < end; i++) {
+      if (i > begin) {
+        term = sequence::advance(term, i);
+        power *= d;
+      }
+      sum += term * power;
+    }
+
+    return sum;
+  }
+};
+
+/* Binary splitting summation
+ *
+ * Summation policy for algorithms that provide a termRatio() function.
+ * Instead of calculating every term from scratch, the policy splits the
+ * range of terms in half, sums both halves as a single fraction T/(BQ)
+ * and combines the halves with a handful of multiplications:
+ *
+ *     P = P_l P_r, Q = Q_l Q_r, B = B_l B_r,
+ *     T = B_r Q_r T_l + B_l P_l T_r
+ *
+ * The operands are about the same size at every level of the tree,
+ * so summing N terms costs O(log N) multiplications of numbers the size
+ * of the result, and those benefit from the fast multiplication
+ * algorithms in bigIntegers. There is only one division, at the very
+ * end.
+ *
+ * All the products are calculated with the base type's integral type,
+ * so this is meant for base types like fractional<Z> and anything else
+ * with an arbitrary precision integral type. With a fixed-width integral
+ * type, e.g. for floating point numbers and math::fraction, the products
+ * would overflow after a handful of terms, so those are summed up with
+ * the termwise policy instead.
+ *
+ * This template holds the algorithm; use the binarySplitting policy. The
+ * sums call self::split() for the whole range, so that policies like
+ * parallel<binarySplitting> only need to replace that.
+ *
+ * @self The policy deriving from this template.
+ */
+template <typename self>
+class splitting {
+ public:
+  /**\copydoc termwise::sum */
+  template <typename sequence, typename Q, typename N>
+  static Q sum(const N &n, const Q &f, const Q &acc) {
+    typedef typename numeric::traits<Q>::integral Z;
+
+    if constexpr (std::is_integral<Z>::value) {
+      return termwise::sum<sequence>(n, f, acc);
+    } else {
+      const ratio<Z> r =
+          self::template split<sequence>(N(0), n + N(1), Z(1), Z(1));
+
+      return acc + f * Q(r.a) / (Q(r.b) * Q(r.q));
+    }
+  }
+
+  /* Sum a power series
+   * @sequence The sequence to sum up.
+   * @n        Up to which sequence member to accumulate.
+   * @f        Factor to multiply the sequence members with.
+   * @x        The power factor.
+   * @c        The centre of the power series.
+   * @acc      The initial value.
+   *
+   * The power factor is folded into the term ratios, with x-c split into
+   * a numerator and denominator. That is exact for fractions and
+   * integers; other types are truncated to their integral type.
+   *
+   * @return acc plus the sum of the 0th to the nth power series member.
+   */
+  template <typename sequence, typename Q, typename N>
+  static Q sum(const N &n, const Q &f, const Q &x, const Q &c,
+               const Q &acc) {
+    typedef typename numeric::traits<Q>::integral Z;
+
+    if constexpr (std::is_integral<Z>::value) {
+      return termwise::sum<sequence>(n, f, x, c, acc);
+    } else {
+      Z xn, xd;
+      toRatio(x - c, xn, xd);
+
+      const ratio<Z> r =
+          self::template split<sequence>(N(0), n + N(1), xn, xd);
+
+      return acc + f * Q(r.a) / (Q(r.b) * Q(r.q));
+    }
+  }
+
+ protected:
+  /* Sum a range of terms
+   * @sequence The sequence to sum up.
+   * @begin    The first term to include.
+   * @end      The first term not to include.
+   * @xn       Numerator of the power factor.
+   * @xd       Denominator of the power factor.
+   *
+   * Recursively sums up the terms from begin to end-1. The result holds
+   * the products P, Q and B of the range, and T in place of a; the sum
+   * of the range is T/(BQ), relative to the product of all the p/q
+   * before begin.
+   *
+   * @return The combined P, Q, B and T of the range.
+   */
+  template <typename sequence, typename Z, typename N>
+  static ratio<Z> split(const N &begin, const N &end, const Z &xn,
+                        const Z &xd) {
+    if (end - begin == N(1)) {
+      ratio<Z> r = sequence::termRatio(begin);
+
+      if (begin > N(0)) {
+        r.p *= xn;
+        r.q *= xd;
+      }
+
+      r.a *= r.p;
+      return r;
+    }
+
+    const N middle = begin + (end - begin) / N(2);
+
+    return combine(split<sequence>(begin, middle, xn, xd),
+                   split<sequence>(middle, end, xn, xd));
+  }
+
+  /* Combine adjacent ranges
+   * @l The earlier range.
+   * @r The range right after it.
+   *
+   * @return The combined P, Q, B and T of both ranges.
+   */
+  template <typename Z>
+  static ratio<Z> combine(const ratio<Z> &l, ratio<Z> r) {
+    r.a = r.b * r.q * l.a + l.b * l.p * r.a;
+    r.p = l.p * r.p;
+    r.q = l.q * r.q;
+    r.b = l.b * r.b;
+
+    return r;
+  }
+
+  /* Split a number into numerator and denominator
+   * @x The number to split.
+   * @n Where to store the numerator.
+   * @d Where to store the denominator.
+   */
+  template <typename Q, typename Z>
+  static void toRatio(const Q &x, Z &n, Z &d) {
+    n = Z(x);
+    d = Z(1);
+  }
+
+  /* Split a fraction into numerator and denominator
+   * @x The fraction to split.
+   * @n Where to store the numerator.
+   * @d Where to store the denominator.
+   */
+  template <typename Z, typename reduction>
+  static void toRatio(const numeric::fractional<Z, reduction> &x, Z &n,
+                      Z &d) {
+    n = x.numerator;
+    d = x.denominator;
+  }
+};
+
+/* Binary splitting summation
+ *
+ * The serial binary splitting policy; see splitting.
+ */
+class binarySplitting : public splitting<binarySplitting> {};
+
 /* Basic series
  * @Q         Base type for calculations.
  * @algorithm The algorithm to calculate the sequence members.
  * @N         Base integral type; used for indices into the sequence.
+ * @summation How to add up the sequence members; see termwise and
+ *            binarySplitting.
  *
  * Represents a (potentially infinite) series. Infinite series will
  * be truncated in the process of casting this to the base type.
  */
 template <typename Q, template <typename, typename> class algorithm,
-          typename N = unsigned long long>
+          typename N = unsigned long long, typename summation = termwise>
 class series : public math::sequence<Q, algorithm, N> {
  protected:
   /* Base sequence
@@ -68,12 +399,21 @@ class series : public math::sequence<Q, algorithm, N> {
    * becomes necessary to provide an approximation of the
    * sequence.
    *
+   * Some algorithms, like algorithm::chudnovsky, converge to something
+   * other than the value they are meant to calculate. These provide a
+   * finish() function, which is applied to the sum before it is
+   * multiplied with the factor.
+   *
    * @return The sum of the 0th to the nth sequence member.
    */
   constexpr static Q get(
       const N &n = sequenceAlgorithm::defaultSeriesIterations,
       const Q &f = Q(1)) {
-    return sumTo(n, f, Q(0));
+    if constexpr (hasFinish<sequenceAlgorithm, Q, N>::value) {
+      return f * sequenceAlgorithm::finish(sumTo(n, Q(1), Q(0)), n);
+    } else {
+      return sumTo(n, f, Q(0));
+    }
   }
 
   /* Calculate approximation
@@ -87,22 +427,117 @@ class series : public math::sequence<Q, algorithm, N> {
    */
   constexpr operator Q(void) const { return get(iterations, factor); }
 
+  /* Number of terms for a precision
+   * @bits How many bits after the binary point should be accurate.
+   * @f    Factor to multiply the sequence members with.
+   *
+   * Uses the algorithm's tail(n) function, which gives an upper bound
+   * for the error of get(n), to find the smallest n for which that error
+   * times f is at most 2^-bits. The bound is only evaluated O(log n)
+   * times, so this is cheap compared to summing up the series.
+   *
+   * @return Up to which sequence member the series needs to be summed.
+   */
+  static N termsFor(const N &bits, const Q &f = Q(1)) {
+    const Q a = magnitude(f);
+
+    return search(epsilon(bits),
+                  [&a](const N &n) { return a * sequenceAlgorithm::tail(n); });
+  }
+
+  /* Calculate to a precision
+   * @bits How many bits after the binary point should be accurate.
+   * @f    Factor to multiply the sequence members with.
+   *
+   * Sums up as few members as possible to get the given precision.
+   *
+   * @return The approximation of the series.
+   */
+  static Q toPrecision(const N &bits, const Q &f = Q(1)) {
+    return get(termsFor(bits, f), f);
+  }
+
  protected:
+  /* Magnitude
+   * @q The value to get the magnitude of.
+   *
+   * @return The absolute value of q.
+   */
+  static Q magnitude(const Q &q) { return Q(0) > q ? Q(0) - q : q; }
+
+  /* Precision threshold
+   * @bits How many bits after the binary point should be accurate.
+   *
+   * Calculates 2^-bits. Floating point types can't go all that small, so
+   * with those this halves bits until the result is no longer zero.
+   *
+   * @return The largest acceptable error.
+   */
+  static Q epsilon(const N &bits) {
+    typedef typename numeric::traits<Q>::integral integer;
+
+    Q e = Q(0);
+
+    for (N b = bits; e == Q(0); b /= N(2)) {
+      e = Q(1) / exponentiate::integral<Q>::raise(Q(2), integer(b));
+    }
+
+    return e;
+  }
+
+  /* Find the number of terms
+   * @e     The largest acceptable error.
+   * @bound Calculates an upper bound for the error after n terms.
+   *
+   * Doubles n until the bound is small enough, then bisects to find the
+   * smallest n that works. Assumes that the bound doesn't increase once
+   * it is small enough.
+   *
+   * @return The smallest n for which the bound is at most e.
+   */
+  template <typename B>
+  static N search(const Q &e, const B &bound) {
+    if (!(bound(N(0)) > e)) {
+      return N(0);
+    }
+
+    N low = 0;
+    N high = 1;
+
+    while (bound(high) > e) {
+      low = high;
+      high *= N(2);
+    }
+
+    while (high - low > N(1)) {
+      const N middle = low + (high - low) / N(2);
+
+      if (bound(middle) > e) {
+        low = middle;
+      } else {
+        high = middle;
+      }
+    }
+
+    return high;
+  }
+
   /* Constant summation function
    * @n Up to which sequence member to accumulate.
    * @f Factor to multiply the sequence members with.
    * @acc The initial (or current) value; used for tail recursion.
    *
-   * Used to sum up the first n+1 members of the sequence.
-   * This method is tail-recursive so it shouldn't make your
-   * stack explode. It is also static and constexpr, meaning
-   * it should be evaluated at compile time.
+   * Used to sum up the first n+1 members of the sequence, as
+   * described by the summation policy. With the default termwise
+   * policy the members are collected in a numeric::accumulator, which
+   * adds them to a running total in place for most types and sums
+   * fractions with a balanced tree. It is also static and constexpr,
+   * meaning it should be evaluated at compile time where possible.
    *
    * @return The sum of the 0th to the nth sequence member.
    */
   constexpr static Q sumTo(const N &n, const Q &f, const Q &acc) {
-    return n == 0 ? acc + (sequence::at(0) * f)
-                  : sumTo(n - 1, f, acc + (sequence::at(n) * f));
+    return summation::template sum<sequence>(n, f, acc);
   }
 
   /* Number of iterations
@@ -124,18 +559,22 @@ class series : public math::sequence<Q, algorithm, N> {
  * @Q Base type for calculations.
  * @algorithm The algorithm to calculate the sequence members.
  * @N Base integral type; used for indices into the sequence.
+ * @summation How to add up the sequence members.
  *
  * Based on the regular series, this represents a power series,
  * which is basically like a regular series but with two additional
  * parameters: a power factor and a centre.
  */
 template <typename Q, template <typename, typename> class algorithm,
-          typename N = unsigned long long>
-class power : public series<Q, algorithm, N> {
-  using typename series<Q, algorithm, N>::sequence;
-  using typename series<Q, algorithm, N>::sequenceAlgorithm;
-  using series<Q, algorithm, N>::iterations;
-  using series<Q, algorithm, N>::factor;
+          typename N = unsigned long long, typename summation = termwise>
+class power : public series<Q, algorithm, N, summation> {
+  using typename series<Q, algorithm, N, summation>::sequence;
+  using typename series<Q, algorithm, N, summation>::sequenceAlgorithm;
+  using series<Q, algorithm, N, summation>::iterations;
+  using series<Q, algorithm, N, summation>::factor;
+  using series<Q, algorithm, N, summation>::magnitude;
+  using series<Q, algorithm, N, summation>::epsilon;
+  using series<Q, algorithm, N, summation>::search;
 
  public:
   /* Construct with factors and iterations
@@ -152,7 +591,7 @@ class power : public series<Q, algorithm, N> {
   power(const Q pFactor = Q(1), const Q pPowerFactor = Q(1),
         const Q pCentre = Q(0),
         const N &pIterations = sequenceAlgorithm::defaultSeriesIterations)
-      : series<Q, algorithm, N>(pFactor, pIterations),
+      : series<Q, algorithm, N, summation>(pFactor, pIterations),
         powerFactor(pPowerFactor),
         centre(pCentre) {}
 
@@ -183,6 +622,32 @@ class power : public series<Q, algorithm, N> {
     return get(iterations, factor, powerFactor, centre);
   }
 
+  /**\copydoc series::termsFor
+   * @x The power factor.
+   * @c The centre of the power series.
+   *
+   * For power series, the algorithm's tail(n, d) function gets the
+   * difference between the power factor and the centre as well.
+   */
+  static N termsFor(const N &bits, const Q &f = Q(1), const Q &x = Q(1),
+                    const Q &c = Q(0)) {
+    const Q a = magnitude(f);
+    const Q d = x - c;
+
+    return search(epsilon(bits), [&a, &d](const N &n) {
+      return a * sequenceAlgorithm::tail(n, d);
+    });
+  }
+
+  /**\copydoc series::toPrecision
+   * @x The power factor.
+   * @c The centre of the power series.
+   */
+  static Q toPrecision(const N &bits, const Q &f = Q(1), const Q &x = Q(1),
+                       const Q &c = Q(0)) {
+    return get(termsFor(bits, f, x, c), f, x, c);
+  }
+
  protected:
   /**\copydoc series::sumTo
    * @x The power factor.
@@ -194,10 +659,7 @@ class power : public series<Q, algorithm, N> {
    */
   constexpr static Q sumTo(const N &n, const Q &f, const Q &x, const Q &c,
                            const Q &acc) {
-    return n == 0 ? acc + (sequence::at(0) * f)
-                  : sumTo(n - 1, f, x, c,
-                          acc + (sequence::at(n) * f *
-                                 exponentiate::integral<Q>::raise(x - c, n)));
+    return summation::template sum<sequence>(n, f, x, c, acc);
   }
 
   /* Centre
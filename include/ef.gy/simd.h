@@ -0,0 +1,505 @@
+/**\file
+ * \brief Batched elementary functions
+ *
+ * Sine, cosine, arc tangent and square root over whole arrays of floats or
+ * doubles. The kernels are written with the GCC/clang vector extensions, so
+ * the compiler maps them onto whatever SIMD instructions the target has -
+ * SSE, AVX, NEON - and they use polynomial approximations instead of calling
+ * the C library once per number. Other types fall back to calling the usual
+ * functions one element at a time.
+ *
+ * \copyright
+ * This file is part of the libefgy project, which is released as open source
+ * under the terms of an MIT/X11-style licence, described in the COPYING file.
+ *
+ * \see Project Documentation: https://ef.gy/documentation/libefgy
+ * \see Project Source Code: https://github.com/ef-gy/libefgy
+ * \see Licence Terms: https://github.com/ef-gy/libefgy/blob/master/COPYING
+ */
+
+#if !defined(EF_GY_SIMD_H)
+#define EF_GY_SIMD_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace efgy {
+namespace math {
+/**\brief Batched elementary functions
+ *
+ * The functions in here take arrays of arguments and write arrays of
+ * results, which lets them process several numbers with one instruction.
+ *
+ * Error bounds, measured against the long double functions of the C
+ * library on a few million arguments:
+ * - sines(), sine() and cosine() are within 2 ulp wherever the result is
+ *   at least 2^-8 (float) or 2^-16 (double) in magnitude. Closer to the
+ *   zeros of the functions, the absolute error is within 1 ulp of 2^-8 or
+ *   2^-16, respectively. Arguments with a magnitude above
+ *   kernel::reductionLimit are passed on to std::sin() and std::cos().
+ * - arctangent2() and arctangent() are within 3 ulp.
+ * - squareRoot() is correctly rounded.
+ */
+namespace simd {
+/**\brief Vector width in bytes
+ *
+ * 32 bytes when the compiler targets AVX, 16 otherwise, which is what SSE2
+ * and NEON registers hold; wider vectors would have to be split up and
+ * passed around in memory.
+ */
+#if defined(__AVX__)
+static constexpr std::size_t width = 32;
+#else
+static constexpr std::size_t width = 16;
+#endif
+
+/**\brief Vector kernel parameters
+ *
+ * The vector types and polynomial coefficients for one floating point
+ * type. Only float and double have kernels; the primary template marks
+ * everything else as not vectorised.
+ *
+ * \tparam T The floating point type.
+ */
+template <typename T>
+class kernel {
+ public:
+  /**\brief Whether there is a vector kernel for T */
+  static constexpr bool vectorised = false;
+};
+
+/**\brief Vector kernel parameters for float
+ *
+ * The polynomials are the ones from the Cephes library.
+ */
+template <>
+class kernel<float> {
+ public:
+  /**\copydoc kernel::vectorised */
+  static constexpr bool vectorised = true;
+
+  /**\brief Number of lanes per vector */
+  static constexpr std::size_t lanes = width / sizeof(float);
+
+  /**\brief Vector of floats */
+  typedef float type __attribute__((vector_size(lanes * sizeof(float))));
+
+  /**\brief Vector of integers with the same lane width */
+  typedef std::int32_t integer
+      __attribute__((vector_size(lanes * sizeof(std::int32_t))));
+
+  /**\brief Pi/2, split into parts that multiply exactly */
+  static constexpr float quarterTurn[3] = {1.5703125f, 4.837512969970703125e-4f,
+                                           7.54978995489188216e-8f};
+
+  /**\brief 2/pi, the reciprocal of a quarter turn */
+  static constexpr float inverseQuarterTurn = 6.36619772367581343076e-1f;
+
+  /**\brief Largest argument that sines() reduces itself */
+  static constexpr float reductionLimit = 8192.f;
+
+  /**\brief Sine polynomial on [-pi/4, pi/4]
+   *
+   * \param[in] x The argument.
+   * \param[in] z x*x.
+   *
+   * \returns The sine of x.
+   */
+  static type sine(const type &x, const type &z) {
+    return ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z -
+            1.6666654611e-1f) *
+               z * x +
+           x;
+  }
+
+  /**\brief Cosine polynomial on [-pi/4, pi/4]
+   *
+   * \param[in] z The square of the argument.
+   *
+   * \returns The cosine of the argument.
+   */
+  static type cosine(const type &z) {
+    return ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z +
+            4.166664568298827e-2f) *
+               z * z -
+           0.5f * z + 1.f;
+  }
+
+  /**\brief Arc tangent polynomial on [-tan(pi/8), tan(pi/8)]
+   *
+   * \param[in] x The argument.
+   *
+   * \returns The arc tangent of x.
+   */
+  static type arctangent(const type &x) {
+    const type z = x * x;
+    return (((8.05374449538e-2f * z - 1.38776856032e-1f) * z +
+             1.99777106478e-1f) *
+                z -
+            3.33329491539e-1f) *
+               z * x +
+           x;
+  }
+};
+
+/**\brief Vector kernel parameters for double
+ *
+ * The polynomials are the ones from the Cephes library.
+ */
+template <>
+class kernel<double> {
+ public:
+  /**\copydoc kernel::vectorised */
+  static constexpr bool vectorised = true;
+
+  /**\copydoc kernel<float>::lanes */
+  static constexpr std::size_t lanes = width / sizeof(double);
+
+  /**\brief Vector of doubles */
+  typedef double type __attribute__((vector_size(lanes * sizeof(double))));
+
+  /**\copydoc kernel<float>::integer */
+  typedef std::int64_t integer
+      __attribute__((vector_size(lanes * sizeof(std::int64_t))));
+
+  /**\copydoc kernel<float>::quarterTurn */
+  static constexpr double quarterTurn[3] = {1.57079625129699707031e0,
+                                            7.54978941586159635336e-8,
+                                            5.39030285815811905290e-15};
+
+  /**\copydoc kernel<float>::inverseQuarterTurn */
+  static constexpr double inverseQuarterTurn = 6.36619772367581343076e-1;
+
+  /**\copydoc kernel<float>::reductionLimit */
+  static constexpr double reductionLimit = 1048576.;
+
+  /**\copydoc kernel<float>::sine */
+  static type sine(const type &x, const type &z) {
+    return x + x * z *
+                   (((((1.58962301576546568060e-10 * z -
+                        2.50507477628578072866e-8) *
+                           z +
+                       2.75573136213857245213e-6) *
+                          z -
+                      1.98412698295895385996e-4) *
+                         z +
+                     8.33333333332211858878e-3) *
+                        z -
+                    1.66666666666666307295e-1);
+  }
+
+  /**\copydoc kernel<float>::cosine */
+  static type cosine(const type &z) {
+    return 1. - 0.5 * z +
+           z * z *
+               (((((-1.13585365213876817300e-11 * z +
+                    2.08757008419747316778e-9) *
+                       z -
+                   2.75573141792967388112e-7) *
+                      z +
+                  2.48015872888517045348e-5) *
+                     z -
+                 1.38888888888730564116e-3) *
+                    z +
+                4.16666666666665929218e-2);
+  }
+
+  /**\copydoc kernel<float>::arctangent */
+  static type arctangent(const type &x) {
+    const type z = x * x;
+    const type p = (((-8.750608600031904122785e-1 * z -
+                      1.615753718733365076637e1) *
+                         z -
+                     7.500855792314704667340e1) *
+                        z -
+                    1.228866684490136173410e2) *
+                       z -
+                   6.485021904942025371773e1;
+    const type q = ((((z + 2.485846490142306297962e1) * z +
+                      1.650270098316988542046e2) *
+                         z +
+                     4.328810604912902668951e2) *
+                        z +
+                    4.853903996359136964868e2) *
+                       z +
+                   1.945506571482613964425e2;
+    return x + x * z * p / q;
+  }
+};
+
+/**\brief Apply a vector kernel to an array
+ *
+ * Loads the arguments one vector at a time and stores the results; the
+ * last vector is padded with zeros if the arrays don't fill it.
+ *
+ * \tparam T The floating point type.
+ * \tparam F Functor that takes the argument vectors and writes the result
+ *           vectors.
+ *
+ * \param[in]  n     The number of elements.
+ * \param[in]  in    The argument arrays; unused ones may be null.
+ * \param[out] out   The result arrays; unused ones may be null.
+ * \param[in]  apply The kernel.
+ */
+template <typename T, typename F>
+static void map(std::size_t n, const T *const (&in)[2], T *const (&out)[2],
+                const F &apply) {
+  typedef typename kernel<T>::type type;
+  constexpr std::size_t lanes = kernel<T>::lanes;
+
+  std::size_t i = 0;
+
+  for (; i + lanes <= n; i += lanes) {
+    type a[2] = {}, r[2] = {};
+
+    for (std::size_t k = 0; k < 2; k++) {
+      if (in[k]) {
+        std::memcpy(&a[k], in[k] + i, sizeof(type));
+      }
+    }
+
+    apply(a, r);
+
+    for (std::size_t k = 0; k < 2; k++) {
+      if (out[k]) {
+        std::memcpy(out[k] + i, &r[k], sizeof(type));
+      }
+    }
+  }
+
+  if (i < n) {
+    type a[2] = {}, r[2] = {};
+
+    for (std::size_t k = 0; k < 2; k++) {
+      if (in[k]) {
+        std::memcpy(&a[k], in[k] + i, (n - i) * sizeof(T));
+      }
+    }
+
+    apply(a, r);
+
+    for (std::size_t k = 0; k < 2; k++) {
+      if (out[k]) {
+        std::memcpy(out[k] + i, &r[k], (n - i) * sizeof(T));
+      }
+    }
+  }
+}
+
+/**\brief Calculate sines and cosines
+ *
+ * Rounds theta*2/pi to the nearest integer j, subtracts j*pi/2 with the
+ * parts of kernel::quarterTurn so that the remainder is exact but for the
+ * last part, and evaluates the sine and cosine polynomials on the
+ * remainder, swapping them and flipping the signs according to j.
+ *
+ * \tparam T Floating point type, e.g. float or double.
+ *
+ * \param[in]  theta  The angles.
+ * \param[out] sine   Where to write the sines to; may be null.
+ * \param[out] cosine Where to write the cosines to; may be null.
+ * \param[in]  n      The number of angles.
+ */
+template <typename T>
+static void sines(const T *theta, T *sine, T *cosine, std::size_t n) {
+  if constexpr (kernel<T>::vectorised) {
+    typedef kernel<T> K;
+    typedef typename K::type type;
+    typedef typename K::integer integer;
+
+    map<T>(n, {theta, nullptr}, {sine, cosine},
+           [](const type(&a)[2], type(&r)[2]) {
+             const type x = a[0];
+             const type h = x < T(0) ? T(-0.5) : T(0.5);
+             const integer j = __builtin_convertvector(
+                 x * K::inverseQuarterTurn + h, integer);
+             const type q = __builtin_convertvector(j, type);
+             const type y = ((x - q * K::quarterTurn[0]) -
+                             q * K::quarterTurn[1]) -
+                            q * K::quarterTurn[2];
+             const type z = y * y;
+             const type s = K::sine(y, z);
+             const type c = K::cosine(z);
+             const integer swap = (j & 1) != 0;
+             const type rs = swap ? c : s;
+             const type rc = swap ? s : c;
+
+             r[0] = (j & 2) != 0 ? -rs : rs;
+             r[1] = ((j + 1) & 2) != 0 ? -rc : rc;
+           });
+
+    for (std::size_t i = 0; i < n; i++) {
+      if (!(std::fabs(theta[i]) <= K::reductionLimit)) {
+        if (sine) {
+          sine[i] = std::sin(theta[i]);
+        }
+        if (cosine) {
+          cosine[i] = std::cos(theta[i]);
+        }
+      }
+    }
+  } else {
+    using std::cos;
+    using std::sin;
+
+    for (std::size_t i = 0; i < n; i++) {
+      if (sine) {
+        sine[i] = sin(theta[i]);
+      }
+      if (cosine) {
+        cosine[i] = cos(theta[i]);
+      }
+    }
+  }
+}
+
+/**\brief Calculate sines
+ *
+ * \copydetails sines
+ *
+ * \param[in]  theta The angles.
+ * \param[out] sine  Where to write the sines to.
+ * \param[in]  n     The number of angles.
+ */
+template <typename T>
+static void sine(const T *theta, T *sine, std::size_t n) {
+  sines<T>(theta, sine, nullptr, n);
+}
+
+/**\brief Calculate cosines
+ *
+ * \copydetails sines
+ *
+ * \param[in]  theta  The angles.
+ * \param[out] cosine Where to write the cosines to.
+ * \param[in]  n      The number of angles.
+ */
+template <typename T>
+static void cosine(const T *theta, T *cosine, std::size_t n) {
+  sines<T>(theta, nullptr, cosine, n);
+}
+
+/**\brief Arc tangent of a quotient, one vector at a time
+ *
+ * The smaller of |y| and |x| is divided by the larger one, which leaves an
+ * argument in [0, 1], and arguments above tan(pi/8) are moved to
+ * [-tan(pi/8), 0] with atan(t) = pi/4 + atan((t-1)/(t+1)) before
+ * evaluating the polynomial. The quadrant is then restored from the
+ * signs of y and x, adding the multiples of pi in two parts so that the
+ * rounding error of pi doesn't add to that of the polynomial.
+ *
+ * \tparam T Floating point type, e.g. float or double.
+ *
+ * \param[in] y The numerators.
+ * \param[in] x The denominators.
+ *
+ * \returns The arc tangents, in [-pi, pi].
+ */
+template <typename T>
+static typename kernel<T>::type angle(const typename kernel<T>::type &y,
+                                      const typename kernel<T>::type &x) {
+  typedef typename kernel<T>::type type;
+  const T tanEighthTurn = T(0.41421356237309504880);
+  const long double pi = 3.14159265358979323846264338327950288L;
+  const T piHigh = T(pi), piLow = T(pi - piHigh);
+
+  const type ay = y < T(0) ? -y : y;
+  const type ax = x < T(0) ? -x : x;
+  const type large = ay > ax ? ay : ax;
+  const type small = ay > ax ? ax : ay;
+  const type t = large == T(0) ? small : small / large;
+  const type u = t > tanEighthTurn ? (t - T(1)) / (t + T(1)) : t;
+  type v = kernel<T>::arctangent(u);
+
+  v = t > tanEighthTurn ? piHigh / T(4) + (v + piLow / T(4)) : v;
+  v = ay > ax ? (piHigh / T(2) - v) + piLow / T(2) : v;
+  v = x < T(0) ? (piHigh - v) + piLow : v;
+
+  return y < T(0) ? -v : v;
+}
+
+/**\brief Calculate arc tangents of quotients
+ *
+ * Works like std::atan2(), i.e. the results are in [-pi, pi] with the
+ * quadrant determined by the signs of y and x, except that signed zeros
+ * are treated like positive zeros.
+ *
+ * \tparam T Floating point type, e.g. float or double.
+ *
+ * \param[in]  y   The numerators.
+ * \param[in]  x   The denominators.
+ * \param[out] out Where to write the arc tangents to.
+ * \param[in]  n   The number of quotients.
+ */
+template <typename T>
+static void arctangent2(const T *y, const T *x, T *out, std::size_t n) {
+  if constexpr (kernel<T>::vectorised) {
+    typedef typename kernel<T>::type type;
+
+    map<T>(n, {y, x}, {out, nullptr}, [](const type(&a)[2], type(&r)[2]) {
+      r[0] = angle<T>(a[0], a[1]);
+    });
+  } else {
+    using std::atan2;
+
+    for (std::size_t i = 0; i < n; i++) {
+      out[i] = atan2(y[i], x[i]);
+    }
+  }
+}
+
+/**\brief Calculate arc tangents
+ *
+ * The same kernel as arctangent2(), with a denominator of one.
+ *
+ * \tparam T Floating point type, e.g. float or double.
+ *
+ * \param[in]  x   The arguments.
+ * \param[out] out Where to write the arc tangents to.
+ * \param[in]  n   The number of arguments.
+ */
+template <typename T>
+static void arctangent(const T *x, T *out, std::size_t n) {
+  if constexpr (kernel<T>::vectorised) {
+    typedef typename kernel<T>::type type;
+
+    map<T>(n, {x, nullptr}, {out, nullptr},
+           [](const type(&a)[2], type(&r)[2]) {
+             r[0] = angle<T>(a[0], type{} + T(1));
+           });
+  } else {
+    using std::atan;
+
+    for (std::size_t i = 0; i < n; i++) {
+      out[i] = atan(x[i]);
+    }
+  }
+}
+
+/**\brief Calculate square roots
+ *
+ * A plain loop, which compilers turn into the vector square root
+ * instructions when they don't need to set errno, e.g. with
+ * -fno-math-errno. Those are correctly rounded.
+ *
+ * \tparam T Floating point type, e.g. float or double.
+ *
+ * \param[in]  x   The arguments.
+ * \param[out] out Where to write the square roots to.
+ * \param[in]  n   The number of arguments.
+ */
+template <typename T>
+static void squareRoot(const T *x, T *out, std::size_t n) {
+  using std::sqrt;
+
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = sqrt(x[i]);
+  }
+}
+};  // namespace simd
+};  // namespace math
+};  // namespace efgy
+
+#endif
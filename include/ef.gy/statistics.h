@@ -35,7 +35,9 @@ namespace statistics {
  * @input The vector over which to calculate the average.
  *
  * Calculates the average of all values in a vector by adding all of the
- * items and then dividing by the number of items in the vector.
+ * items and then dividing by the number of items in the vector. The items
+ * are summed with a numeric::accumulator, so averages of fractions use a
+ * balanced sum.
  *
  * @return The average of the values in the input vector.
  */
@@ -45,11 +47,11 @@ static std::optional<Q> average(const std::vector<Q> &input) {
     return std::optional<Q>();
   }
 
-  Q s = 0;
+  efgy::math::numeric::accumulator<Q> s;
   for (const Q &i : input) {
     s += i;
   }
-  return std::optional<Q>(s / Q(input.size()));
+  return std::optional<Q>(Q(s) / Q(input.size()));
 }
 
 /* Calculates the variance of a range.
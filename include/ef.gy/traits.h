@@ -12,12 +12,35 @@
 #if !defined(EF_GY_TRAITS_H)
 #define EF_GY_TRAITS_H
 
+#include <type_traits>
+
 namespace efgy {
 namespace math {
 template <typename Q, typename I>
 class primitive;
 
 namespace numeric {
+/**\brief Euclidean GCD
+ *
+ * Tag for the algorithm used by gcd() and gcdP(): the plain Euclidean
+ * algorithm, which only needs the modulo operator.
+ */
+class euclideanGCD {};
+
+/**\brief Binary GCD
+ *
+ * Tag for Stein's binary GCD algorithm, which only uses shifts and
+ * subtractions; used for the built-in integer types.
+ */
+class binaryGCD {};
+
+/**\brief Lehmer GCD
+ *
+ * Tag for types that provide their own static gcd() member, like the
+ * bigIntegers template with its Lehmer and half-GCD algorithms.
+ */
+class lehmerGCD {};
+
 template <typename T>
 class traits {
  public:
@@ -25,6 +48,8 @@ class traits {
   typedef T rational;
   typedef T self;
   typedef primitive<T, unsigned long> derivable;
+  typedef typename std::conditional<std::is_integral<T>::value, binaryGCD,
+                                    euclideanGCD>::type gcdAlgorithm;
 
   static const bool stable = false;
 };
@@ -36,6 +61,7 @@ class traits<float> {
   typedef float rational;
   typedef float self;
   typedef primitive<float, unsigned long> derivable;
+  typedef euclideanGCD gcdAlgorithm;
 
   static const bool stable = false;
 };
@@ -47,6 +73,7 @@ class traits<double> {
   typedef double rational;
   typedef double self;
   typedef primitive<double, unsigned long> derivable;
+  typedef euclideanGCD gcdAlgorithm;
 
   static const bool stable = false;
 };
@@ -58,6 +85,7 @@ class traits<long double> {
   typedef long double rational;
   typedef long double self;
   typedef primitive<long double, unsigned long> derivable;
+  typedef euclideanGCD gcdAlgorithm;
 
   static const bool stable = false;
 };
@@ -69,9 +97,22 @@ class traits<primitive<Q, I>> {
   typedef Q rational;
   typedef primitive<Q, I> self;
   typedef primitive<Q, I> derivable;
+  typedef euclideanGCD gcdAlgorithm;
 
   static const bool stable = false;
 };
+
+/**\brief Fractions of built-in integers
+ *
+ * True for fractional types with a built-in integer type, like
+ * math::fraction; fractions.h specialises this for those. Series and
+ * other algorithms that need more than a few terms overflow them, so
+ * they work in long double for them instead.
+ *
+ * \tparam Q The type to examine.
+ */
+template <typename Q>
+class builtinFraction : public std::false_type {};
 };  // namespace numeric
 };  // namespace math
 };  // namespace efgy
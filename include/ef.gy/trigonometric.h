@@ -16,15 +16,375 @@
 #define EF_GY_TRIGONOMETRIC_H
 
 #include <ef.gy/complex.h>
+#include <ef.gy/continued-fractions.h>
 #include <ef.gy/e.h>
+#include <ef.gy/pi.h>
 
 #include <cmath>
+#include <limits>
+#include <map>
+#include <vector>
 
 namespace efgy {
 namespace math {
+/**\brief Sine and cosine of arbitrary precision types
+ *
+ * The power series for the sine and cosine converge quickly for small
+ * angles, and not at all well for large ones, so the functions in here
+ * first reduce the angle modulo pi/2, which only changes the signs and
+ * swaps the sine and cosine, and then halve it until it is small. The
+ * doubling identities then get from the small angle back to the reduced
+ * one.
+ */
+namespace trigonometric {
+/**\brief Quarter turn
+ *
+ * Calculates pi/2 with math::pi, to the given number of bits. The result
+ * is cached, since every conversion needs it; the cache is per thread, so
+ * looking it up does not need a lock.
+ *
+ * \tparam Q Base data type, e.g. math::Q.
+ * \tparam N Data type for the number of bits.
+ *
+ * \param[in] bits How many bits after the binary point should be
+ *                 accurate.
+ *
+ * \returns pi/2.
+ */
+template <typename Q, typename N = unsigned long long>
+static const Q &quarterTurn(const N &bits) {
+  thread_local std::map<N, Q> cache;
+  auto it = cache.find(bits);
+
+  if (it == cache.end()) {
+    it = cache.insert({bits, pi<Q, N>::toPrecision(bits) / Q(2)}).first;
+  }
+
+  return it->second;
+}
+
+/**\brief Reduce angle
+ *
+ * Finds r in [0, pi/2] and the quadrant q so that |theta| = r + q*pi/2,
+ * modulo 2*pi. Instead of dividing by pi/2, this subtracts power-of-two
+ * multiples of pi/2 from the largest one down, which works with any type
+ * that can be compared, and only needs as many steps as the angle has
+ * bits.
+ *
+ * Every iteration of the power series gains at least 4 bits at the angles
+ * that it is used at, so pi/2 needs about 4 bits per iteration to match.
+ * The error of pi/2 is multiplied by q, so it gets one more bit for every
+ * bit of |theta| on top of that.
+ *
+ * \tparam Q Base data type, e.g. math::Q.
+ * \tparam N Data type for the number of iterations.
+ *
+ * \param[in]  theta      The angle to reduce.
+ * \param[out] quadrant   Where to write the quadrant to, in [0, 3].
+ * \param[in]  iterations Number of iterations for the power series.
+ *
+ * \returns The reduced angle r.
+ */
+template <typename Q, typename N = unsigned long long>
+static Q reduce(const Q &theta, unsigned int &quadrant, const N &iterations) {
+  Q r = theta < Q(0) ? Q(0) - theta : theta;
+  N bits = N(4) * iterations + N(8);
+
+  for (Q m = Q(1); !(r < m); m += m) {
+    bits++;
+  }
+
+  const Q &half = quarterTurn<Q, N>(bits);
+  std::vector<Q> multiples{half};
+
+  while (r > multiples.back() + multiples.back()) {
+    multiples.push_back(multiples.back() + multiples.back());
+  }
+
+  quadrant = 0;
+
+  for (std::size_t j = multiples.size(); j > 0; j--) {
+    if (r > multiples[(j - 1)]) {
+      r -= multiples[(j - 1)];
+      quadrant += j <= 2 ? 1u << (j - 1) : 0;
+    }
+  }
+
+  if (r > half) {
+    r -= half;
+    quadrant++;
+  }
+
+  quadrant %= 4;
+
+  return r;
+}
+
+/**\brief Power series for sine and cosine
+ *
+ * Adds up the same terms as the complex exponential function would for
+ * i*theta, without the complex multiplications.
+ *
+ * \tparam Q Base data type, e.g. math::Q.
+ * \tparam N Data type for the number of iterations.
+ *
+ * \param[in]  theta      The angle; should be small.
+ * \param[out] oCosine    Where to write the cosine to.
+ * \param[in]  iterations The power of theta to stop at.
+ *
+ * \returns The sine of theta.
+ */
+template <typename Q, typename N = unsigned long long>
+static Q taylor(const Q &theta, Q &oCosine, const N &iterations) {
+  Q s = Q(0);
+  Q c = Q(0);
+  Q term = Q(1);
+
+  for (N k = 0; k <= iterations; k++) {
+    switch (k % 4) {
+      case 0:
+        c += term;
+        break;
+      case 1:
+        s += term;
+        break;
+      case 2:
+        c -= term;
+        break;
+      case 3:
+        s -= term;
+        break;
+    }
+
+    term = term * theta / Q(k + 1);
+  }
+
+  oCosine = c;
+
+  return s;
+}
+
+/**\brief Rotate by quadrant
+ *
+ * Turns the sine and cosine of r into those of r + quadrant*pi/2, and
+ * flips the sign of the sine for negative angles.
+ *
+ * \tparam Q Base data type, e.g. math::Q.
+ *
+ * \param[in]     s        The sine of r.
+ * \param[in,out] c        The cosine of r; replaced with the cosine of the
+ *                         full angle.
+ * \param[in]     quadrant The quadrant from reduce().
+ * \param[in]     negative Whether the full angle was negative.
+ *
+ * \returns The sine of the full angle.
+ */
+template <typename Q>
+static Q rotate(const Q &s, Q &c, unsigned int quadrant, bool negative) {
+  Q rs = s;
+  Q rc = c;
+
+  switch (quadrant) {
+    case 1:
+      rs = c;
+      rc = Q(0) - s;
+      break;
+    case 2:
+      rs = Q(0) - s;
+      rc = Q(0) - c;
+      break;
+    case 3:
+      rs = Q(0) - c;
+      rc = s;
+      break;
+  }
+
+  c = rc;
+
+  return negative ? Q(0) - rs : rs;
+}
+
+/**\brief Sine and cosine of fractions of built-in integers
+ *
+ * The reduction and the power series need far more bits than built-in
+ * integers have, so this calculates the sine and cosine of the angle as a
+ * long double and replaces them with their best rational approximations.
+ * The denominators are kept to half the width of the integer type, so
+ * that products of two results still fit. There is no power series, so
+ * there is no number of iterations either; the accuracy is fixed by the
+ * width of the integer type.
+ *
+ * \tparam Q Base data type, e.g. math::fraction.
+ *
+ * \param[in]  theta   The angle to calculate the sine and cosine of.
+ * \param[out] oCosine Where to write the cosine to.
+ *
+ * \returns The sine of theta.
+ */
+template <typename Q>
+static Q approximate(const Q &theta, Q &oCosine) {
+  typedef typename numeric::traits<Q>::integral integral;
+  const long double x =
+      (long double)theta.numerator / (long double)theta.denominator;
+  const integral d = integral(1)
+                     << (std::numeric_limits<integral>::digits / 2);
+
+  oCosine = Q(numeric::bestApproximation(std::cos(x), d));
+
+  return Q(numeric::bestApproximation(std::sin(x), d));
+}
+
 /**\brief Calculate sine and cosine
  *
- * Uses the complex exponential function to calculate both the sine and
+ * Reduces the angle to [0, pi/2], halves it until it is at most 1/8,
+ * sums up the power series there and doubles the angle back up with
+ * sin(2x) = 2 sin(x) cos(x) and cos(2x) = 1 - 2 sin(x)^2. Fractions of
+ * built-in integers would overflow on the way, so those use approximate()
+ * instead, which ignores the number of iterations.
+ *
+ * \tparam Q Base data type, e.g. math::Q.
+ * \tparam N Data type for the number of iterations.
+ *
+ * \param[in]  theta      The angle to calculate the sine and cosine of.
+ * \param[out] oCosine    Where to write the cosine to.
+ * \param[in]  iterations Number of iterations for the power series;
+ *                        ignored for fractions of built-in integers.
+ *
+ * \returns The sine of theta.
+ */
+template <typename Q, typename N = unsigned long long>
+static Q sines(const Q &theta, Q &oCosine, const N &iterations) {
+  if constexpr (numeric::builtinFraction<Q>::value) {
+    return approximate(theta, oCosine);
+  }
+
+  unsigned int quadrant;
+  Q r = reduce<Q, N>(theta, quadrant, iterations);
+  unsigned int halvings = 0;
+
+  for (; r > Q(1) / Q(8); halvings++) {
+    r /= Q(2);
+  }
+
+  Q c;
+  Q s = taylor<Q, N>(r, c, iterations);
+
+  for (; halvings > 0; halvings--) {
+    const Q t = s;
+    s = Q(2) * s * c;
+    c = Q(1) - Q(2) * t * t;
+  }
+
+  s = rotate(s, c, quadrant, theta < Q(0));
+  oCosine = c;
+
+  return s;
+}
+
+/**\brief Table of sines and cosines
+ *
+ * An optional table of the sines and cosines at the dyadic angles j/2^d
+ * in [0, pi/2]. Looking up the largest of these angles below the reduced
+ * angle leaves a remainder of less than 2^-d, for which the power series
+ * converges in a handful of terms, and the addition theorems combine the
+ * two. This pays off when converting lots of angles with the same
+ * precision, e.g. polar coordinates. Fractions of built-in integers
+ * cannot hold the intermediate results, so for those the table stays
+ * empty and simply forwards to trigonometric::approximate().
+ *
+ * \tparam Q Base data type, e.g. math::Q.
+ * \tparam N Data type for the number of iterations.
+ */
+template <typename Q, typename N = unsigned long long>
+class table {
+ public:
+  /**\brief Construct with resolution
+   *
+   * Calculates the table with trigonometric::sines, unless Q is a
+   * fraction of built-in integers.
+   *
+   * \param[in] pBits      The resolution d of the table; it has about
+   *                       1.6*2^d entries.
+   * \param[in] pIterations Number of iterations for the power series.
+   */
+  table(unsigned int pBits = 6, const N &pIterations = N(10))
+      : bits(pBits), iterations(pIterations) {
+    if constexpr (!numeric::builtinFraction<Q>::value) {
+      typedef typename numeric::traits<Q>::integral integer;
+      const Q &end = quarterTurn<Q, N>(N(4) * iterations + N(8));
+      const Q step =
+          Q(1) / exponentiate::integral<Q>::raise(Q(2), integer(bits));
+
+      for (Q a = Q(0); !(a > end); a += step) {
+        Q c;
+        const Q s = trigonometric::sines<Q, N>(a, c, iterations);
+        sine.push_back(s);
+        cosine.push_back(c);
+      }
+    }
+  }
+
+  /**\brief Calculate sine and cosine
+   *
+   * Looks up the dyadic angle a and calculates the sine and cosine of the
+   * rest with the power series, then uses sin(a+b) = sin a cos b +
+   * cos a sin b and cos(a+b) = cos a cos b - sin a sin b.
+   *
+   * \param[in]  theta   The angle to calculate the sine and cosine of.
+   * \param[out] oCosine Where to write the cosine to.
+   *
+   * \returns The sine of theta.
+   */
+  Q sines(const Q &theta, Q &oCosine) const {
+    if constexpr (numeric::builtinFraction<Q>::value) {
+      return approximate(theta, oCosine);
+    }
+
+    unsigned int quadrant;
+    Q r = reduce<Q, N>(theta, quadrant, iterations);
+    Q a = Q(0);
+    Q step = Q(2);
+    std::size_t j = 0;
+
+    for (unsigned int b = 0; b <= bits; b++) {
+      step /= Q(2);
+      j *= 2;
+      if (!(a + step > r)) {
+        a += step;
+        j++;
+      }
+    }
+
+    Q cr;
+    const Q sr = taylor<Q, N>(r - a, cr, iterations);
+
+    Q c = cosine[j] * cr - sine[j] * sr;
+    const Q s = sine[j] * cr + cosine[j] * sr;
+
+    const Q rs = rotate(s, c, quadrant, theta < Q(0));
+    oCosine = c;
+
+    return rs;
+  }
+
+ protected:
+  /**\brief Resolution of the table */
+  const unsigned int bits;
+
+  /**\brief Number of iterations for the power series */
+  const N iterations;
+
+  /**\brief Sines of the dyadic angles */
+  std::vector<Q> sine;
+
+  /**\brief Cosines of the dyadic angles */
+  std::vector<Q> cosine;
+};
+}  // namespace trigonometric
+
+/**\brief Calculate sine and cosine
+ *
+ * Uses trigonometric::sines() to calculate both the sine and
  * cosine at the same time.
  *
  * \tparam Q Base data type, e.g. double.
@@ -32,41 +392,92 @@ namespace math {
  *
  * \param[in]  pTheta     The angle to calculate the sine and cosine of.
  * \param[out] oCosine    Where to write the cosine to.
- * \param[in]  iterations Number of iterations for the e function.
+ * \param[in]  iterations Number of iterations for the power series;
+ *                        ignored for fractions of built-in integers.
  *
  * \returns The sine of pTheta.
  */
 template <typename Q, typename N = unsigned long long>
 static inline Q sines(const Q &pTheta, Q &oCosine,
                       const N &iterations = N(10)) {
-  complex<Q> z =
-      e<complex<Q>, N>(complex<Q>(Q(1), Q(0)), complex<Q>(Q(0), pTheta),
-                       complex<Q>(Q(0), Q(0)), iterations);
+  return trigonometric::sines<Q, N>(pTheta, oCosine, iterations);
+}
+
+/**\brief Calculate sine and cosine
+ *
+ * Uses the system's std::sin() and std::cos() functions to calculate the
+ * sine and cosine.
+ *
+ * \tparam N Data type for the number of iterations.
+ *
+ * \param[in]  pTheta  The angle to calculate the sine and cosine of.
+ * \param[out] oCosine Where to write the cosine to.
+ *
+ * \returns The sine of pTheta.
+ */
+template <typename N = unsigned long long>
+static inline double sines(const double &pTheta, double &oCosine,
+                           const N & = N(10)) {
+  oCosine = std::cos(pTheta);
+  return std::sin(pTheta);
+}
 
-  oCosine = z.one;
+/**\brief Calculate sine and cosine
+ *
+ * Uses the system's std::sin() and std::cos() functions to calculate the
+ * sine and cosine.
+ *
+ * \tparam N Data type for the number of iterations.
+ *
+ * \param[in]  pTheta  The angle to calculate the sine and cosine of.
+ * \param[out] oCosine Where to write the cosine to.
+ *
+ * \returns The sine of pTheta.
+ */
+template <typename N = unsigned long long>
+static inline long double sines(const long double &pTheta,
+                                long double &oCosine, const N & = N(10)) {
+  oCosine = std::cos(pTheta);
+  return std::sin(pTheta);
+}
 
-  return z.i;
+/**\brief Calculate sine and cosine
+ *
+ * Uses the system's std::sin() and std::cos() functions to calculate the
+ * sine and cosine.
+ *
+ * \tparam N Data type for the number of iterations.
+ *
+ * \param[in]  pTheta  The angle to calculate the sine and cosine of.
+ * \param[out] oCosine Where to write the cosine to.
+ *
+ * \returns The sine of pTheta.
+ */
+template <typename N = unsigned long long>
+static inline float sines(const float &pTheta, float &oCosine,
+                          const N & = N(10)) {
+  oCosine = std::cos(pTheta);
+  return std::sin(pTheta);
 }
 
 /**\brief Calculate sine
  *
- * Uses the complex exponential function to calculate the sine of a
+ * Uses trigonometric::sines() to calculate the sine of a
  * given angle.
  *
  * \tparam Q Base data type, e.g. double.
  * \tparam N Data type for the number of iterations.
  *
  * \param[in] pTheta     The angle to calculate the sine of.
- * \param[in] iterations Number of iterations for the e function.
+ * \param[in] iterations Number of iterations for the power series;
+ *                       ignored for fractions of built-in integers.
  *
  * \returns The sine of pTheta.
  */
 template <typename Q, typename N = unsigned long long>
 constexpr static inline Q sine(const Q &pTheta, const N &iterations = N(10)) {
-  return complex<Q>(e<complex<Q>, N>(complex<Q>(Q(1), Q(0)),
-                                     complex<Q>(Q(0), pTheta),
-                                     complex<Q>(Q(0), Q(0)), iterations))
-      .i;
+  Q c = Q(0);
+  return trigonometric::sines<Q, N>(pTheta, c, iterations);
 }
 
 /**\brief Calculate sine
@@ -116,23 +527,23 @@ static inline float sine(const float &pTheta, const N & = N(10)) {
 
 /**\brief Calculate cosine
  *
- * Uses the complex exponential function to calculate the cosine of a
+ * Uses trigonometric::sines() to calculate the cosine of a
  * given angle.
  *
  * \tparam Q Base data type, e.g. double.
  * \tparam N Data type for the number of iterations.
  *
  * \param[in] pTheta     The angle to calculate the cosine of.
- * \param[in] iterations Number of iterations for the e function.
+ * \param[in] iterations Number of iterations for the power series;
+ *                       ignored for fractions of built-in integers.
  *
  * \returns The cosine of pTheta.
  */
 template <typename Q, typename N = unsigned long long>
 constexpr static inline Q cosine(const Q &pTheta, const N &iterations = N(10)) {
-  return complex<Q>(e<complex<Q>, N>(complex<Q>(Q(1), Q(0)),
-                                     complex<Q>(Q(0), pTheta),
-                                     complex<Q>(Q(0), Q(0)), iterations))
-      .one;
+  Q c = Q(0);
+  trigonometric::sines<Q, N>(pTheta, c, iterations);
+  return c;
 }
 
 /**\brief Calculate cosine
@@ -182,7 +593,7 @@ static inline float cosine(const float &pTheta, const N & = N(10)) {
 
 /**\brief Calculate secant and cosecant
  *
- * Uses the complex exponential function to calculate both the secant
+ * Uses trigonometric::sines() to calculate both the secant
  * and cosecant at the same time.
  *
  * \tparam Q Base data type, e.g. double.
@@ -191,41 +602,40 @@ static inline float cosine(const float &pTheta, const N & = N(10)) {
  * \param[in]  pTheta     The angle to calculate the secant and cosecant
  *                        of.
  * \param[out] oCosecant  Where to write the cosecant to.
- * \param[in]  iterations Number of iterations for the e function.
+ * \param[in]  iterations Number of iterations for the power series;
+ *                        ignored for fractions of built-in integers.
  *
  * \returns The secant of pTheta.
  */
 template <typename Q, typename N = unsigned long long>
 static inline Q secants(const Q &pTheta, Q &oCosecant,
                         const N &iterations = N(10)) {
-  complex<Q> z =
-      e<complex<Q>, N>(complex<Q>(Q(1), Q(0)), complex<Q>(Q(0), pTheta),
-                       complex<Q>(Q(0), Q(0)), iterations);
+  Q c = Q(0);
+  const Q s = trigonometric::sines<Q, N>(pTheta, c, iterations);
 
-  oCosecant = Q(1) / z.i;
+  oCosecant = Q(1) / s;
 
-  return Q(1) / z.one;
+  return Q(1) / c;
 }
 
 /**\brief Calculate secant
  *
- * Uses the complex exponential function to calculate the secant of a
+ * Uses trigonometric::sines() to calculate the secant of a
  * given angle.
  *
  * \tparam Q Base data type, e.g. double.
  * \tparam N Data type for the number of iterations.
  *
  * \param[in] pTheta     The angle to calculate the secant of.
- * \param[in] iterations Number of iterations for the e function.
+ * \param[in] iterations Number of iterations for the power series;
+ *                       ignored for fractions of built-in integers.
  *
  * \returns The secant of pTheta.
  */
 template <typename Q, typename N = unsigned long long>
 constexpr static inline Q secant(const Q &pTheta, const N &iterations = N(10)) {
-  return Q(1) / complex<Q>(e<complex<Q>, N>(complex<Q>(Q(1), Q(0)),
-                                            complex<Q>(Q(0), pTheta),
-                                            complex<Q>(Q(0), Q(0)), iterations))
-                    .i;
+  Q c = Q(0);
+  return Q(1) / trigonometric::sines<Q, N>(pTheta, c, iterations);
 }
 
 /**\brief Calculate secant
@@ -275,24 +685,24 @@ static inline float secant(const float &pTheta, const N & = N(10)) {
 
 /**\brief Calculate cosecant
  *
- * Uses the complex exponential function to calculate the cosecant of a
+ * Uses trigonometric::sines() to calculate the cosecant of a
  * given angle.
  *
  * \tparam Q Base data type, e.g. double.
  * \tparam N Data type for the number of iterations.
  *
  * \param[in] pTheta     The angle to calculate the cosecant of.
- * \param[in] iterations Number of iterations for the e function.
+ * \param[in] iterations Number of iterations for the power series;
+ *                       ignored for fractions of built-in integers.
  *
  * \returns The cosecant of pTheta.
  */
 template <typename Q, typename N = unsigned long long>
 constexpr static inline Q cosecant(const Q &pTheta,
                                    const N &iterations = N(10)) {
-  return Q(1) / complex<Q>(e<complex<Q>, N>(complex<Q>(Q(1), Q(0)),
-                                            complex<Q>(Q(0), pTheta),
-                                            complex<Q>(Q(0), Q(0)), iterations))
-                    .one;
+  Q c = Q(0);
+  trigonometric::sines<Q, N>(pTheta, c, iterations);
+  return Q(1) / c;
 }
 
 /**\brief Calculate cosecant
@@ -343,21 +753,24 @@ static inline float cosecant(const float &pTheta, const N & = N(10)) {
 
 /**\brief Calculate tangent
  *
- * Uses the complex exponential function to calculate the tangent of a
+ * Uses trigonometric::sines() to calculate the tangent of a
  * given angle.
  *
  * \tparam Q Base data type, e.g. double.
  * \tparam N Data type for the number of iterations.
  *
  * \param[in] pTheta     The angle to calculate the tangent of.
- * \param[in] iterations Number of iterations for the e function.
+ * \param[in] iterations Number of iterations for the power series;
+ *                       ignored for fractions of built-in integers.
  *
  * \returns The tangent of pTheta.
  */
 template <typename Q, typename N = unsigned long long>
 constexpr static inline Q tangent(const Q &pTheta,
                                   const N &iterations = N(10)) {
-  return sine(pTheta, iterations) / cosine(pTheta, iterations);
+  Q c = Q(0);
+  const Q s = trigonometric::sines<Q, N>(pTheta, c, iterations);
+  return s / c;
 }
 
 /**\brief Calculate tangent
@@ -408,21 +821,24 @@ static inline float tangent(const float &pTheta, const N & = N(10)) {
 
 /**\brief Calculate cotangent
  *
- * Uses the complex exponential function to calculate the cotangent of a
+ * Uses trigonometric::sines() to calculate the cotangent of a
  * given angle.
  *
  * \tparam Q Base data type, e.g. double.
  * \tparam N Data type for the number of iterations.
  *
  * \param[in] pTheta     The angle to calculate the cotangent of.
- * \param[in] iterations Number of iterations for the e function.
+ * \param[in] iterations Number of iterations for the power series;
+ *                       ignored for fractions of built-in integers.
  *
  * \returns The cotangent of pTheta.
  */
 template <typename Q, typename N = unsigned long long>
 constexpr static inline Q cotangent(const Q &pTheta,
                                     const N &iterations = N(10)) {
-  return cosine(pTheta, iterations) / sine(pTheta, iterations);
+  Q c = Q(0);
+  const Q s = trigonometric::sines<Q, N>(pTheta, c, iterations);
+  return c / s;
 }
 
 /**\brief Calculate cotangent
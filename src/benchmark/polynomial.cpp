@@ -0,0 +1,108 @@
+/* Benchmark for the batched polynomial evaluation
+ *
+ * Evaluates polynomials of degree 8 and 32 at a large number of points,
+ * once with a plain loop over the polynomial's call operator and once
+ * with the batched evaluate() functions, and prints the times and the
+ * speedup. Build with "make benchmark-polynomial", and add e.g.
+ * CFLAGS="-O2 -mavx2 -mfma" to see the effect of wider vectors.
+ *
+ * See also:
+ * * Project Documentation: https://ef.gy/documentation/libefgy
+ * * Project Source Code: https://github.com/ef-gy/libefgy
+ * * Licence Terms: https://github.com/ef-gy/libefgy/blob/master/COPYING
+ *
+ * @copyright
+ * This file is part of the libefgy project, which is released as open source
+ * under the terms of an MIT/X11-style licence, described in the COPYING file.
+ */
+
+#include <ef.gy/polynomial.h>
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+using namespace efgy::math;
+
+/* Time a function
+ * @f      The function to time.
+ * @rounds How often to call it.
+ *
+ * @return The average time per call, in seconds.
+ */
+template <typename F>
+static double time(const F &f, unsigned int rounds) {
+  const auto start = std::chrono::steady_clock::now();
+
+  for (unsigned int i = 0; i < rounds; i++) {
+    f();
+  }
+
+  const std::chrono::duration<double> d =
+      std::chrono::steady_clock::now() - start;
+
+  return d.count() / rounds;
+}
+
+/* Benchmark one polynomial
+ * @name A name for the coefficient type, for the output.
+ *
+ * Evaluates a polynomial with n coefficients at 2^16 points in [-1, 1],
+ * and prints the time for the scalar loop, the batched values and the
+ * batched values with the derivative.
+ */
+template <typename Q, unsigned int n>
+static void benchmark(const char *name) {
+  const std::size_t count = 1 << 16;
+  const unsigned int rounds = 200;
+  polynomial<Q, n> p;
+  std::vector<Q> x(count), v(count), d(count);
+  volatile Q sink;
+
+  for (unsigned int i = 0; i < n; i++) {
+    p.coefficients[i] = Q(1) / Q(i + 2);
+  }
+
+  for (std::size_t i = 0; i < count; i++) {
+    x[i] = Q(-1) + Q(2) * Q(i) / Q(count);
+  }
+
+  const double scalar = time(
+      [&] {
+        for (std::size_t i = 0; i < count; i++) {
+          v[i] = p(x[i]);
+        }
+        sink = v[count / 2];
+      },
+      rounds);
+
+  const double batch = time(
+      [&] {
+        p.evaluate(x.data(), v.data(), count);
+        sink = v[count / 2];
+      },
+      rounds);
+
+  const double fused = time(
+      [&] {
+        p.evaluate(x.data(), v.data(), d.data(), count);
+        sink = d[count / 2];
+      },
+      rounds);
+
+  (void)sink;
+
+  std::cout << name << ", degree " << (n - 1) << ": scalar " << scalar * 1e6
+            << " us, batch " << batch * 1e6 << " us (" << scalar / batch
+            << "x), with derivative " << fused * 1e6 << " us\n";
+}
+
+int main(int, char **) {
+  benchmark<float, 9>("float");
+  benchmark<float, 33>("float");
+  benchmark<double, 9>("double");
+  benchmark<double, 33>("double");
+
+  return 0;
+}
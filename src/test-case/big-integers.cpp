@@ -423,8 +423,561 @@ bool testBigIntegerBitShifts(std::ostream &log) {
   return true;
 }
 
+/* Pseudo-random big integer
+ * @seed State of the linear congruential generator to use.
+ * @cells How many cells the result should have.
+ *
+ * Creates a big integer out of a deterministic sequence of pseudo-random cells,
+ * so that the test cases below are reproducible.
+ *
+ * @return A positive big integer with the given number of cells.
+ */
+static Z randomBigInteger(unsigned long long &seed, unsigned int cells) {
+  Z r = Z(0);
+
+  for (unsigned int i = 0; i < cells; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    r.cell.push_back((unsigned int)(seed >> 32) | 1);
+  }
+
+  return r;
+}
+
+/* Big integer multiplication tests
+ * @log Where to write log messages to.
+ *
+ * Multiplies pseudo-random big integers of sizes on either side of the
+ * Karatsuba and Toom-3 thresholds, including unbalanced operands, and compares
+ * the results with a product that is accumulated from single-cell products.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBigIntegerMultiplication(std::ostream &log) {
+  const Z base = Z(1ll << 32);
+  const unsigned int sizes[][2] = {
+      {1, 3},     {5, 40},    {31, 33},   {64, 64},    {90, 31},
+      {150, 400}, {250, 250}, {401, 250}, {600, 599}, {2300, 2100}};
+  unsigned long long seed = 42;
+
+  for (const auto &size : sizes) {
+    const Z a = randomBigInteger(seed, size[0]);
+    const Z b = -randomBigInteger(seed, size[1]);
+    Z reference = Z(0);
+
+    for (std::size_t i = b.cell.size(); i > 0; i--) {
+      reference = reference * base + a * Z((long long)b.cell[(i - 1)]);
+    }
+    reference = -reference;
+
+    if (a * b != reference) {
+      log << "big integer product mismatch for operands with " << size[0]
+          << " and " << size[1] << " cells\n";
+      return false;
+    }
+
+    if (b * a != reference) {
+      log << "big integer product does not commute for operands with "
+          << size[0] << " and " << size[1] << " cells\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Number-theoretic transform multiplication tests
+ * @log Where to write log messages to.
+ *
+ * Multiplies pseudo-random big integers that are large enough to use the
+ * number-theoretic transform, and compares the result with the sum of the
+ * partial products with the lower and upper halves of the second factor, which
+ * are computed with the Toom-3 algorithm.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBigIntegerTransformMultiplication(std::ostream &log) {
+  const unsigned int cells = Z::numberTheoreticThreshold + 1000;
+  const unsigned int half = cells / 2;
+  unsigned long long seed = 23;
+
+  const Z a = randomBigInteger(seed, cells);
+  const Z b = randomBigInteger(seed, cells);
+  Z low = Z(0);
+  Z high = Z(0);
+
+  low.cell.assign(b.cell.begin(), b.cell.begin() + half);
+  high.cell.assign(b.cell.begin() + half, b.cell.end());
+
+  Z reference = a * high;
+  reference.cell.insert(reference.cell.begin(), half, 0);
+  reference += a * low;
+
+  if (a * b != reference) {
+    log << "big integer product mismatch for operands with " << cells
+        << " cells\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Big integer division tests
+ * @log Where to write log messages to.
+ *
+ * Divides pseudo-random big integers of various sizes and signs, as well as
+ * some that are known to trigger the rare correction steps in Knuth's
+ * Algorithm D, and checks that the quotient and remainder returned by divmod()
+ * reconstruct the dividend, that the remainder is smaller than the divisor and
+ * that operator/= and operator% agree with divmod().
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBigIntegerDivision(std::ostream &log) {
+  const unsigned int sizes[][2] = {
+      {3, 1},     {4, 2},      {9, 5},      {40, 39},    {200, 20},
+      {300, 129}, {700, 250},  {90, 130},   {3100, 3100}, {8000, 3300}};
+  unsigned long long seed = 7;
+  vector<std::pair<Z, Z>> operands;
+
+  for (const auto &size : sizes) {
+    const Z a = randomBigInteger(seed, size[0]);
+    const Z b = randomBigInteger(seed, size[1]);
+
+    operands.push_back({a, b});
+    operands.push_back({-a, b});
+    operands.push_back({a, -b});
+  }
+
+  Z ones = Z(0);
+  Z top = Z(0);
+  ones.cell.assign(12, 0xffffffff);
+  top.cell.assign(6, 0);
+  top.cell.push_back(0x80000000);
+  operands.push_back({ones, top});
+  operands.push_back({ones * ones, ones + Z(1)});
+  operands.push_back({top * ones - Z(1), ones});
+
+  for (const auto &o : operands) {
+    const Z &a = o.first;
+    const Z &b = o.second;
+    const auto qr = a.divmod(b);
+    const Z &q = qr.first;
+    const Z &r = qr.second;
+    const Z rp = r < Z(0) ? -r : r;
+    const Z bp = b < Z(0) ? -b : b;
+    Z c = a;
+
+    if (q * b + r != a) {
+      log << "quotient and remainder do not reconstruct dividend with "
+          << a.cell.size() << " and " << b.cell.size() << " cells\n";
+      return false;
+    }
+
+    if (!(rp < bp) || ((r != Z(0)) && ((r < Z(0)) != (a < Z(0))))) {
+      log << "remainder " << r << " out of range for divisor " << b << "\n";
+      return false;
+    }
+
+    if ((c /= b) != q) {
+      log << "quotient " << c << " should have been " << q << "\n";
+      return false;
+    }
+
+    if (a % b != r) {
+      log << "remainder " << (a % b) << " should have been " << r << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Big integer string conversion tests
+ * @log Where to write log messages to.
+ *
+ * Converts pseudo-random big integers of various sizes to strings in all the
+ * supported bases and back, checks that powers of ten and their predecessors
+ * produce the expected digits, and that parsing stops at the first character
+ * that is not a digit.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBigIntegerStringConversion(std::ostream &log) {
+  const unsigned int sizes[] = {1, 2, 7, 63, 64, 200, 700};
+  unsigned long long seed = 1;
+
+  for (const auto &size : sizes) {
+    const Z a = randomBigInteger(seed, size);
+
+    for (unsigned int base = 2; base <= 36; base++) {
+      for (const Z &x : {a, -a}) {
+        const string s = x.toChars(base);
+        Z y;
+
+        if (Z::fromChars(s.data(), s.data() + s.size(), y, base) !=
+            s.data() + s.size()) {
+          log << "could not parse all of '" << s << "' in base " << base
+              << "\n";
+          return false;
+        }
+
+        if (x != y) {
+          log << "round trip mismatch in base " << base << " for a number "
+              << "with " << size << " cells\n";
+          return false;
+        }
+      }
+    }
+  }
+
+  Z p = Z(1);
+
+  for (unsigned int i = 1; i <= 3000; i++) {
+    p *= Z(10);
+
+    if (i % 997 == 0) {
+      const string nines(i, '9');
+      const string power = "1" + string(i, '0');
+
+      if ((p - Z(1)).toChars() != nines) {
+        log << "10^" << i << "-1 was not written as " << i << " nines\n";
+        return false;
+      }
+
+      if (p.toChars() != power) {
+        log << "10^" << i << " was not written correctly\n";
+        return false;
+      }
+    }
+  }
+
+  const string partial = "-12345678901234567890xyz";
+  Z z = Z(5);
+
+  if ((Z::fromChars(partial.data(), partial.data() + partial.size(), z) !=
+       partial.data() + 21) ||
+      (z.toChars() != "-12345678901234567890")) {
+    log << "parsing '" << partial << "' resulted in " << z << "\n";
+    return false;
+  }
+
+  if ((Z::fromChars(partial.data() + 21, partial.data() + 24, z) !=
+       partial.data() + 21) ||
+      (z.toChars() != "-12345678901234567890")) {
+    log << "parsing an invalid string should not have modified " << z << "\n";
+    return false;
+  }
+
+  if ((Z::fromChars(partial.data() + 21, partial.data() + 24, z, 36) !=
+       partial.data() + 24) ||
+      (z.toChars(36) != "xyz")) {
+    log << "'xyz' should have been parsed as " << z.toChars(36) << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Big integer cell storage tests
+ * @log Where to write log messages to.
+ *
+ * Checks that small numbers are kept in the inline cell buffer through
+ * copies, moves and assignments, that growing numbers spill over to the heap
+ * and that copies and moves of spilled numbers preserve their value.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBigIntegerStorage(std::ostream &log) {
+  Z a = Z(123456789012345LL);
+  Z b = a;
+  Z c = std::move(b);
+  Z d;
+
+  d = c;
+
+  if (!a.cell.isInline() || !c.cell.isInline() || !d.cell.isInline() ||
+      (c != a) || (d != a)) {
+    log << "small numbers should have been stored inline\n";
+    return false;
+  }
+
+  unsigned long long seed = 7;
+  const Z large = randomBigInteger(seed, 40);
+  Z e = large;
+
+  if (e.cell.isInline() || (e != large)) {
+    log << "copying a large number failed\n";
+    return false;
+  }
+
+  const unsigned int *p = e.cell.data();
+  Z f = std::move(e);
+
+  if ((f.cell.data() != p) || (f != large) || (e.cell.size() != 0)) {
+    log << "moving a large number should have taken over its cells\n";
+    return false;
+  }
+
+  f = a;
+  p = f.cell.data();
+  f = d;
+
+  if ((f.cell.data() != p) || (f != a)) {
+    log << "assigning a small number should have reused the cells\n";
+    return false;
+  }
+
+  Z g = a;
+
+  for (unsigned int i = 0; i < 200; i++) {
+    g *= a;
+  }
+
+  for (unsigned int i = 0; i < 200; i++) {
+    g /= a;
+  }
+
+  if (g != a) {
+    log << "growing and shrinking resulted in " << g << " instead of " << a
+        << "\n";
+    return false;
+  }
+
+  std::swap(f, g);
+  f.cell.swap(d.cell);
+
+  if ((f != a) || (d != a) || (g != a)) {
+    log << "swapping cells failed\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Big integer compound assignment tests
+ * @log Where to write log messages to.
+ *
+ * Compares the in-place compound assignment operators, the increment and
+ * decrement operators and the overloads for temporary left operands with the
+ * plain binary operators, including operands with different signs, operands
+ * that alias each other and results that cross zero.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBigIntegerCompoundAssignment(std::ostream &log) {
+  unsigned long long seed = 3;
+  const unsigned int sizes[][2] = {{1, 1}, {3, 5}, {9, 9}, {40, 12}, {70, 71}};
+
+  for (const auto &size : sizes) {
+    const Z x = randomBigInteger(seed, size[0]);
+    const Z y = randomBigInteger(seed, size[1]);
+
+    for (const Z &a : {x, -x}) {
+      for (const Z &b : {y, -y, x, -x}) {
+        const Z sum = a + b;
+        const Z difference = a - b;
+        const Z product = a * b;
+        Z c = a;
+
+        if (((c += b) != sum) || ((c -= b) != a) || ((c *= b) != product) ||
+            ((c %= a) != Z(0))) {
+          log << "compound assignment mismatch for numbers with " << size[0]
+              << " and " << size[1] << " cells\n";
+          return false;
+        }
+
+        if ((Z(a) + b != sum) || (Z(a) - b != difference) ||
+            (Z(a) * b != product) || (Z(product) % a != Z(0))) {
+          log << "rvalue operator mismatch for numbers with " << size[0]
+              << " and " << size[1] << " cells\n";
+          return false;
+        }
+
+        if ((sum - b != a) || (difference + b != a) ||
+            (-difference != b - a)) {
+          log << "sum " << sum << " or difference " << difference
+              << " inconsistent\n";
+          return false;
+        }
+      }
+
+      Z c = a;
+
+      if (((c += c) != a * Z(2)) || ((c -= c) != Z(0)) || (c.negative)) {
+        log << "adding a number to itself failed for " << a << "\n";
+        return false;
+      }
+    }
+  }
+
+  Z c = Z(-2);
+
+  for (int i = -2; i <= 2; i++, ++c) {
+    if (c != Z(i)) {
+      log << "incrementing resulted in " << c << " instead of " << i << "\n";
+      return false;
+    }
+  }
+
+  Z d = Z(1) << 64;
+
+  if ((d-- != (Z(1) << 64)) || (d != Z(0xffffffffffffffffULL, false)) ||
+      (++d != (Z(1) << 64))) {
+    log << "decrementing and incrementing across a cell boundary failed\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Big integer GCD tests
+ * @log Where to write log messages to.
+ *
+ * Compares the greatest common divisors calculated by the binary GCD for
+ * built-in integers and by Lehmer's algorithm and the half-GCD for big
+ * integers with those of the plain Euclidean algorithm. Numbers too large
+ * for the Euclidean algorithm to finish quickly are checked against the
+ * result with 64-bit cells, and by dividing them by their GCD.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBigIntegerGCD(std::ostream &log) {
+  for (long long i = -40; i <= 40; i++) {
+    for (long long j = -40; j <= 40; j++) {
+      const long long g = efgy::math::numeric::gcd(i, j);
+      const long long e = efgy::math::numeric::gcdP(
+          i < 0 ? -i : i, j < 0 ? -j : j, efgy::math::numeric::euclideanGCD());
+
+      if ((g != e) || (Z::gcd(Z(i), Z(j)) != Z(e))) {
+        log << "gcd(" << i << ", " << j << ") should have been " << e << "\n";
+        return false;
+      }
+    }
+  }
+
+  const unsigned int sizes[][3] = {{1, 1, 1},    {3, 2, 1},      {9, 9, 4},
+                                   {40, 3, 2},   {100, 100, 30}, {400, 390, 1},
+                                   {800, 20, 5}, {1500, 1500, 700}};
+  unsigned long long seed = 11;
+
+  for (const auto &size : sizes) {
+    const Z g = randomBigInteger(seed, size[2]);
+    const Z a = randomBigInteger(seed, size[0]) * g;
+    const Z b = -randomBigInteger(seed, size[1]) * g;
+    const Z e = efgy::math::numeric::gcdP(a, -b,
+                                          efgy::math::numeric::euclideanGCD());
+
+    if ((Z::gcd(a, b) != e) || (efgy::math::numeric::gcd(b, a) != e) ||
+        (Z::gcd(a, a + e) != e)) {
+      log << "GCD mismatch for numbers with " << size[0] << " and " << size[1]
+          << " cells\n";
+      return false;
+    }
+  }
+
+  const Z g = randomBigInteger(seed, 2500);
+  const Z a = randomBigInteger(seed, 7000) * g;
+  const Z b = randomBigInteger(seed, 6800) * g;
+  const Z d = Z::gcd(a, b);
+
+#if defined(__SIZEOF_INT128__)
+  const string as = a.toChars(16);
+  const string bs = b.toChars(16);
+  Z64 wa, wb;
+
+  Z64::fromChars(as.data(), as.data() + as.size(), wa, 16);
+  Z64::fromChars(bs.data(), bs.data() + bs.size(), wb, 16);
+
+  if (Z64::gcd(wa, wb).toChars(16) != d.toChars(16)) {
+    log << "GCD with 64-bit cells does not match\n";
+    return false;
+  }
+#endif
+
+  if ((a % d != Z(0)) || (b % d != Z(0)) || (d % g != Z(0))) {
+    log << "GCD of large numbers does not divide both of them\n";
+    return false;
+  }
+
+  Z x = a;
+  Z y = b;
+  x /= d;
+  y /= d;
+
+  if (Z::gcd(x, y) != Z(1)) {
+    log << "large numbers divided by their GCD are not coprime\n";
+    return false;
+  }
+
+  return true;
+}
+
+#if defined(__SIZEOF_INT128__)
+/* Big integers with 64-bit cells
+ * @log Where to write log messages to.
+ *
+ * Repeats some products, quotients and remainders of pseudo-random numbers
+ * with the Z64 type, and compares the results to those obtained with the
+ * default 32-bit cells. The operands are converted via strings, so this also
+ * covers the string conversions of Z64.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testWideBigIntegers(std::ostream &log) {
+  const unsigned int sizes[][2] = {{2, 1},      {7, 3},       {80, 66},
+                                   {500, 4100}, {4500, 4400}, {7000, 3200}};
+  unsigned long long seed = 99;
+
+  for (const auto &size : sizes) {
+    const Z a = randomBigInteger(seed, size[0]);
+    const Z b = -randomBigInteger(seed, size[1]);
+    const string as = a.toChars(16);
+    const string bs = b.toChars(16);
+    Z64 wa, wb;
+
+    Z64::fromChars(as.data(), as.data() + as.size(), wa, 16);
+    Z64::fromChars(bs.data(), bs.data() + bs.size(), wb, 16);
+
+    if ((wa.toChars() != a.toChars()) || (wb.toChars(7) != b.toChars(7))) {
+      log << "string conversion mismatch for numbers with " << size[0]
+          << " and " << size[1] << " cells\n";
+      return false;
+    }
+
+    if ((wa * wb).toChars(16) != (a * b).toChars(16)) {
+      log << "product mismatch for numbers with " << size[0] << " and "
+          << size[1] << " cells\n";
+      return false;
+    }
+
+    const auto qr = a.divmod(b);
+    const auto wqr = wa.divmod(wb);
+
+    if ((wqr.first.toChars(16) != qr.first.toChars(16)) ||
+        (wqr.second.toChars(16) != qr.second.toChars(16))) {
+      log << "quotient or remainder mismatch for numbers with " << size[0]
+          << " and " << size[1] << " cells\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+#endif
+
 namespace test {
 using efgy::test::function;
 
 static function bigIntegerBitShifts(testBigIntegerBitShifts);
+static function bigIntegerMultiplication(testBigIntegerMultiplication);
+static function bigIntegerTransformMultiplication(
+    testBigIntegerTransformMultiplication);
+static function bigIntegerDivision(testBigIntegerDivision);
+static function bigIntegerStringConversion(testBigIntegerStringConversion);
+static function bigIntegerStorage(testBigIntegerStorage);
+static function bigIntegerCompoundAssignment(testBigIntegerCompoundAssignment);
+static function bigIntegerGCD(testBigIntegerGCD);
+#if defined(__SIZEOF_INT128__)
+static function wideBigIntegers(testWideBigIntegers);
+#endif
 }  // namespace test
@@ -18,6 +18,7 @@
 #include <ef.gy/test-case.h>
 
 #include <iostream>
+#include <vector>
 
 using namespace efgy::math;
 using std::string;
@@ -81,8 +82,200 @@ bool testContinuedFractionArithmetic(std::ostream &log) {
   return true;
 }
 
+/* Continued fractions of big integers
+ * @log A stream for test cases to log messages to.
+ *
+ * Does arithmetic with continued fractions of small and large fractions of
+ * big integers, so that the operators start out with machine words and
+ * have to switch to big integers at different points.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBigContinuedFractions(std::ostream &log) {
+  Z n = Z(1);
+
+  for (unsigned int i = 0; i < 40; i++) {
+    const Q af(n + Z(7), n * Z(3) + Z(1)), bf(n * Z(5) - Z(2), n + Z(9));
+    const numeric::continuedFractional<Z> a(af), b(bf);
+    const Q s = a + b, d = b - a, p = a * b, q = a / b;
+
+    if ((s != af + bf) || (d != bf - af) || (p != af * bf) ||
+        (q != af / bf)) {
+      log << "arithmetic with " << a << " and " << b << " resulted in " << s
+          << ", " << d << ", " << p << " and " << q << "\n";
+      return false;
+    }
+
+    n = n * Z(29) + Z(i);
+  }
+
+  return true;
+}
+
+/* Lazy continued fractions
+ * @log A stream for test cases to log messages to.
+ *
+ * Does arithmetic with rational lazy continued fractions and compares the
+ * results with the same arithmetic on fractions, then does some arithmetic
+ * with e and square roots, which only works because the coefficients are
+ * generated as they are needed. The product of a square root with itself
+ * never produces a coefficient, so it has to be cut off after a while,
+ * which makes it inexact, along with anything calculated from it; with a
+ * patience of only 16 terms, it is also visibly off.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testLazyContinuedFractions(std::ostream &log) {
+  typedef numeric::lazyContinuedFractional<long long> lazy;
+  typedef numeric::lazyContinuedFractional<Z> big;
+  typedef numeric::lazyContinuedFractional<Z, 16> impatient;
+
+  const numeric::fractional<long long> af(6, 11), bf(-4, 5), cf(7, 3),
+      nf(-7, 3);
+  const lazy a(af), b(bf), c = numeric::continuedFractional<long long>(nf);
+
+  const lazy sum = a + b;
+  const numeric::fractional<long long> s = sum.convergent(100),
+                                       d = (a - c).convergent(100),
+                                       p = (b * a).convergent(100),
+                                       q = (a / lazy(cf)).convergent(100),
+                                       n = (-lazy(cf)).convergent(100);
+
+  if ((s != af + bf) || (d != af + cf) || (p != af * bf) || (q != af / cf) ||
+      (n != nf) || !sum.exact()) {
+    log << "lazy arithmetic resulted in " << s << ", " << d << ", " << p
+        << ", " << q << " and " << n << "\n";
+    return false;
+  }
+
+  const big e = big::eulersNumber();
+
+  if (e.convergent(9) != Q(Z(1457), Z(536))) {
+    log << "ninth convergent of e is " << e.convergent(9) << "\n";
+    return false;
+  }
+
+  const Z precision = Z(10) ^ Z(30);
+  const Q two = (big::squareRoot(Z(2)) * big::squareRoot(Z(2)))
+                    .approximation(precision);
+  const Q six = (big::squareRoot(Z(2)) * big::squareRoot(Z(3)) /
+                 big::squareRoot(Z(6)))
+                    .approximation(precision);
+
+  if ((two != Q(Z(2))) || (six != Q(Z(1)))) {
+    log << "products of square roots are " << two << " and " << six << "\n";
+    return false;
+  }
+
+  const big root = big::squareRoot(Z(2)) * big::squareRoot(Z(2));
+  const impatient quick =
+      impatient::squareRoot(Z(2)) * impatient::squareRoot(Z(2));
+  const big shifted = root + big(Z(1));
+  const Q r = root.convergent(100), q2 = quick.convergent(100),
+          r1 = shifted.convergent(100);
+
+  if (root.exact() || quick.exact() || shifted.exact() ||
+      (r1 != r + Q(Z(1))) || (r == q2) || (q2 == Q(Z(2))) ||
+      ((q2 - Q(Z(2))) * (q2 - Q(Z(2))) > Q(Z(1), Z(1000000)))) {
+    log << "sqrt(2)^2 is " << r << ", or " << q2 << " with less patience\n";
+    return false;
+  }
+
+  const big z = e * e + big::squareRoot(Z(2));
+  const Q x = z.approximation(precision);
+  const Q y = (e * e).approximation(precision * precision) +
+              big::squareRoot(Z(2)).approximation(precision * precision);
+  Q error = x - y;
+
+  if (error.numerator < Z(0)) {
+    error *= Z(-1);
+  }
+
+  if ((error * Q(precision) > Q(Z(1))) ||
+      !z.exact()) {
+    log << "e^2 + sqrt(2) is " << x << " instead of " << y << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Best rational approximations
+ * @log A stream for test cases to log messages to.
+ *
+ * Compares the best approximations of small fractions with those found by
+ * trying all the fractions with a small enough denominator, then checks
+ * some well known approximations of pi and the vector forms.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBestApproximation(std::ostream &log) {
+  for (long long n = -30; n <= 30; n++) {
+    for (long long d = 1; d <= 17; d++) {
+      const fraction x(n, d);
+
+      for (long long m = 1; m <= 9; m++) {
+        const fraction r = numeric::bestApproximation(x, m);
+        fraction best, error;
+
+        for (long long q = 1; q <= m; q++) {
+          for (long long p = n * q / d - 1; p <= n * q / d + 1; p++) {
+            fraction e = fraction(p, q) - x;
+
+            if (e.numerator < 0) {
+              e *= -1;
+            }
+
+            if ((q == 1 && p == n * q / d - 1) || (e < error)) {
+              best = fraction(p, q);
+              error = e;
+            }
+          }
+        }
+
+        if (r != best) {
+          log << "best approximation of " << x << " with a denominator of "
+              << m << " or less is " << best << ", not " << r << "\n";
+          return false;
+        }
+      }
+    }
+  }
+
+  const Q pi = numeric::bestApproximation(3.14159265358979323846, Z(1000));
+  const fraction npi =
+      numeric::bestApproximation(-3.14159265358979323846, 57LL);
+
+  if ((pi != Q(Z(355), Z(113))) || (npi != fraction(-179, 57)) ||
+      (numeric::bestApproximation(0.1f, 1000LL) != fraction(1, 10)) ||
+      (numeric::bestApproximation(-1e20, Z(1)) !=
+       Q(Z(-100000000000LL) * Z(1000000000LL)))) {
+    log << "best approximations of pi are " << pi << " and " << npi << "\n";
+    return false;
+  }
+
+  vector<fraction, 2> v;
+  v[0] = fraction(355, 113);
+  v[1] = fraction(-1, 3);
+
+  std::vector<vector<fraction, 2>> mesh(3, v);
+  numeric::bestApproximation(mesh.begin(), mesh.end(), 10LL);
+
+  for (const vector<fraction, 2> &w : mesh) {
+    if ((w[0] != fraction(22, 7)) || (w[1] != fraction(-1, 3))) {
+      log << "vector was approximated as " << w << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
 namespace test {
 using efgy::test::function;
 
 static function continuedFractionArithmetic(testContinuedFractionArithmetic);
+static function bigContinuedFractions(testBigContinuedFractions);
+static function lazyContinuedFractions(testLazyContinuedFractions);
+static function bestApproximation(testBestApproximation);
 }  // namespace test
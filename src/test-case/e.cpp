@@ -16,8 +16,10 @@
 #include <ef.gy/e.h>
 #include <ef.gy/fractions.h>
 #include <ef.gy/primitive.h>
+#include <ef.gy/series-parallel.h>
 #include <ef.gy/test-case.h>
 
+#include <cmath>
 #include <iostream>
 
 using namespace efgy::math;
@@ -30,7 +32,8 @@ typedef primitive<long double, unsigned long long> longDouble;
  *
  * Initialises several instances of the 'e' template with different base types
  * and precisions. The instances are then cast to different types and written to
- * the log to verify that the template comeles cleanly.
+ * the log, and the fractions are compared with the exact partial sums of the
+ * series.
  *
  * @return 'true' on success, 'false' otherwise.
  */
@@ -65,6 +68,220 @@ bool testE(std::ostream &log) {
   log << "e<fraction,8> = " << fraction(eQ3) << "\n";
   log << "e<fraction,12> = " << fraction(eQ4) << "\n";
 
+  if ((fraction(eQ1) != fraction(2)) || (fraction(eQ2) != fraction(65, 24)) ||
+      (fraction(eQ3) != fraction(109601, 40320)) ||
+      (fraction(eQ4) != fraction(260412269, 95800320))) {
+    log << "e<fraction> does not match the partial sums of the series\n";
+    return false;
+  }
+
+  if (((long double)eDL4 < 2.71828L) || ((long double)eDL4 > 2.71829L) ||
+      (longDouble(eD4) < 2.71828L) || (longDouble(eD4) > 2.71829L)) {
+    log << "e to 12 terms is not accurate to five digits\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Binary splitting
+ * @log Where to write log messages to.
+ *
+ * Sums up the power series for 'e' with the binary splitting policy, both
+ * for e itself and for a different factor, power factor and centre, and
+ * compares the results with those of the default, term-by-term summation,
+ * also for long doubles with enough terms to overflow long long products
+ * and a power factor that is not an integer.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testEBinarySplitting(std::ostream &log) {
+  typedef series::binarySplitting split;
+
+  for (unsigned long long n : {0, 1, 2, 7, 50, 200}) {
+    const Q a = e<Q>::get(n);
+    const Q b = e<Q, unsigned long long, split>::get(n);
+    const Q c = e<Q>::get(n, Q(3), Q(Z(2), Z(3)), Q(Z(1), Z(5)));
+    const Q d = e<Q, unsigned long long, split>::get(n, Q(3), Q(Z(2), Z(3)),
+                                                     Q(Z(1), Z(5)));
+
+    if ((a != b) || (c != d)) {
+      log << "e<Q," << n << "> should have been " << a << " and " << c
+          << " but was " << b << " and " << d << "\n";
+      return false;
+    }
+  }
+
+  const long double d = e<long double, unsigned long long, split>(1, 1, 0, 12);
+
+  if ((d < 2.71828L) || (d > 2.71829L)) {
+    log << "binary splitting with long doubles failed: " << d << "\n";
+    return false;
+  }
+
+  for (const long double x : {1.L, 0.5L, -0.75L, 1.5L}) {
+    const long double s = e<long double>::get(30, 1, x, 0);
+    const long double t =
+        e<long double, unsigned long long, split>::get(30, 1, x, 0);
+
+    if (std::fabs(s - t) > 1e-15L * s) {
+      log << "e^" << x << " with long doubles was " << t
+          << " instead of " << s << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Precision
+ * @log Where to write log messages to.
+ *
+ * Calculates e^x to different precisions, checks the results against
+ * sums with a lot more terms, and checks that the number of terms that was
+ * used for e itself isn't more than needed.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testEPrecision(std::ostream &log) {
+  typedef unsigned long long N;
+  typedef e<Q, N, series::binarySplitting> exp;
+
+  for (N bits : {0, 10, 64, 300, 2000}) {
+    const Q epsilon(Z(1), Z(1) << (unsigned int)bits);
+
+    for (const Q &x : {Q(1), Q(Z(1), Z(3)), Q(Z(-5), Z(2)), Q(7)}) {
+      const N n = exp::termsFor(bits, Q(1), x);
+      const Q a = exp::toPrecision(bits, Q(1), x);
+      const Q b = exp::get(n + 50, Q(1), x);
+      const Q d = a - b;
+
+      if ((d > epsilon) || (Q(0) - d > epsilon)) {
+        log << "e^" << x << " with " << n << " terms is not accurate to "
+            << bits << " bits\n";
+        return false;
+      }
+    }
+  }
+
+  const N n = exp::termsFor(2000);
+  const Q r = exp::get(n + 50);
+  const Q epsilon(Z(1), Z(1) << 2000u);
+  N m = 0;
+
+  for (Q d = r - exp::get(m); d > epsilon; d = r - exp::get(m)) {
+    m++;
+  }
+
+  if (n > m + 2) {
+    log << "e to 2000 bits should need " << m << " terms, but used " << n
+        << "\n";
+    return false;
+  }
+
+  const long double l = e<long double>::toPrecision(60);
+  const long double h = e<long double>::toPrecision(100000);
+
+  if ((l < 2.71828182845904523L) || (l > 2.71828182845904524L) ||
+      (h < 2.71828182845904523L) || (h > 2.71828182845904524L)) {
+    log << "e<long double> to 60 and 100000 bits was " << l << " and " << h
+        << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Parallel summation
+ * @log Where to write log messages to.
+ *
+ * Sums up e^x with the parallel policies and different numbers of threads,
+ * and compares the results with each other and with the serial policies.
+ * Also checks that an exception thrown by a task on one of the worker
+ * threads reaches the caller.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testEParallel(std::ostream &log) {
+  typedef unsigned long long N;
+  using series::binarySplitting;
+  using series::parallel;
+  using series::termwise;
+
+  for (N n : {0, 1, 5, 63, 64, 65, 300}) {
+    const Q x(Z(-2), Z(3));
+    const Q a = e<Q>::get(n, Q(3), x);
+    const Q b = e<Q, N, parallel<binarySplitting, 1>>::get(n, Q(3), x);
+    const Q c = e<Q, N, parallel<binarySplitting, 5>>::get(n, Q(3), x);
+    const Q d = e<Q, N, parallel<termwise, 1>>::get(n, Q(3), x);
+    const Q f = e<Q, N, parallel<termwise, 3>>::get(n, Q(3), x);
+
+    if ((a != b) || (a != c) || (a != d) || (a != f)) {
+      log << "parallel sums of " << n << " terms differ: " << a << ", " << b
+          << ", " << c << ", " << d << ", " << f << "\n";
+      return false;
+    }
+  }
+
+  const long double l = e<long double, N, parallel<termwise, 1>>::get(300);
+  const long double m = e<long double, N, parallel<termwise, 4>>::get(300);
+  const long double s = e<long double>::get(300);
+
+  if ((l != m) || (l - s > 1e-17L) || (s - l > 1e-17L)) {
+    log << "parallel long double sums were " << l << " and " << m
+        << " instead of " << s << "\n";
+    return false;
+  }
+
+  std::size_t thrown = 0;
+
+  try {
+    series::workers<4>::run(100, [](std::size_t t) {
+      if (t == 37) {
+        throw t;
+      }
+    });
+  } catch (std::size_t t) {
+    thrown = t;
+  }
+
+  if (thrown != 37) {
+    log << "exception from a worker thread was " << thrown << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Stateful sequence
+ * @log Where to write log messages to.
+ *
+ * Checks that the sequence behind the 'e' series is stateful, and that
+ * calculating its members from the previous ones produces the same values
+ * as calculating them directly.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testENext(std::ostream &log) {
+  typedef sequence<Q, algorithm::powerSeriesE> s;
+
+  if (!s::stateful) {
+    log << "sequence should have been stateful\n";
+    return false;
+  }
+
+  Q t = s::at(0);
+
+  for (unsigned long long n = 1; n < 30; n++) {
+    t = s::advance(t, n);
+
+    if (t != s::at(n)) {
+      log << "member " << n << " should have been " << s::at(n)
+          << " but was " << t << "\n";
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -72,4 +289,8 @@ namespace test {
 using efgy::test::function;
 
 static function e(testE);
+static function eBinarySplitting(testEBinarySplitting);
+static function eNext(testENext);
+static function ePrecision(testEPrecision);
+static function eParallel(testEParallel);
 }  // namespace test
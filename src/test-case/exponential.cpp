@@ -13,6 +13,7 @@
  * under the terms of an MIT/X11-style licence, described in the COPYING file.
  */
 
+#include <ef.gy/big-integers.h>
 #include <ef.gy/exponential.h>
 #include <ef.gy/fractions.h>
 #include <ef.gy/test-case.h>
@@ -21,6 +22,11 @@
 
 using namespace efgy::math;
 
+/* Built-in types should be raisable to long runtime exponents in constant
+ * expressions. */
+static_assert(exponentiate::integral<double, 0>::raise(1.0, 1LL << 60) == 1.0,
+              "exponentiate::integral should be usable in constant expressions");
+
 /* Integer exponents
  * @log Where to write log messages to.
  *
@@ -200,9 +206,156 @@ bool testFunctionalIntegralExponents(std::ostream &log) {
   return true;
 }
 
+/* Modular exponents
+ * @log Where to write log messages to.
+ *
+ * Compares exponentiate::modular with repeated multiplication for a range
+ * of bases, exponents and moduli.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testModularExponents(std::ostream &log) {
+  for (unsigned long long m : {1ull, 2ull, 7ull, 16ull, 1000003ull,
+                               4294967291ull}) {
+    for (unsigned long long b : {0ull, 1ull, 3ull, 16ull, 123456789ull}) {
+      unsigned long long r = 1 % m;
+
+      for (unsigned long long e = 0; e < 70; e++) {
+        const unsigned long long v = exponentiate::modular(b, e, m);
+
+        if (v != r) {
+          log << b << "^" << e << " mod " << m << " should be " << r
+              << " but is " << v << "\n";
+          return false;
+        }
+
+        r = r * (b % m) % m;
+      }
+    }
+  }
+
+  return true;
+}
+
+/* Windowed exponents
+ * @log Where to write log messages to.
+ *
+ * Raises a fraction to runtime exponents, as well as with the generic ^
+ * operator, and compares the results with repeated multiplication. Then
+ * raises -2 and -1/2 to an exponent with more than 23 bits, which is long
+ * enough for the sliding windows to kick in, and compares the results with
+ * a shift.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testWindowedExponents(std::ostream &log) {
+  const Q base(Z(-3), Z(2));
+  Q r = Q(1);
+
+  for (unsigned int e = 0; e < 300; e++) {
+    const Q v = exponentiate::integral<Q>::raise(base, Z(e));
+    const Q w = exponentiate::integral<Q>::raise(base, Z(0) - Z(e));
+
+    if ((v != r) || (w != Q(1) / r)) {
+      log << "(-3/2)^(+-" << e << ") should be " << r << " and its reciprocal"
+          << " but is " << v << " and " << w << "\n";
+      return false;
+    }
+
+    if ((Z(3) ^ e) != (e % 2 ? Z(0) - r.numerator : r.numerator)) {
+      log << "3^" << e << " is " << (Z(3) ^ e) << "\n";
+      return false;
+    }
+
+    r *= base;
+  }
+
+  Q s = Q(1);
+  for (unsigned int e = 0; e < 5000; e++) {
+    s *= Q(Z(7), Z(5));
+  }
+
+  if (exponentiate::integral<Q>::raise(Q(Z(7), Z(5)), Z(5000)) != s) {
+    log << "(7/5)^5000 is wrong\n";
+    return false;
+  }
+
+  const unsigned int e = (1 << 23) + 12345;
+  const Z p = exponentiate::integral<Z>::raise(Z(-2), Z(e));
+  const Q q = exponentiate::integral<Q>::raise(Q(Z(1), Z(-2)), Z(e));
+  const Z t = Z(0) - (Z(1) << e);
+
+  if ((p != t) || (q != Q(Z(1), t))) {
+    log << "(-2)^" << e << " or (-1/2)^" << e << " is wrong\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Modular power of big integers
+ * @log Where to write log messages to.
+ *
+ * Compares Z::powmod with repeated multiplication for small exponents,
+ * checks Fermat's little theorem for a Mersenne prime, and compares the
+ * Montgomery arithmetic used for odd moduli with the plain reduction used
+ * for even ones.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testModularPower(std::ostream &log) {
+  const Z p = (Z(1) << 127) - Z(1);
+  const Z big = Z(123456789) * (Z(1) << 200) + Z(987654321);
+
+  for (const Z &m : {Z(1), Z(2), Z(7), Z(1) << 64, Z(1000003), p, big,
+                     big + Z(1)}) {
+    for (const Z &b : {Z(0), Z(1), Z(-5), Z(1) << 70, big * Z(3)}) {
+      Z r = Z(1) % m;
+
+      for (unsigned int e = 0; e < 40; e++) {
+        const Z v = Z::powmod(b, Z(e), m);
+
+        if (v != r) {
+          log << b << "^" << e << " mod " << m << " should be " << r
+              << " but is " << v << "\n";
+          return false;
+        }
+
+        r = r * b % m;
+        if (r < Z(0)) {
+          r += m;
+        }
+      }
+    }
+  }
+
+  for (const Z &a : {Z(2), Z(3), big}) {
+    if (Z::powmod(a, p - Z(1), p) != Z(1)) {
+      log << a << "^(p-1) mod p should be 1 for p = " << p << " but is "
+          << Z::powmod(a, p - Z(1), p) << "\n";
+      return false;
+    }
+
+    const Z e = big * big + a;
+    const Z v = Z::powmod(a, e, big);
+    const Z w = Z::powmod(a, e, Z(2) * big) % big;
+
+    if (v != w) {
+      log << "Montgomery reduction resulted in " << v << " instead of " << w
+          << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
 namespace test {
 using efgy::test::function;
 
 static function integralExponents(testIntegralExponents);
 static function functionalIntegralExponents(testFunctionalIntegralExponents);
+static function modularExponents(testModularExponents);
+static function windowedExponents(testWindowedExponents);
+static function modularPower(testModularPower);
 }  // namespace test
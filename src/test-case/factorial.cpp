@@ -13,6 +13,7 @@
  * under the terms of an MIT/X11-style licence, described in the COPYING file.
  */
 
+#include <ef.gy/big-integers.h>
 #include <ef.gy/factorial.h>
 #include <ef.gy/test-case.h>
 
@@ -49,8 +50,51 @@ bool testFactorial(ostream &log) {
   return true;
 }
 
+/* Big factorials
+ * @log Where to write log messages to.
+ *
+ * Calculates factorials of big integers, which use a product tree, and
+ * compares them to the factorials calculated one factor at a time, as well
+ * as to what the memoised table has for them.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBigFactorial(ostream &log) {
+  Z expected = Z(1);
+
+  for (unsigned int n = 0; n <= 300; n++) {
+    if (n > 1) {
+      expected *= Z(n);
+    }
+
+    const Z f = factorial<Z>(Z(n));
+
+    if (f != expected) {
+      log << "factorial of " << n << " should be " << expected << " but is "
+          << f << "\n";
+      return false;
+    }
+
+    if (factorial<Z>::cached(n) != expected) {
+      log << "cached factorial of " << n << " should be " << expected
+          << " but is " << factorial<Z>::cached(n) << "\n";
+      return false;
+    }
+  }
+
+  if ((factorial<long long>::cached(20) != 2432902008176640000LL) ||
+      (factorial<int>::cached(12) != 479001600) ||
+      (factorial<long long>::cached(13) != 6227020800LL)) {
+    log << "cached factorials of built-in integers are wrong\n";
+    return false;
+  }
+
+  return true;
+}
+
 namespace test {
 using efgy::test::function;
 
 static function factorial(testFactorial);
+static function bigFactorial(testBigFactorial);
 }  // namespace test
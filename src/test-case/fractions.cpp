@@ -0,0 +1,174 @@
+/* Test cases for the fractional template
+ *
+ * Test whether fractions with the different reduction policies produce the
+ * same values, and whether they are reduced when they should be.
+ *
+ * See also:
+ * * Project Documentation: https://ef.gy/documentation/libefgy
+ * * Project Source Code: https://github.com/ef-gy/libefgy
+ * * Licence Terms: https://github.com/ef-gy/libefgy/blob/master/COPYING
+ *
+ * @copyright
+ * This file is part of the libefgy project, which is released as open source
+ * under the terms of an MIT/X11-style licence, described in the COPYING file.
+ */
+
+#include <ef.gy/fractions.h>
+#include <ef.gy/test-case.h>
+
+#include <iostream>
+#include <sstream>
+
+using namespace efgy::math;
+
+/* Harmonic sum
+ * @n How many terms to add up.
+ *
+ * Adds up 1/1 - 1/2 + 1/3 - ... - 1/n, scaled by 6/5 on every step so that
+ * there is something to cancel.
+ *
+ * @return The sum.
+ */
+template <typename F>
+static F harmonic(unsigned int n) {
+  F r = F(Z(0));
+
+  for (unsigned int i = 1; i <= n; i++) {
+    r += F(Z(i % 2 ? 1 : -1), Z(i));
+    r *= F(Z(6), Z(5));
+    r /= F(Z(6), Z(5));
+  }
+
+  return r;
+}
+
+/* Reduction policies
+ * @log Where to write log messages to.
+ *
+ * Calculates the same sum with eager, lazy and manual reduction, and checks
+ * that the results compare equal, that only the eagerly reduced one is in
+ * lowest terms, and that reduce() and writing the lazy one to a stream
+ * produce the same lowest terms.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testReductionPolicies(std::ostream &log) {
+  typedef numeric::fractional<Z, numeric::lazyReduction<64>> lazy;
+  typedef numeric::fractional<Z, numeric::manualReduction> manual;
+
+  const Q e = harmonic<Q>(40);
+  lazy l = harmonic<lazy>(40);
+  manual m = harmonic<manual>(40);
+
+  if ((Q(l) != e) || (Q(m) != e) || (l != lazy(e)) || (m != manual(e))) {
+    log << "the policies disagree: " << e << " vs. " << l << " vs. "
+        << m.numerator << "/" << m.denominator << "\n";
+    return false;
+  }
+
+  if ((l.denominator.bitLength() > 128) ||
+      (m.denominator.bitLength() <= e.denominator.bitLength())) {
+    log << "fractions were not reduced as expected\n";
+    return false;
+  }
+
+  std::ostringstream s, t;
+  s << l;
+  t << e;
+
+  if (s.str() != t.str()) {
+    log << "lazy fraction was written as " << s.str() << " instead of "
+        << t.str() << "\n";
+    return false;
+  }
+
+  m.reduce();
+
+  if ((m.numerator != e.numerator) || (m.denominator != e.denominator)) {
+    log << "reduce() resulted in " << m.numerator << "/" << m.denominator
+        << " instead of " << e << "\n";
+    return false;
+  }
+
+  manual a(Z(4), Z(-6));
+  manual b(Z(-2), Z(3));
+
+  if ((a != b) || !(b > manual(Z(-1))) || (a.denominator != Z(6))) {
+    log << "comparing unreduced fractions failed\n";
+    return false;
+  }
+
+  numeric::fractional<long long, numeric::lazyReduction<30>> c(1, 3);
+
+  for (int i = 0; i < 20; i++) {
+    c *= numeric::fractional<long long, numeric::lazyReduction<30>>(3, 2);
+    c *= numeric::fractional<long long, numeric::lazyReduction<30>>(2, 3);
+  }
+
+  if ((c.numerator > 1LL << 30) || (c != decltype(c)(1, 3))) {
+    log << "lazy reduction of built-in integers failed: " << c << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Fraction accumulator
+ * @log Where to write log messages to.
+ *
+ * Sums the reciprocals of the first few hundred integers, with alternating
+ * signs and some repeated denominators, one after the other and with the
+ * accumulator, both with and without a reduction cadence, and compares the
+ * results. Fractions of long longs that are never reduced on their own
+ * only stay in range thanks to the cadence, so those are only summed up to
+ * 64 terms.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testFractionAccumulator(std::ostream &log) {
+  for (unsigned int n : {0, 1, 2, 3, 7, 64, 300}) {
+    Q s = Q(Z(0));
+    numeric::accumulator<Q> a;
+    numeric::accumulator<Q> b(16);
+    numeric::accumulator<numeric::fractional<Z, numeric::manualReduction>> c;
+    numeric::accumulator<
+        numeric::fractional<long long, numeric::manualReduction>>
+        d(1);
+
+    for (unsigned int i = 1; i <= n; i++) {
+      const Q t(Z(i % 3 ? 1 : -1), Z(i / 2 + 1));
+
+      s += t;
+      a += t;
+      b += t;
+      c += numeric::fractional<Z, numeric::manualReduction>(t);
+      if (n <= 64) {
+        d += numeric::fractional<long long, numeric::manualReduction>(
+            i % 3 ? 1 : -1, i / 2 + 1);
+      }
+    }
+
+    const Q sa = a;
+    const Q sb = b;
+    const Q sc = Q(numeric::fractional<Z, numeric::manualReduction>(c));
+
+    const numeric::fractional<long long, numeric::manualReduction> sd = d;
+
+    if ((sa != s) || (sb != s) || (sc != s) ||
+        ((n <= 64) && (Q(Z(sd.numerator), Z(sd.denominator)) != s))) {
+      log << "sum of " << n << " terms should have been " << s
+          << " but was " << sa << ", " << sb << ", " << sc << " and " << sd
+          << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+namespace test {
+using efgy::test::function;
+
+static function reductionPolicies(testReductionPolicies);
+static function fractionAccumulator(testFractionAccumulator);
+}  // namespace test
@@ -16,9 +16,12 @@
 #include <ef.gy/fractions.h>
 #include <ef.gy/pi.h>
 #include <ef.gy/primitive.h>
+#include <ef.gy/series-parallel.h>
 #include <ef.gy/test-case.h>
 
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 using namespace efgy::math;
 using std::string;
@@ -30,7 +33,8 @@ typedef primitive<long double, unsigned long long> longDouble;
  *
  * Initialises several instances of the 'pi' template with different base
  * types and precisions. The instances are then cast to different types
- * and written to the log to verify that the template compiles cleanly.
+ * and written to the log, and the fractions are compared with the exact
+ * partial sums of the series.
  *
  * @return 'true' on success, 'false' otherwise.
  */
@@ -125,6 +129,272 @@ bool testPi(std::ostream &log) {
     return false;
   }
 
+  // four iterations need more than 64 bits for the sum
+  if ((fraction(piQ1) != fraction(102913, 32760)) ||
+      (fraction(piQ2) != fraction(615863723, 196035840)) ||
+      (fraction(piQ3) != fraction(357201535487, 113700787200))) {
+    log << "pi<fraction> does not match the partial sums of the series\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Binary splitting
+ * @log Where to write log messages to.
+ *
+ * Sums up the 'pi' series with the binary splitting policy and compares
+ * the results with those of the default, term-by-term summation, also for
+ * built-in types with enough terms to overflow long long products.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testPiBinarySplitting(std::ostream &log) {
+  typedef series::binarySplitting split;
+
+  for (unsigned long long n : {0, 1, 2, 5, 40, 300}) {
+    const Q a = pi<Q>::get(n);
+    const Q b = pi<Q, unsigned long long, split>::get(n);
+
+    if (a != b) {
+      log << "pi<Q," << n << "> should have been " << a << " but was " << b
+          << "\n";
+      return false;
+    }
+  }
+
+  const Q q = pi<Q>::get(3);
+  const fraction f = pi<fraction, unsigned long long, split>::get(3);
+
+  if ((Z(f.numerator) != q.numerator) || (Z(f.denominator) != q.denominator)) {
+    log << "binary splitting with built-in integers should have resulted in "
+        << q << " but the result was " << f << "\n";
+    return false;
+  }
+
+  const long double d = pi<long double, unsigned long long, split>(2, 2);
+
+  if ((d < 6.2831L) || (d > 6.2832L)) {
+    log << "binary splitting with long doubles failed: " << d << "\n";
+    return false;
+  }
+
+  for (unsigned long long n : {6, 20, 40}) {
+    const long double s = pi<long double>::get(n);
+    const long double t = pi<long double, unsigned long long, split>::get(n);
+
+    if (s != t) {
+      log << "pi<long double," << n << "> should have been " << s
+          << " but was " << t << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Compare to a precision
+ * @a    The first approximation.
+ * @b    The second approximation.
+ * @bits The number of bits after the binary point that should agree.
+ *
+ * @return 'true' if a and b differ by less than 2^-bits.
+ */
+static bool agree(const Q &a, const Q &b, unsigned long long bits) {
+  const Q d = a - b;
+  const Q e(Z(1), Z(1) << (unsigned int)bits);
+
+  return !(d > e) && !(Q(0) - d > e);
+}
+
+/* Pi algorithms
+ * @log Where to write log messages to.
+ *
+ * Calculates pi with Bailey et al's, Machin's and the Chudnovsky brothers'
+ * series, each with as many terms as they say they need for a precision,
+ * and checks that they agree with each other and with pi::toPrecision.
+ * Also checks the precision of pi::toPrecision for long doubles and for
+ * fractions of long longs, which are only good for 31 bits.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testPiAlgorithms(std::ostream &log) {
+  typedef series::binarySplitting split;
+  typedef unsigned long long N;
+  typedef series::series<Q, algorithm::bailey1997, N, split> bailey;
+  typedef series::series<Q, algorithm::machin, N> machin;
+  typedef series::series<Q, algorithm::chudnovsky, N, split> chudnovsky;
+
+  for (N bits : {8, 32, 64, 100, 500, 2000}) {
+    const Q a = bailey::toPrecision(bits);
+    const Q b = machin::toPrecision(bits);
+    const Q c = chudnovsky::toPrecision(bits);
+    const Q d = pi<Q>::toPrecision(bits);
+
+    if (!agree(a, b, bits - 1) || !agree(b, c, bits - 1) ||
+        !agree(c, d, bits - 1)) {
+      log << "pi to " << bits << " bits differs between algorithms: "
+          << a.toDouble() << ", " << b.toDouble() << ", " << c.toDouble()
+          << ", " << d.toDouble() << "\n";
+      return false;
+    }
+  }
+
+  if (chudnovsky::get(4) !=
+      pi<Q, N, series::termwise, algorithm::chudnovsky>::get(4)) {
+    log << "binary splitting and termwise Chudnovsky series differ\n";
+    return false;
+  }
+
+  const long double l = pi<long double>::toPrecision(64);
+  const long double m = pi<long double>::toPrecision(128);
+
+  if ((l < 3.14159265358979323L) || (l > 3.14159265358979324L) ||
+      (m < 3.14159265358979323L) || (m > 3.14159265358979324L)) {
+    log << "pi<long double> to 64 and 128 bits was " << l << " and " << m
+        << "\n";
+    return false;
+  }
+
+  for (N bits : {0, 8, 16, 24, 32, 64, 200}) {
+    const fraction f = pi<fraction>::toPrecision(bits);
+    const long double e =
+        std::fabs((long double)f.numerator / f.denominator - l);
+
+    if ((f.denominator > (1LL << 31)) ||
+        (e > std::ldexp(1.L, -int(bits < 31 ? bits : 31)))) {
+      log << "pi<fraction> to " << bits << " bits was " << f << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Parallel summation
+ * @log Where to write log messages to.
+ *
+ * Sums up the Chudnovsky and Machin series for pi with the parallel
+ * policies and different numbers of threads, and checks that the results
+ * are the same as with the serial policies.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testPiParallel(std::ostream &log) {
+  typedef unsigned long long N;
+  using series::binarySplitting;
+  using series::parallel;
+  using series::termwise;
+
+  for (N n : {0, 2, 70, 200}) {
+    const Q a = pi<Q, N, binarySplitting, algorithm::chudnovsky>::get(n);
+    const Q b =
+        pi<Q, N, parallel<binarySplitting, 1>, algorithm::chudnovsky>::get(n);
+    const Q c =
+        pi<Q, N, parallel<binarySplitting, 6>, algorithm::chudnovsky>::get(n);
+    const Q d = pi<Q, N, termwise, algorithm::machin>::get(n);
+    const Q f = pi<Q, N, parallel<termwise, 4>, algorithm::machin>::get(n);
+
+    if ((a != b) || (a != c) || (d != f)) {
+      log << "parallel sums of " << n << " terms differ\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Hexadecimal digits
+ * @log Where to write log messages to.
+ *
+ * Extracts hexadecimal digits of pi with the BBP formula, one at a time and
+ * in batches with different numbers of threads, and compares them to the
+ * digits of a rational approximation.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testPiHexDigits(std::ostream &log) {
+  const unsigned long long n = 500;
+  const Q p = pi<Q>::toPrecision(4 * n + 64);
+  Z r = p.numerator % p.denominator;
+  std::vector<unsigned int> digits;
+
+  for (unsigned long long i = 0; i < n; i++) {
+    r = r * Z(16);
+    digits.push_back((unsigned int)(r / p.denominator).toDouble());
+    r = r % p.denominator;
+  }
+
+  for (unsigned long long i : {0, 1, 2, 3, 50, 499}) {
+    if (piHexDigit(i) != digits[i]) {
+      log << "hex digit " << i << " should be " << digits[i] << " but is "
+          << piHexDigit(i) << "\n";
+      return false;
+    }
+  }
+
+  for (unsigned int threads : {1, 3, 8}) {
+    const std::vector<unsigned int> a =
+        piHexDigits<unsigned long long>(0, n, threads);
+    const std::vector<unsigned int> b =
+        piHexDigits<unsigned long long>(101, 13, threads);
+
+    if ((a != digits) ||
+        (b != std::vector<unsigned int>(digits.begin() + 101,
+                                        digits.begin() + 114))) {
+      log << "batch of hex digits with " << threads << " threads was wrong\n";
+      return false;
+    }
+  }
+
+  /* Positions given as plain int literals must not be calculated in int,
+   * which overflows in the BBP sums at positions this far out. */
+  if ((piHexDigit(20000) != 14) || (piHexDigit(100000) != 3)) {
+    log << "hex digits at int positions should be 14 and 3 but are "
+        << piHexDigit(20000) << " and " << piHexDigit(100000) << "\n";
+    return false;
+  }
+
+  const std::vector<unsigned int> far = piHexDigits(100000, 12, 2);
+  for (unsigned int i = 0; i < 12; i++) {
+    if (far[i] != piHexDigit(100000ULL + i)) {
+      log << "batch of hex digits at int positions was wrong\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Stateful sequence
+ * @log Where to write log messages to.
+ *
+ * Checks that the sequence behind the 'pi' series is stateful, and that
+ * calculating its members from the previous ones produces the same values
+ * as calculating them directly.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testPiNext(std::ostream &log) {
+  typedef sequence<Q, algorithm::bailey1997> s;
+
+  if (!s::stateful) {
+    log << "sequence should have been stateful\n";
+    return false;
+  }
+
+  Q t = s::at(0);
+
+  for (unsigned long long n = 1; n < 30; n++) {
+    t = s::advance(t, n);
+
+    if (t != s::at(n)) {
+      log << "member " << n << " should have been " << s::at(n)
+          << " but was " << t << "\n";
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -132,4 +402,9 @@ namespace test {
 using efgy::test::function;
 
 static function pi(testPi);
+static function piBinarySplitting(testPiBinarySplitting);
+static function piNext(testPiNext);
+static function piAlgorithms(testPiAlgorithms);
+static function piHexDigits(testPiHexDigits);
+static function piParallel(testPiParallel);
 }  // namespace test
@@ -0,0 +1,232 @@
+/* Test cases for polynomials
+ *
+ * Evaluates and multiplies polynomials with fixed and variable numbers of
+ * coefficients, and compares the fast multiplication algorithms with the
+ * schoolbook algorithm.
+ *
+ * See also:
+ * * Project Documentation: https://ef.gy/documentation/libefgy
+ * * Project Source Code: https://github.com/ef-gy/libefgy
+ * * Licence Terms: https://github.com/ef-gy/libefgy/blob/master/COPYING
+ *
+ * @copyright
+ * This file is part of the libefgy project, which is released as open source
+ * under the terms of an MIT/X11-style licence, described in the COPYING file.
+ */
+
+#include <ef.gy/fractions.h>
+#include <ef.gy/polynomial.h>
+#include <ef.gy/test-case.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using namespace efgy::math;
+
+/* Polynomial evaluation
+ * @log Where to write log messages to.
+ *
+ * Evaluates a cubic with fraction coefficients at a few points, one at a
+ * time and all at once, and compares the results with the sums of the
+ * powers. Also checks that products of fixed polynomials put each product
+ * of coefficients where it belongs.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testPolynomialEvaluation(std::ostream &log) {
+  polynomial<Q, 4> p;
+  p.coefficients[0] = Q(Z(3), Z(2));
+  p.coefficients[1] = Q(Z(-2));
+  p.coefficients[2] = Q(Z(0));
+  p.coefficients[3] = Q(Z(5), Z(7));
+
+  std::vector<Q> xs, out(9);
+
+  for (int i = -4; i <= 4; i++) {
+    xs.push_back(Q(Z(i), Z(3)));
+  }
+
+  p.evaluate(xs.data(), out.data(), xs.size());
+
+  for (std::size_t i = 0; i < xs.size(); i++) {
+    const Q &x = xs[i];
+    const Q v = p.coefficients[0] + p.coefficients[1] * x +
+                p.coefficients[3] * x * x * x;
+
+    if ((p(x) != v) || (out[i] != v)) {
+      log << "p(" << x << ") is " << p(x) << " and " << out[i]
+          << " instead of " << v << "\n";
+      return false;
+    }
+  }
+
+  polynomial<double, 2> a, b;
+  a.coefficients[0] = 1;
+  a.coefficients[1] = 1;
+  b.coefficients[0] = 1;
+  b.coefficients[1] = -1;
+
+  const polynomial<double, 3> c = a * b;
+
+  if ((c.coefficients[0] != 1) || (c.coefficients[1] != 0) ||
+      (c.coefficients[2] != -1) || (c(3) != -8) || ((a + 2.)(1) != 4)) {
+    log << "(1 + x)(1 - x) has the coefficients " << c.coefficients[0] << ", "
+        << c.coefficients[1] << " and " << c.coefficients[2] << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Polynomial multiplication
+ * @log Where to write log messages to.
+ *
+ * Multiplies polynomials with many coefficients, which selects Karatsuba's
+ * algorithm for built-in integers and Kronecker substitution for big
+ * integers, and compares the results with the schoolbook algorithm.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testPolynomialMultiplication(std::ostream &log) {
+  for (std::size_t n : {1, 5, 33, 50, 131}) {
+    std::vector<long long> a(n), b(n + 37), r(2 * n + 36);
+    std::vector<Z> za(n), zb(n + 37), zr(2 * n + 36);
+
+    for (std::size_t i = 0; i < a.size(); i++) {
+      a[i] = (long long)((i * 7919) % 201) - 100;
+      za[i] = Z(a[i]) * (Z(1) << 70) + Z(a[i]);
+    }
+    for (std::size_t i = 0; i < b.size(); i++) {
+      b[i] = (long long)((i * 104729) % 199) - 99;
+      zb[i] = Z(b[i]);
+    }
+
+    polynomialArithmetic<long long>::schoolbook(r.data(), a.data(), a.size(),
+                                                b.data(), b.size());
+    polynomialArithmetic<Z>::schoolbook(zr.data(), za.data(), za.size(),
+                                        zb.data(), zb.size());
+
+    const polynomial<long long, 0> p =
+        polynomial<long long, 0>(a) * polynomial<long long, 0>(b);
+    const polynomial<Z, 0> q = polynomial<Z, 0>(zb) * polynomial<Z, 0>(za);
+
+    if ((p.coefficients != r) || (q.coefficients != zr)) {
+      log << "products with " << n << " coefficients differ\n";
+      return false;
+    }
+  }
+
+  polynomial<Z, 3> x;
+  x.coefficients[0] = Z(1);
+  x.coefficients[2] = Z(1);
+  const polynomial<Z, 0> y = x;
+
+  if ((y.degree() != 2) || ((y * y)(Z(2)) != Z(25)) ||
+      (polynomial<Z, 0>().degree() != 0)) {
+    log << "(1 + x^2)^2 at 2 is " << (y * y)(Z(2)) << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Check batched evaluation
+ * @log Where to write log messages to.
+ * @p   The polynomial to evaluate.
+ *
+ * Evaluates p and its derivative at an odd number of points, so that the
+ * last vector is only partially used, and compares the results with
+ * Horner's scheme in long double. The tolerance scales with the sum of
+ * the magnitudes of the terms, which bounds the rounding errors of both
+ * Estrin's and Horner's scheme.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+template <typename T>
+static bool checkBatch(std::ostream &log, const polynomial<T, 0> &p) {
+  const std::size_t n = 1001, m = p.coefficients.size();
+  const long double epsilon = std::numeric_limits<T>::epsilon();
+  std::vector<T> x(n), v(n), d(n), w(n);
+
+  for (std::size_t i = 0; i < n; i++) {
+    x[i] = T(-1.5) + T(3) * T(i) / T(n - 1);
+  }
+
+  p.evaluate(x.data(), v.data(), d.data(), n);
+  p.evaluate(x.data(), w.data(), n);
+
+  for (std::size_t i = 0; i < n; i++) {
+    const long double y = x[i], a = std::fabs(y);
+    long double r = 0, s = 0, dr = 0, ds = 0;
+
+    for (std::size_t k = m; k-- > 0;) {
+      dr = dr * y + r;
+      ds = ds * a + s;
+      r = r * y + p.coefficients[k];
+      s = s * a + std::fabs(p.coefficients[k]);
+    }
+
+    if ((std::fabs(v[i] - r) > 2 * m * epsilon * s) || (w[i] != v[i]) ||
+        (std::fabs(d[i] - dr) > 2 * m * epsilon * ds)) {
+      log << "p(" << x[i] << ") and p'(" << x[i] << ") are " << v[i]
+          << " and " << d[i] << " instead of " << r << " and " << dr << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Batched evaluation
+ * @log Where to write log messages to.
+ *
+ * Checks the vectorised evaluation for float and double polynomials of
+ * different degrees, including constant and empty ones, and that fixed
+ * polynomials produce the same values as the equivalent variable ones.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBatchedEvaluation(std::ostream &log) {
+  polynomial<double, 10> p;
+
+  for (unsigned int i = 0; i < 10; i++) {
+    p.coefficients[i] = (i % 2 ? -1. : 1.) / (i + 1);
+  }
+
+  std::vector<double> x = {-1, -0.5, 0, 0.25, 1, 1.25, 2}, v(7), w(7);
+  p.evaluate(x.data(), v.data(), 7);
+  polynomial<double, 0>(p).evaluate(x.data(), w.data(), 7);
+
+  if (v != w) {
+    log << "fixed and variable polynomials disagree\n";
+    return false;
+  }
+
+  for (std::size_t m : {0, 1, 2, 3, 7, 16, 23}) {
+    std::vector<float> f(m);
+    std::vector<double> d(m);
+
+    for (std::size_t i = 0; i < m; i++) {
+      d[i] = std::sin(double(i * i + 1));
+      f[i] = float(d[i]);
+    }
+
+    if (!checkBatch(log, polynomial<float, 0>(f)) ||
+        !checkBatch(log, polynomial<double, 0>(d))) {
+      log << "with " << m << " coefficients\n";
+      return false;
+    }
+  }
+
+  return checkBatch(log, polynomial<double, 0>(p));
+}
+
+namespace test {
+using efgy::test::function;
+
+static function polynomialEvaluation(testPolynomialEvaluation);
+static function polynomialMultiplication(testPolynomialMultiplication);
+static function batchedEvaluation(testBatchedEvaluation);
+}  // namespace test
@@ -0,0 +1,250 @@
+/* Test cases for the batched elementary functions
+ *
+ * Compares the results of the functions in math::simd with the long double
+ * functions of the C library, and checks that they stay within the error
+ * bounds given in the header.
+ *
+ * See also:
+ * * Project Documentation: https://ef.gy/documentation/libefgy
+ * * Project Source Code: https://github.com/ef-gy/libefgy
+ * * Licence Terms: https://github.com/ef-gy/libefgy/blob/master/COPYING
+ *
+ * @copyright
+ * This file is part of the libefgy project, which is released as open source
+ * under the terms of an MIT/X11-style licence, described in the COPYING file.
+ */
+
+#include <ef.gy/flame.h>
+#include <ef.gy/parametric.h>
+#include <ef.gy/simd.h>
+#include <ef.gy/test-case.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using namespace efgy::math;
+using efgy::geometry::parameters;
+
+/* Error in ulp
+ * @v     The value to check.
+ * @ref   The exact value.
+ * @floor Results smaller than this are measured in ulp of the floor.
+ *
+ * @return The difference between v and ref, in units of the last place of
+ * the larger one of ref and floor.
+ */
+template <typename T>
+static long double ulps(const T &v, const long double &ref, const T &floor) {
+  const T m = std::fabs(ref) < floor ? floor : T(std::fabs(ref));
+  const T u = std::nextafter(m, std::numeric_limits<T>::infinity()) - m;
+
+  return std::fabs((long double)v - ref) / u;
+}
+
+/* Check a floating point type
+ * @log   Where to write log messages to.
+ * @floor The 2^-8 or 2^-16 from the error bounds.
+ *
+ * Calculates sines, cosines, arc tangents and square roots of a range of
+ * arguments, including some beyond the reduction limit and infinities, and
+ * an odd number of them so that the last vector is only partially used.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+template <typename T>
+static bool check(std::ostream &log, const T &floor) {
+  const std::size_t n = 20011;
+  std::vector<T> x(n), y(n), s(n), c(n), a(n), t(n), r(n), o(n);
+
+  for (std::size_t i = 0; i < n; i++) {
+    x[i] = T(-200) + T(400) * T(i) / T(n);
+    y[i] = T(3) * std::sin(T(i));
+  }
+
+  x[7] = T(1e9);
+  x[8] = -T(1e9);
+  x[n - 1] = std::numeric_limits<T>::infinity();
+
+  simd::sines(x.data(), s.data(), c.data(), n);
+  simd::sine(x.data(), o.data(), n);
+  simd::arctangent2(y.data(), x.data(), a.data(), n);
+  simd::arctangent(y.data(), t.data(), n);
+  simd::squareRoot(y.data(), r.data(), n);
+
+  for (std::size_t i = 0; i < n - 1; i++) {
+    const long double lx = x[i], ly = y[i];
+
+    if ((ulps(s[i], std::sin(lx), floor) > 2) ||
+        (ulps(c[i], std::cos(lx), floor) > 2) || (o[i] != s[i])) {
+      log << "sine and cosine of " << x[i] << " are " << s[i] << " and "
+          << c[i] << " instead of " << std::sin(lx) << " and " << std::cos(lx)
+          << "\n";
+      return false;
+    }
+
+    if ((ulps(a[i], std::atan2(ly, lx), T(0)) > 3) ||
+        (ulps(t[i], std::atan(ly), T(0)) > 3)) {
+      log << "arc tangents of " << y[i] << " and " << y[i] << "/" << x[i]
+          << " are " << t[i] << " and " << a[i] << " instead of "
+          << std::atan(ly) << " and " << std::atan2(ly, lx) << "\n";
+      return false;
+    }
+
+    if ((y[i] >= T(0)) && (r[i] != std::sqrt(y[i]))) {
+      log << "square root of " << y[i] << " is " << r[i] << "\n";
+      return false;
+    }
+  }
+
+  if (!std::isnan(s[n - 1]) || !std::isnan(c[n - 1])) {
+    log << "sine and cosine of infinity should be NaN\n";
+    return false;
+  }
+
+  const T infinities[2] = {std::numeric_limits<T>::infinity(),
+                           -std::numeric_limits<T>::infinity()};
+  simd::arctangent(infinities, t.data(), 2);
+
+  if ((ulps(t[0], std::atan((long double)infinities[0]), T(0)) > 3) ||
+      (ulps(t[1], std::atan((long double)infinities[1]), T(0)) > 3)) {
+    log << "arc tangents of infinities are " << t[0] << " and " << t[1]
+        << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+/* Batched functions
+ * @log Where to write log messages to.
+ *
+ * Checks the float and double kernels, and the fallback for long double,
+ * which should return exactly what the C library does.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBatchedFunctions(std::ostream &log) {
+  if (!check<float>(log, 1.f / 256) || !check<double>(log, 1. / 65536)) {
+    return false;
+  }
+
+  const long double x[3] = {-1.5L, 0.25L, 4.L};
+  long double s[3], c[3];
+
+  simd::sines(x, s, c, 3);
+
+  for (std::size_t i = 0; i < 3; i++) {
+    if ((s[i] != std::sin(x[i])) || (c[i] != std::cos(x[i]))) {
+      log << "long double sine and cosine of " << x[i] << " are " << s[i]
+          << " and " << c[i] << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Compare points
+ * @log  Where to write log messages to.
+ * @what What the points are, for the log.
+ * @a    The points calculated in a batch.
+ * @b    The points calculated one at a time.
+ *
+ * @return 'true' if the coordinates are within 1e-9 of each other, relative
+ * to their size, 'false' otherwise.
+ */
+template <unsigned int d>
+static bool agree(std::ostream &log, const char *what,
+                  const std::vector<vector<double, d>> &a,
+                  const std::vector<vector<double, d>> &b) {
+  for (std::size_t k = 0; k < a.size(); k++) {
+    for (std::size_t i = 0; i < d; i++) {
+      if (!(std::fabs(a[k][i] - b[k][i]) <= 1e-9 * (1 + std::fabs(b[k][i])))) {
+        log << what << " of point " << k << " are " << a[k] << " in a batch, "
+            << "but " << b[k] << " one at a time\n";
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/* Check a parametric formula
+ * @log  Where to write log messages to.
+ * @what The name of the formula, for the log.
+ * @ve   The positions to calculate the vertices at.
+ *
+ * @return 'true' if the batched getCoordinates() agrees with the one that
+ * calculates one vertex at a time, 'false' otherwise.
+ */
+template <template <typename, std::size_t> class formula>
+static bool checkFormula(std::ostream &log, const char *what,
+                         const std::vector<vector<double, 2>> &ve) {
+  typedef formula<double, 2> F;
+  std::vector<vector<double, F::renderDepth>> a(ve.size()), b(ve.size());
+  parameters<double> p;
+
+  p.radius = 1.5;
+
+  F::getCoordinates(p, ve.data(), a.data(), ve.size());
+
+  for (std::size_t k = 0; k < ve.size(); k++) {
+    b[k] = F::getCoordinates(p, ve[k]);
+  }
+
+  return agree(log, what, a, b);
+}
+
+/* Batched geometry
+ * @log Where to write log messages to.
+ *
+ * Calculates the vertices of the parametric formulae that have batched
+ * getCoordinates() functions, and transforms points with a fractal flame,
+ * both in a batch and one at a time, and compares the results. Some of the
+ * points are on the x axis, where the flame's angle is the arc tangent of
+ * an infinity.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testBatchedGeometry(std::ostream &log) {
+  using namespace efgy::geometry::formula;
+
+  const std::size_t n = 37;
+  std::vector<vector<double, 2>> ve(n), a(n), b(n);
+
+  for (std::size_t k = 0; k < n; k++) {
+    ve[k][0] = -3.5 + 0.2 * double(k);
+    ve[k][1] = k % 3 == 0 ? 0. : std::sin(double(k)) * 2.;
+  }
+
+  if (!checkFormula<moebiusStrip>(log, "moebius strip vertices", ve) ||
+      !checkFormula<kleinBagel>(log, "klein bagel vertices", ve) ||
+      !checkFormula<kleinBottle>(log, "klein bottle vertices", ve)) {
+    return false;
+  }
+
+  efgy::geometry::transformation::flame<double, 2> f;
+
+  // julia picks a random angle, and waves divides by the translation
+  for (std::size_t i = 0; i < f.coefficients; i++) {
+    f.coefficient[i] = (i == 13) || (i == 15) ? 0. : 1. / double(i + 2);
+  }
+
+  f.transform(ve.data(), a.data(), n);
+
+  for (std::size_t k = 0; k < n; k++) {
+    b[k] = f * ve[k];
+  }
+
+  return agree(log, "flame coordinates", a, b);
+}
+
+namespace test {
+using efgy::test::function;
+
+static function batchedFunctions(testBatchedFunctions);
+static function batchedGeometry(testBatchedGeometry);
+}  // namespace test
@@ -13,11 +13,13 @@
  * under the terms of an MIT/X11-style licence, described in the COPYING file.
  */
 
+#include <ef.gy/big-integers.h>
 #include <ef.gy/fractions.h>
 #include <ef.gy/range.h>
 #include <ef.gy/test-case.h>
 #include <ef.gy/trigonometric.h>
 
+#include <cmath>
 #include <iostream>
 
 using namespace efgy::math;
@@ -43,8 +45,77 @@ bool testSine(std::ostream &log) {
   return true;
 }
 
+/* Sines of fractions
+ * @log Where to write log messages to.
+ *
+ * Calculates sines and cosines of fractions, including large and negative
+ * angles that need to be reduced, up to 2^60, which needs that many more
+ * bits of pi. This is done both directly and with a table of dyadic
+ * angles, and compares them with the std::sin() and std::cos() values.
+ * Fractions of long longs are approximated with denominators of at most
+ * 2^31, so they are only checked to about nine digits.
+ *
+ * @return 'true' on success, 'false' otherwise.
+ */
+bool testFractionSines(std::ostream &log) {
+  const trigonometric::table<Q> t(4, 12);
+
+  for (const Q &x : {Q(0), Q(Z(1), Z(3)), Q(Z(-7), Z(4)), Q(Z(3)), Q(Z(22)),
+                     Q(Z(-100)), Q(Z(1000), Z(3)), Q(Z(1) << 60),
+                     Q(Z(0) - (Z(1) << 50) - Z(1))}) {
+    Q c, tc;
+    const Q s = sines(x, c, 12);
+    const Q ts = t.sines(x, tc);
+    const long double d = x.toDouble();
+
+    for (const long double e :
+         {s.toDouble() - std::sin(d), c.toDouble() - std::cos(d),
+          ts.toDouble() - std::sin(d), tc.toDouble() - std::cos(d)}) {
+      if (std::fabs(e) > 1e-12) {
+        log << "sine and cosine of " << d << " should be " << std::sin(d)
+            << " and " << std::cos(d) << " but are " << s.toDouble() << " and "
+            << c.toDouble() << ", or " << ts.toDouble() << " and "
+            << tc.toDouble() << " with the table\n";
+        return false;
+      }
+    }
+  }
+
+  const trigonometric::table<fraction> ft(4, 12);
+
+  for (const fraction &x : {fraction(0), fraction(1, 2), fraction(-7, 4),
+                            fraction(2), fraction(22), fraction(-1000, 3)}) {
+    fraction c, tc;
+    const fraction s = sines(x, c, 12);
+    const fraction ts = ft.sines(x, tc);
+    const long double d = (long double)x.numerator / x.denominator;
+
+    for (const fraction &f : {s, c, ts, tc}) {
+      if (f.denominator > (1LL << 31)) {
+        log << "sine or cosine of " << x << " is " << f
+            << ", which is too big to multiply\n";
+        return false;
+      }
+    }
+
+    if ((std::fabs((long double)s.numerator / s.denominator - std::sin(d)) >
+         1e-9) ||
+        (std::fabs((long double)c.numerator / c.denominator - std::cos(d)) >
+         1e-9) ||
+        (ts != s) || (tc != c)) {
+      log << "sine and cosine of " << x << " should be " << std::sin(d)
+          << " and " << std::cos(d) << " but are " << s << " and " << c
+          << ", or " << ts << " and " << tc << " with the table\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
 namespace test {
 using efgy::test::function;
 
 static function sine(testSine);
+static function fractionSines(testFractionSines);
 }  // namespace test